@@ -0,0 +1,75 @@
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+
+#include "rtgraph.h"
+#include "CPlayer.h"
+
+#include "timer.h"
+
+// A per-entity loop over three fields through the generated accessors, against the integer
+// round trip they used to do (with uintptr_t here, the old int cast truncates on x64)
+// usage: bench_accessors [entities]
+
+using namespace dvalvegen;
+
+template<typename T>
+static T* intField(void* self, unsigned int id) {
+	return (T*)((std::uintptr_t)self + g_Offsets[id]);
+}
+
+int main(int argc, char** argv) {
+	std::size_t count = bench::arg(argc, argv, 1, 512);
+	const int rounds = 500;
+
+	test::RuntimeGraph g;
+	initialize(test::makePlayerGraph(g));
+
+	const unsigned int health = findField("DT_BaseEntity", "m_iHealth");
+	const unsigned int origin = findField("DT_BaseEntity", "m_vecOrigin");
+	const unsigned int speed = findField("DT_Player", "m_flSpeed");
+
+	std::vector<std::uint8_t> storage(count * 0x400);
+	std::vector<CPlayer*> players;
+	for (std::size_t i = 0; i < count; i++) {
+		CPlayer* p = (CPlayer*)&storage[i * 0x400];
+		*p->m_iHealth() = (int)i;
+		*p->m_flSpeed() = 1.5f;
+		*p->m_vecOrigin() = { (float)i, 2, 3 };
+		players.push_back(p);
+	}
+
+	std::vector<float> out(count);
+	auto report = [count, rounds, &out](const char* name, double s) {
+		std::printf("%-14s %6.2f ns/entity (%g)\n", name, s * 1e9 / (count * rounds), out[count - 1]);
+	};
+
+	report("int roundtrip", bench::bestSeconds(5, [&] {
+		for (int r = 0; r < rounds; r++) {
+			for (std::size_t i = 0; i < count; i++) {
+				CPlayer* p = players[i];
+				out[i] = *intField<float>(p, speed) * (float)*intField<std::int32_t>(p, health) + intField<Vector>(p, origin)->x;
+			}
+		}
+	}));
+
+	report("pointer", bench::bestSeconds(5, [&] {
+		for (int r = 0; r < rounds; r++) {
+			for (std::size_t i = 0; i < count; i++) {
+				CPlayer* p = players[i];
+				out[i] = *p->m_flSpeed() * (float)*p->m_iHealth() + p->m_vecOrigin()->x;
+			}
+		}
+	}));
+
+	report("value", bench::bestSeconds(5, [&] {
+		for (int r = 0; r < rounds; r++) {
+			for (std::size_t i = 0; i < count; i++) {
+				CPlayer* p = players[i];
+				out[i] = p->m_flSpeed<Value>() * (float)p->m_iHealth<Value>() + p->m_vecOrigin<Value>().x;
+			}
+		}
+	}));
+
+	return 0;
+}
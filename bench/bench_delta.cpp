@@ -0,0 +1,91 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "timer.h"
+#include "synthetic.h"
+#include "delta.h"
+
+// DeltaPlan::compareMany in ns per entity against comparing field by field, for a tick where
+// nothing changed and one where a tenth of the entities changed one field
+// usage: bench_delta [entities]
+
+using namespace dvalvegen;
+
+int main(int argc, char** argv) {
+	uint count = bench::arg(argc, argv, 1, 5000);
+
+	// A chain of four tables with 60 props each, ints, floats and vectors over 1.6 KB
+	const SendPropType types[] = { DPT_Int, DPT_Float, DPT_Vector };
+	SyntheticGraph g;
+	RecvTable* base = nullptr;
+	int offset = 0x10;
+
+	for (int t = 0; t < 4; t++) {
+		RecvTable* table = g.addTable("DT_D" + std::to_string(t));
+		if (base) {
+			g.addProp(table, "baseclass", DPT_DataTable, 0, base);
+		}
+
+		for (int p = 0; p < 60; p++) {
+			SendPropType type = types[p % 3];
+			g.addProp(table, "m_d" + std::to_string(t) + "_" + std::to_string(p), type, offset);
+			offset += type == DPT_Vector ? 12 : 4;
+		}
+
+		base = table;
+	}
+
+	createClasses(g.addClass("CD", base, 1));
+	DeltaPlan& plan = getDeltaPlan("DT_D3");
+
+	std::size_t size = plan.size();
+	std::vector<std::uint8_t> prev(size * count), cur(size * count);
+	std::vector<std::uint64_t> changed((std::size_t)plan.numWords() * count);
+
+	for (std::size_t i = 0; i < prev.size(); i++) {
+		prev[i] = (std::uint8_t)(i * 31);
+	}
+
+	cur = prev;
+	uint nchanged = 0;
+
+	auto report = [count, &nchanged](const char* name, double s) {
+		std::printf("%-24s %8.1f ns/entity (%u changed)\n", name, s * 1e9 / count, nchanged);
+	};
+
+	// What calling every accessor twice amounts to, one comparison per field
+	auto perField = [&] {
+		nchanged = 0;
+		for (uint e = 0; e < count; e++) {
+			const std::uint8_t* a = prev.data() + e * size;
+			const std::uint8_t* b = cur.data() + e * size;
+			bool any = false;
+
+			for (uint i = 0; i < plan.numFields(); i++) {
+				int at = plan.fieldOffset(i) - plan.base();
+				any |= std::memcmp(a + at, b + at, plan.fieldSize(i)) != 0;
+			}
+
+			nchanged += any;
+		}
+	};
+
+	auto compare = [&] {
+		nchanged = plan.compareMany(prev.data(), cur.data(), count, changed.data());
+	};
+
+	std::printf("%u fields over %zu bytes, simd %s\n", plan.numFields(), size, simd::name());
+	report("per field, unchanged", bench::bestSeconds(5, perField));
+	report("compareMany, unchanged", bench::bestSeconds(5, compare));
+
+	for (uint e = 0; e < count; e += 10) {
+		cur[e * size + (e * 7) % size] ^= 1;
+	}
+
+	report("per field, 10% changed", bench::bestSeconds(5, perField));
+	report("compareMany, 10% changed", bench::bestSeconds(5, compare));
+
+	return 0;
+}
@@ -0,0 +1,90 @@
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "timer.h"
+#include "synthetic.h"
+#include "dump.h"
+
+// dumpGraph throughput in props per second, each format alone and all four in one traversal
+// usage: bench_dump [classes]
+
+using namespace dvalvegen;
+
+int main(int argc, char** argv) {
+	int classes = bench::arg(argc, argv, 1, 2000);
+
+	// Chains of eight classes, 30 props and two nested tables of 10 each
+	const SendPropType types[] = { DPT_Int, DPT_Float, DPT_Vector, DPT_String, DPT_Int64, DPT_VectorXY };
+	SyntheticGraph g;
+	std::vector<RecvTable*> tables;
+
+	for (int c = 0; c < classes; c++) {
+		RecvTable* table = g.addTable("DT_K" + std::to_string(c));
+		if (c % 8) {
+			g.addProp(table, "baseclass", DPT_DataTable, 0, tables[c - 1]);
+		}
+
+		for (int p = 0; p < 30; p++) {
+			g.addProp(table, "m_i" + std::to_string(c) + "_" + std::to_string(p), types[p % 6], 0x100 + p * 4);
+		}
+
+		for (int k = 0; k < 2; k++) {
+			RecvTable* sub = g.addTable("DT_S" + std::to_string(c) + "_" + std::to_string(k));
+			for (int p = 0; p < 10; p++) {
+				g.addProp(sub, "m_s" + std::to_string(p), DPT_Float, p * 4);
+			}
+
+			g.addProp(table, "m_sub" + std::to_string(k), DPT_DataTable, 0x400 + k * 0x40, sub);
+		}
+
+		tables.push_back(table);
+		g.addClass("CK" + std::to_string(c), table, c);
+	}
+
+	std::string dir = "bench_dump_out/";
+	std::filesystem::create_directories(dir);
+	std::uint64_t props = 0;
+
+	auto report = [&props](const char* name, double s) {
+		std::printf("%-12s %8.1f ms %8.1f M props/s\n", name, s * 1e3, props / s / 1e6);
+	};
+
+	double s = bench::bestSeconds(5, [&] {
+		TreeDump tree{ dir + "netvars.txt" };
+		props = dumpGraph(g.head(), { &tree });
+	});
+	report("tree", s);
+
+	s = bench::bestSeconds(5, [&] {
+		ClassIdDump ids{ dir + "ClassIds.h" };
+		dumpGraph(g.head(), { &ids });
+	});
+	report("classids", s);
+
+	s = bench::bestSeconds(5, [&] {
+		JsonLinesDump json{ dir + "netvars.jsonl" };
+		dumpGraph(g.head(), { &json });
+	});
+	report("jsonl", s);
+
+	s = bench::bestSeconds(5, [&] {
+		CsvDump csv{ dir + "netvars.csv" };
+		dumpGraph(g.head(), { &csv });
+	});
+	report("csv", s);
+
+	s = bench::bestSeconds(5, [&] {
+		TreeDump tree{ dir + "netvars.txt" };
+		ClassIdDump ids{ dir + "ClassIds.h" };
+		JsonLinesDump json{ dir + "netvars.jsonl" };
+		CsvDump csv{ dir + "netvars.csv" };
+		dumpGraph(g.head(), { &tree, &ids, &json, &csv });
+	});
+	report("all four", s);
+
+	std::printf("%d classes, %llu props a traversal\n", classes, (unsigned long long)props);
+	std::filesystem::remove_all(dir);
+	return 0;
+}
@@ -0,0 +1,87 @@
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+#include "timer.h"
+#include "graph.h"
+#include "entityreader.h"
+
+// Entities of a forked child read through EntityReader against one process_vm_readv per field
+// usage: bench_entityreader [entities] [ticks]
+
+using namespace dvalvegen;
+
+int main(int argc, char** argv) {
+	int count = bench::arg(argc, argv, 1, 4096);
+	int ticks = bench::arg(argc, argv, 2, 50);
+
+	SyntheticGraph g;
+	createClasses(test::makePlayerGraph(g));
+	Class& player = g_Classes["DT_Player"];
+	Class& entity = g_Classes["DT_BaseEntity"];
+
+	std::vector<char*> entities;
+	for (int i = 0; i < count; i++) {
+		entities.push_back((char*)std::calloc(1, 0x400));
+	}
+
+	pid_t child = fork();
+	if (child == 0) {
+		pause();
+		_exit(0);
+	}
+
+	auto id = [](const char* table, const char* prop) {
+		return g_Classes[table].props().at(prop).id();
+	};
+
+	std::vector<uint> ids{ id("DT_BaseEntity", "m_iHealth"), id("DT_BaseEntity", "m_vecOrigin"), id("DT_Player", "m_flSpeed"), id("DT_Coll", "m_vecMaxs"), id("DT_Player", "m_iAmmo") };
+
+	ProcessReader reader{ child };
+	EntityReader er{ reader };
+	er.setFields(ids);
+
+	for (int i = 0; i < count; i++) {
+		er.add((std::uintptr_t)entities[i], i % 2 ? player : entity);
+	}
+
+	double coalesced = bench::bestSeconds(3, [&] {
+		for (int t = 0; t < ticks; t++) {
+			er.read();
+		}
+	});
+
+	std::printf("EntityReader: %llu calls per tick, %zu ranges, %.2f M entities/s\n", (unsigned long long)er.lastCalls(), er.lastRanges(),
+		count * (double)ticks / coalesced / 1e6);
+
+	// What reading the same fields one call at a time costs, players have 5 of them and base entities 3
+	char buffer[64];
+	std::uint64_t calls = reader.numCalls();
+	int naiveticks = ticks / 10 ? ticks / 10 : 1;
+
+	double naive = bench::bestSeconds(1, [&] {
+		for (int t = 0; t < naiveticks; t++) {
+			for (int i = 0; i < count; i++) {
+				std::uintptr_t e = (std::uintptr_t)entities[i];
+				reader.read(e + 0x10, buffer, 4);
+				reader.read(e + 0x20, buffer, 12);
+				reader.read(e + 0x4c, buffer, 12);
+
+				if (i % 2) {
+					reader.read(e + 0x100, buffer, 4);
+					reader.read(e + 0x200, buffer, 16);
+				}
+			}
+		}
+	});
+
+	std::printf("one read per field: %llu calls per tick, %.2f M entities/s\n", (unsigned long long)((reader.numCalls() - calls) / naiveticks),
+		count * (double)naiveticks / naive / 1e6);
+
+	kill(child, SIGKILL);
+	waitpid(child, nullptr, 0);
+	return 0;
+}
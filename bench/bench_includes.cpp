@@ -0,0 +1,173 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "timer.h"
+#include "synthetic.h"
+
+// Include fan-out of the generated class headers and the compile time of code using them
+// "includes" is the output as generated, nested classes forward declared; "all includes" turns those
+// declarations back into #includes, which is what the generator used to write. Only class headers are counted
+// usage: bench_includes [consumer TUs]
+
+using namespace dvalvegen;
+namespace fs = std::filesystem;
+
+using IncludeGraph = std::map<std::string, std::vector<std::string>>;
+
+static IncludeGraph readIncludes(const fs::path& dir) {
+	static const std::regex include{ "#include \"(CK[0-9]+)\\.h\"" };
+	IncludeGraph graph;
+
+	for (auto& entry : fs::directory_iterator(dir)) {
+		std::string name = entry.path().stem().string();
+		if (name.rfind("CK", 0) != 0) {
+			continue;
+		}
+
+		std::ifstream in{ entry.path() };
+		std::stringstream text;
+		text << in.rdbuf();
+
+		std::string s = text.str();
+		auto& edges = graph[name];
+		for (std::sregex_iterator it{ s.begin(), s.end(), include }, end; it != end; ++it) {
+			edges.push_back((*it)[1]);
+		}
+	}
+
+	return graph;
+}
+
+static void closure(const IncludeGraph& graph, const std::string& name, std::set<std::string>& seen) {
+	for (auto& next : graph.at(name)) {
+		if (seen.insert(next).second) {
+			closure(graph, next, seen);
+		}
+	}
+}
+
+static void report(const char* label, const IncludeGraph& graph) {
+	double direct = 0, transitive = 0;
+	std::size_t maxtransitive = 0;
+	std::map<std::string, std::size_t> rebuilt;
+
+	for (auto& [name, edges] : graph) {
+		std::set<std::string> seen;
+		closure(graph, name, seen);
+
+		direct += edges.size();
+		transitive += seen.size();
+		maxtransitive = std::max(maxtransitive, seen.size());
+		for (auto& s : seen) {
+			rebuilt[s]++;
+		}
+	}
+
+	std::size_t maxrebuilt = 0;
+	double sumrebuilt = 0;
+	for (auto& [name, n] : rebuilt) {
+		sumrebuilt += n;
+		maxrebuilt = std::max(maxrebuilt, n);
+	}
+
+	double n = (double)graph.size();
+	std::printf("%-13s direct %4.1f  transitive %6.1f avg %4zu max  rebuilt by touching one %6.1f avg %4zu max\n",
+		label, direct / n, transitive / n, maxtransitive, sumrebuilt / n, maxrebuilt);
+}
+
+static void allIncludes(const fs::path& from, const fs::path& to) {
+	/// Copies the SDK with every forward declaration of a class header replaced by its #include
+	static const std::regex declaration{ "\nclass (CK[0-9]+);" };
+	fs::remove_all(to);
+	fs::copy(from, to);
+
+	for (auto& entry : fs::directory_iterator(to)) {
+		if (entry.path().stem().string().rfind("CK", 0) != 0) {
+			continue;
+		}
+
+		std::stringstream text;
+		text << std::ifstream{ entry.path() }.rdbuf();
+		std::string s = std::regex_replace(text.str(), declaration, "\n#include \"$1.h\"");
+		std::ofstream{ entry.path() } << s;
+	}
+}
+
+static double compileSeconds(const fs::path& sdk, int tus) {
+	/// Compiles tus consumer files one after another, each including one class header and calling an accessor
+	auto start = std::chrono::steady_clock::now();
+
+	for (int t = 0; t < tus; t++) {
+		int c = (t * 8 + 7) % 400;
+		fs::path src = sdk / ("consumer" + std::to_string(t) + ".cpp");
+		std::ofstream{ src } << "#include \"CK" << c << ".h\"\n\nint read(CK" << c << "* p) {\n\treturn *p->m_i" << c << "_0();\n}\n";
+
+		std::string cmd = std::string{ DVALVEGEN_BENCH_CXX } + " -std=c++17 -O2 -I" + sdk.string() + " -c " + src.string() + " -o /dev/null";
+		if (std::system(cmd.c_str()) != 0) {
+			return -1;
+		}
+	}
+
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+	int tus = bench::arg(argc, argv, 1, 10);
+
+	// 400 classes in base chains of 8, each with up to 6 members whose class is an earlier one
+	SyntheticGraph g;
+	std::vector<RecvTable*> tables;
+	std::mt19937 rng{ 7 };
+
+	for (int c = 0; c < 400; c++) {
+		RecvTable* table = g.addTable("DT_K" + std::to_string(c));
+		if (c % 8) {
+			g.addProp(table, "baseclass", DPT_DataTable, 0, tables[c - 1]);
+		}
+
+		for (int p = 0; p < 30; p++) {
+			g.addProp(table, "m_i" + std::to_string(c) + "_" + std::to_string(p), DPT_Int, 0x100 + p * 4);
+		}
+
+		for (int k = 0; c && k < 6; k++) {
+			g.addProp(table, "m_sub" + std::to_string(k), DPT_DataTable, 0x400 + k * 0x40, tables[rng() % c]);
+		}
+
+		tables.push_back(table);
+		g.addClass("CK" + std::to_string(c), table, c);
+	}
+
+	fs::path dir = fs::absolute("bench_includes_out");
+	fs::remove_all(dir);
+	fs::create_directories(dir);
+
+	createClasses(g.head());
+	if (!printClasses(dir.string() + "/")) {
+		std::printf("failed to write the SDK\n");
+		return 1;
+	}
+
+	fs::path sdk = dir / "dvalvegen";
+	fs::path old = dir / "dvalvegen_all";
+	allIncludes(sdk, old);
+
+	report("includes", readIncludes(sdk));
+	report("all includes", readIncludes(old));
+
+	double s = compileSeconds(sdk, tus);
+	std::printf("%d consumer TUs, includes:     %6.2f s\n", tus, s);
+	s = compileSeconds(old, tus);
+	std::printf("%d consumer TUs, all includes: %6.2f s\n", tus, s);
+
+	return 0;
+}
@@ -0,0 +1,115 @@
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "timer.h"
+#include "synthetic.h"
+
+// What the accounting costs per allocation, and what the model and the rendering hold for graphs
+// of 1k, 5k and 20k tables
+// usage: bench_memory [allocations]
+
+using namespace dvalvegen;
+
+static void modelReport(int tables) {
+	// Chains of 8 tables with 30 props and up to 6 members of an earlier class each
+	// Prop names as long as the game's, short ones would fit into the strings themselves and never allocate
+	SyntheticGraph g;
+	std::vector<RecvTable*> ts;
+
+	for (int c = 0; c < tables; c++) {
+		RecvTable* table = g.addTable("DT_K" + std::to_string(c));
+		if (c % 8) {
+			g.addProp(table, "baseclass", DPT_DataTable, 0, ts[c - 1]);
+		}
+
+		for (int p = 0; p < 30; p++) {
+			g.addProp(table, "m_iNetworkedField" + std::to_string(c) + "_" + std::to_string(p), DPT_Int, 0x100 + p * 4);
+		}
+
+		for (int k = 0; c && k < 6; k++) {
+			g.addProp(table, "m_sub" + std::to_string(k), DPT_DataTable, 0x400 + k * 0x40, ts[(c * 7 + k * 13) % c]);
+		}
+
+		ts.push_back(table);
+		g.addClass("CK" + std::to_string(c), table, c);
+	}
+
+	resetClasses();
+	memory::resetPeaks();
+	double s = bench::bestSeconds(1, [&] {
+		createClasses(g.head());
+	});
+
+	auto mib = [](std::uint64_t bytes) {
+		return bytes / 1048576.0;
+	};
+
+	std::printf("%5d tables  createClasses %7.1f ms %8llu allocations  names %6.2f  props %6.2f  classes %6.2f  total %6.2f MiB",
+		tables, s * 1e3, (unsigned long long)memory::total().allocations, mib(memory::stats(memory::Names).current),
+		mib(memory::stats(memory::Props).current), mib(memory::stats(memory::Classes).current), mib(memory::total().current));
+
+	std::string dir = "bench_memory_out/" + std::to_string(tables) + "/";
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir);
+
+	memory::resetPeaks();
+	printClasses(dir);
+	std::printf("  output peak %6.2f MiB\n", mib(memory::stats(memory::Output).peak));
+
+	resetClasses();
+}
+
+int main(int argc, char** argv) {
+	int count = bench::arg(argc, argv, 1, 1000000);
+
+	// The counting resource against the allocator it forwards to, the same sizes model names have
+	std::vector<std::string> plain;
+	memory::Vector<memory::String<memory::Names>, memory::Names> counted;
+	plain.reserve(count);
+	counted.reserve(count);
+
+	double s = bench::bestSeconds(5, [&] {
+		plain.clear();
+		for (int i = 0; i < count; i++) {
+			std::string name = "DT_SomeNetworkedTable_m_iField" + std::to_string(i);
+			plain.emplace_back(name);
+		}
+	});
+	std::printf("std::string     %6.1f ns/string\n", s * 1e9 / count);
+
+	s = bench::bestSeconds(5, [&] {
+		counted.clear();
+		for (int i = 0; i < count; i++) {
+			std::string name = "DT_SomeNetworkedTable_m_iField" + std::to_string(i);
+			counted.emplace_back(name);
+		}
+	});
+	std::printf("memory::String  %6.1f ns/string\n", s * 1e9 / count);
+
+	std::pmr::memory_resource* upstream = std::pmr::new_delete_resource();
+	s = bench::bestSeconds(5, [&] {
+		for (int i = 0; i < count; i++) {
+			upstream->deallocate(upstream->allocate(48, 8), 48, 8);
+		}
+	});
+	std::printf("new_delete      %6.1f ns/allocation\n", s * 1e9 / count);
+
+	s = bench::bestSeconds(5, [&] {
+		for (int i = 0; i < count; i++) {
+			memory::resource(memory::Props)->deallocate(memory::resource(memory::Props)->allocate(48, 8), 48, 8);
+		}
+	});
+	std::printf("counting        %6.1f ns/allocation\n\n", s * 1e9 / count);
+
+	// Clearing keeps the capacity, it would show up as names below
+	std::vector<std::string>{}.swap(plain);
+	decltype(counted){}.swap(counted);
+
+	for (int tables : { 1000, 5000, 20000 }) {
+		modelReport(tables);
+	}
+
+	return 0;
+}
@@ -0,0 +1,65 @@
+#include <cstdio>
+#include <cstdint>
+#include <vector>
+
+#include "rtgraph.h"
+#include "CPlayer.h"
+
+#include "timer.h"
+
+// The same per-entity loop once per access policy, each call site picks its own
+// usage: bench_policies [entities]
+
+using namespace dvalvegen;
+
+template<typename F>
+static double run(std::vector<CPlayer*>& players, std::vector<float>& out, int rounds, F read) {
+	return bench::bestSeconds(5, [&] {
+		for (int r = 0; r < rounds; r++) {
+			for (std::size_t i = 0; i < players.size(); i++) {
+				out[i] = read(players[i]);
+			}
+		}
+	});
+}
+
+int main(int argc, char** argv) {
+	std::size_t count = bench::arg(argc, argv, 1, 512);
+	const int rounds = 500;
+
+	test::RuntimeGraph g;
+	initialize(test::makePlayerGraph(g));
+
+	std::vector<std::uint8_t> storage(count * 0x400);
+	std::vector<CPlayer*> players;
+	for (std::size_t i = 0; i < count; i++) {
+		CPlayer* p = (CPlayer*)&storage[i * 0x400];
+		*p->m_iHealth() = (int)i;
+		*p->m_flSpeed() = 1.5f;
+		*p->m_vecOrigin() = { (float)i, 2, 3 };
+		players.push_back(p);
+	}
+
+	std::vector<float> out(count);
+	auto report = [count, rounds, &out](const char* name, double s) {
+		std::printf("%-10s %6.2f ns/entity (%g)\n", name, s * 1e9 / (count * rounds), out[count - 1]);
+	};
+
+	report("Pointer", run(players, out, rounds, [](CPlayer* p) {
+		return *p->m_flSpeed<Pointer>() * (float)*p->m_iHealth<Pointer>() + p->m_vecOrigin<Pointer>()->x;
+	}));
+
+	report("Reference", run(players, out, rounds, [](CPlayer* p) {
+		return p->m_flSpeed<Reference>() * (float)p->m_iHealth<Reference>() + p->m_vecOrigin<Reference>().x;
+	}));
+
+	report("Value", run(players, out, rounds, [](CPlayer* p) {
+		return p->m_flSpeed<Value>() * (float)p->m_iHealth<Value>() + p->m_vecOrigin<Value>().x;
+	}));
+
+	report("Relaxed", run(players, out, rounds, [](CPlayer* p) {
+		return p->m_flSpeed<Relaxed>() * (float)p->m_iHealth<Relaxed>() + p->m_vecOrigin<Relaxed>().x;
+	}));
+
+	return 0;
+}
@@ -0,0 +1,54 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "timer.h"
+#include "recorder.h"
+
+// Recording and replaying a stream of updates like a tick of a busy server produces, in M events per second
+// usage: bench_recorder [events]
+
+using namespace dvalvegen;
+
+int main(int argc, char** argv) {
+	int count = bench::arg(argc, argv, 1, 2000000);
+	std::string path = "bench_recorder.log";
+
+	// 64 entities, 40 fields each, a new tick every 2560 events
+	std::vector<ProxyEvent> events(count);
+	for (int i = 0; i < count; i++) {
+		ProxyEvent& ev = events[i];
+		std::memset(&ev, 0, sizeof(ev));
+		ev.objectID = (i / 40) % 64;
+		ev.fieldID = (unsigned int)(i % 40);
+		ev.type = i % 4 == 0 ? DPT_Vector : i % 4 == 1 ? DPT_Float : DPT_Int;
+		ev.value.m_Int = i * 7;
+	}
+
+	std::uint64_t bytes = 0;
+	double s = bench::bestSeconds(3, [&] {
+		NetvarRecorder recorder;
+		recorder.open(path);
+		for (int i = 0; i < count; i++) {
+			recorder.setTick((std::uint32_t)(i / 2560));
+			recorder.record(events[i]);
+		}
+		recorder.close();
+		bytes = recorder.bytesWritten();
+	});
+	std::printf("record  %6.1f M events/s  %.2f bytes/event\n", count / s / 1e6, (double)bytes / count);
+
+	std::uint64_t sum = 0;
+	s = bench::bestSeconds(3, [&] {
+		NetvarReplayer replayer;
+		replayer.open(path);
+		replayer.replay([&sum](const ProxyEvent& ev, std::uint32_t tick) {
+			sum += ev.fieldID + tick;
+		});
+	});
+	std::printf("replay  %6.1f M events/s  (%llu)\n", count / s / 1e6, (unsigned long long)sum);
+
+	std::remove(path.c_str());
+	return 0;
+}
@@ -0,0 +1,51 @@
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "timer.h"
+#include "scanner.h"
+
+// PatternScanner throughput over random bytes, one pattern and eight at once
+// usage: bench_scanner [MiB]
+
+using namespace dvalvegen;
+
+int main(int argc, char** argv) {
+	std::size_t size = (std::size_t)bench::arg(argc, argv, 1, 64) << 20;
+
+	std::mt19937 rng{ 1 };
+	std::vector<std::uint8_t> buffer(size);
+	for (auto& b : buffer) {
+		b = (std::uint8_t)rng();
+	}
+
+	const char* texts[] = { "A1 ?? ?? ?? ?? C3", "55 8B EC 83 E4 F8", "E8 ?? ?? ?? ?? 84 C0 74", "?? ?? 56 43 6C 69", "8B 0D ?? ?? ?? ?? 8B 01 FF 50",
+		"00 00 00 00 12", "68 ?? ?? ?? ?? FF 15", "C7 05 ?? ?? ?? ?? 01 00" };
+
+	std::vector<std::vector<std::size_t>> results;
+
+	for (std::size_t n : { (std::size_t)1, std::size(texts) }) {
+		PatternScanner scanner;
+		for (std::size_t i = 0; i < n; i++) {
+			scanner.add(BytePattern{ texts[i] });
+		}
+
+		double s = bench::bestSeconds(5, [&] {
+			scanner.scan(buffer.data(), buffer.size(), results);
+		});
+
+		std::printf("%s, %zu pattern(s): %.2f GB/s\n", simd::name(), n, size / s / 1e9);
+	}
+
+	// The plain masked compare at every position, what the anchor filter saves
+	BytePattern first{ texts[0] };
+	std::size_t hits = 0;
+	double s = bench::bestSeconds(1, [&] {
+		for (std::size_t i = 0; i + first.size() <= size; i++) {
+			hits += first.match(buffer.data() + i);
+		}
+	});
+
+	std::printf("naive, 1 pattern: %.2f GB/s (%zu hits)\n", size / s / 1e9, hits);
+	return 0;
+}
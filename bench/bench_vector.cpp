@@ -0,0 +1,81 @@
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "Vector.h"
+
+#include "timer.h"
+
+// The Vector.h box cull against a plain loop over the same vectors, strided and through entity pointers
+// usage: bench_vector [entities]
+
+using namespace dvalvegen;
+
+struct Entity {
+	char pad[0x130];
+	Vector origin;
+	char tail[0x40];
+
+	Vector* getOrigin() {
+		return &origin;
+	}
+};
+
+static std::size_t scalarCull(Entity* const* entities, std::size_t count, const Vector& mins, const Vector& maxs, std::uint32_t* out) {
+	std::size_t n = 0;
+
+	for (std::size_t i = 0; i < count; i++) {
+		const Vector& v = entities[i]->origin;
+		out[n] = (std::uint32_t)i;
+		n += v.x >= mins.x && v.y >= mins.y && v.z >= mins.z && v.x <= maxs.x && v.y <= maxs.y && v.z <= maxs.z;
+	}
+
+	return n;
+}
+
+int main(int argc, char** argv) {
+	std::size_t count = bench::arg(argc, argv, 1, 2048);
+	const int rounds = 2000;
+
+	// Shuffled pointers like an entity list, about a third of them inside the box
+	std::vector<Entity> storage(count);
+	std::vector<Entity*> entities;
+	std::srand(1);
+
+	for (auto& e : storage) {
+		e.origin = { (float)(std::rand() % 2000 - 1000), (float)(std::rand() % 2000 - 1000), (float)(std::rand() % 400 - 200) };
+		entities.push_back(&e);
+	}
+
+	for (std::size_t i = count; i > 1; i--) {
+		std::swap(entities[i - 1], entities[std::rand() % i]);
+	}
+
+	const Vector mins{ -700, -700, -150 }, maxs{ 700, 700, 150 };
+	std::vector<std::uint32_t> out(count);
+	std::size_t n = 0;
+
+	auto report = [count, rounds, &n](const char* name, double s) {
+		std::printf("%-16s %8.2f ms %8.1f M vectors/s (%zu inside)\n", name, s * 1e3, (double)count * rounds / s / 1e6, n);
+	};
+
+	report("scalar entities", bench::bestSeconds(5, [&] {
+		for (int r = 0; r < rounds; r++) {
+			n = scalarCull(entities.data(), count, mins, maxs, out.data());
+		}
+	}));
+
+	report("vec entities", bench::bestSeconds(5, [&] {
+		for (int r = 0; r < rounds; r++) {
+			n = vec::cull(entities.data(), count, &Entity::getOrigin, mins, maxs, out.data());
+		}
+	}));
+
+	report("vec strided", bench::bestSeconds(5, [&] {
+		for (int r = 0; r < rounds; r++) {
+			n = vec::cull(&storage[0].origin, sizeof(Entity), count, mins, maxs, out.data());
+		}
+	}));
+
+	return 0;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <chrono>
+#include <cstdlib>
+
+// Best of several runs, the machines these run on are rarely quiet
+
+namespace dvalvegen::bench {
+	template<typename F>
+	double bestSeconds(int runs, F fn) {
+		double best = 1e30;
+
+		for (int i = 0; i < runs; i++) {
+			auto start = std::chrono::steady_clock::now();
+			fn();
+			double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			best = s < best ? s : best;
+		}
+
+		return best;
+	}
+
+	int arg(int argc, char** argv, int i, int fallback) {
+		return argc > i ? std::atoi(argv[i]) : fallback;
+	}
+}
@@ -0,0 +1,325 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "dvalvegen.h"
+#include "delta.h"
+
+namespace dvalvegen {
+	// Keep in sync with the copy printed by printClassIdHash
+	constexpr std::uint32_t classNameHash(const char* s, std::uint32_t seed) {
+		std::uint32_t h = 2166136261u ^ (seed * 0x9E3779B9u);
+		while (*s) {
+			h = (h ^ (std::uint8_t)*s++) * 16777619u;
+		}
+
+		h ^= h >> 16;
+		h *= 0x85EBCA6Bu;
+		h ^= h >> 13;
+		h *= 0xC2B2AE35u;
+		h ^= h >> 16;
+		return h;
+	}
+
+	class ClassNameHash {
+		/// Perfect hash from network name to ClassID (hash and displace)
+		/// One bucket lookup, one slot lookup and one string compare per query
+	public:
+		struct Slot {
+			const char* name;
+			int classid;
+		};
+
+		bool build(ClientClass* cclass) {
+			/// False if a class has no name or two share one, no displacement separates equal keys
+			m_keys.clear();
+			m_displacements.clear();
+			m_slots.clear();
+
+			std::unordered_set<std::string_view> names;
+			for (; cclass; cclass = cclass->m_pNext) {
+				if (!cclass->m_pNetworkName || !names.insert(cclass->m_pNetworkName).second) {
+					m_keys.clear();
+					return false;
+				}
+
+				m_keys.push_back({ cclass->m_pNetworkName, cclass->m_ClassID });
+			}
+
+			uint size = 1;
+			while (size < m_keys.size()) {
+				size <<= 1;
+			}
+
+			// Distinct keys always fit eventually, the limit only guards against a broken hash
+			while (!tryBuild(size)) {
+				if (size >= (1u << 24)) {
+					m_displacements.clear();
+					m_slots.clear();
+					return false;
+				}
+
+				size <<= 1;
+			}
+
+			return true;
+		}
+
+		int find(const char* name) const {
+			/// Returns -1 for names that aren't in the set
+			if (m_slots.empty()) {
+				return -1;
+			}
+
+			std::uint32_t d = m_displacements[classNameHash(name, 0) % m_displacements.size()];
+			const Slot& slot = m_slots[classNameHash(name, d) & (m_slots.size() - 1)];
+
+			if (slot.name && std::strcmp(slot.name, name) == 0) {
+				return slot.classid;
+			}
+
+			return -1;
+		}
+
+		const std::vector<std::uint32_t>& displacements() const {
+			return m_displacements;
+		}
+
+		const std::vector<Slot>& slots() const {
+			return m_slots;
+		}
+
+	private:
+		bool tryBuild(uint size) {
+			uint nbuckets = std::max<uint>(1, ((uint)m_keys.size() + 3) / 4);
+			std::vector<std::vector<uint>> buckets(nbuckets);
+
+			for (uint i = 0; i < m_keys.size(); i++) {
+				buckets[classNameHash(m_keys[i].name, 0) % nbuckets].push_back(i);
+			}
+
+			std::vector<uint> order(nbuckets);
+			for (uint i = 0; i < nbuckets; i++) {
+				order[i] = i;
+			}
+
+			// Biggest buckets first, while the table is still mostly empty
+			std::stable_sort(order.begin(), order.end(), [&buckets](uint a, uint b) {
+				return buckets[a].size() > buckets[b].size();
+			});
+
+			m_displacements.assign(nbuckets, 0);
+			m_slots.assign(size, { nullptr, -1 });
+
+			std::vector<uint> positions;
+			for (uint b : order) {
+				if (buckets[b].empty()) {
+					break;
+				}
+
+				bool placed = false;
+				for (std::uint32_t d = 1; d < (1u << 20) && !placed; d++) {
+					positions.clear();
+					placed = true;
+
+					for (uint k : buckets[b]) {
+						uint pos = classNameHash(m_keys[k].name, d) & (size - 1);
+
+						if (m_slots[pos].name || std::find(positions.begin(), positions.end(), pos) != positions.end()) {
+							placed = false;
+							break;
+						}
+
+						positions.push_back(pos);
+					}
+
+					if (placed) {
+						m_displacements[b] = d;
+						for (uint i = 0; i < positions.size(); i++) {
+							m_slots[positions[i]] = m_keys[buckets[b][i]];
+						}
+					}
+				}
+
+				if (!placed) {
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		std::vector<Slot> m_keys;
+		std::vector<std::uint32_t> m_displacements;
+		std::vector<Slot> m_slots;
+	};
+
+	struct ClassDispatchEntry {
+		ClientClass* cclass;	// nullptr for unused IDs
+		Class* cls;				// Generated class, nullptr if the table didn't produce one
+		uint index;				// Dense index of cls, usable for per-type arrays
+		DeltaPlan* plan;		// Networked byte span of the class, nullptr without cls
+	};
+
+	class ClassDispatch {
+		/// ClassID -> everything we know about the class, in one indexed load
+	public:
+		bool build(ClientClass* head) {
+			/// Needs createClasses to have run on the same list, build again whenever the model changes
+			/// False if network names repeat, lookups by ID still work then but find() never matches
+			int maxid = -1;
+			for (ClientClass* cclass = head; cclass; cclass = cclass->m_pNext) {
+				maxid = std::max(maxid, cclass->m_ClassID);
+			}
+
+			m_entries.assign(maxid + 1, { nullptr, nullptr, (uint)-1, nullptr });
+			m_classes.clear();
+
+			// Several IDs can share a table, they share its index
+			std::unordered_map<Class*, uint> indices;
+
+			for (ClientClass* cclass = head; cclass; cclass = cclass->m_pNext) {
+				if (cclass->m_ClassID < 0) {
+					continue;
+				}
+
+				ClassDispatchEntry& entry = m_entries[cclass->m_ClassID];
+				entry.cclass = cclass;
+
+				if (!cclass->m_pRecvTable) {
+					continue;
+				}
+
+				auto it = g_Classes.find(cclass->m_pRecvTable->GetName());
+				if (it == g_Classes.end()) {
+					continue;
+				}
+
+				entry.cls = &it->second;
+				entry.plan = &getDeltaPlan(it->first);
+
+				auto index = indices.emplace(entry.cls, (uint)m_classes.size());
+				entry.index = index.first->second;
+				if (index.second) {
+					m_classes.push_back(entry.cls);
+				}
+			}
+
+			return m_names.build(head);
+		}
+
+		const ClassDispatchEntry* get(int classid) const {
+			if (classid < 0 || (std::size_t)classid >= m_entries.size()) {
+				return nullptr;
+			}
+
+			return &m_entries[classid];
+		}
+
+		const ClassDispatchEntry& operator[](int classid) const {
+			/// Unchecked
+			return m_entries[classid];
+		}
+
+		int find(const char* networkname) const {
+			return m_names.find(networkname);
+		}
+
+		const ClassDispatchEntry* get(const char* networkname) const {
+			return get(find(networkname));
+		}
+
+		uint size() const {
+			return (uint)m_entries.size();
+		}
+
+		const std::vector<Class*>& classes() const {
+			return m_classes;
+		}
+
+		const ClassNameHash& names() const {
+			return m_names;
+		}
+
+	private:
+		std::vector<ClassDispatchEntry> m_entries;
+		std::vector<Class*> m_classes;
+		ClassNameHash m_names;
+	};
+
+	ClassDispatch g_ClassDispatch;
+
+	bool printClassIdHash(ClientClass* cclass, std::ostream& stream) {
+		/// Emits a constexpr version of ClassNameHash for the enum written by ClassIdDump
+		ClassNameHash hash;
+		if (!hash.build(cclass)) {
+			stream << "#error ClassIdHash: network names are missing or not unique" << std::endl;
+			return false;
+		}
+
+		stream << "namespace ClassIdHash {" << std::endl;
+		stream << "\tconstexpr unsigned int hash(const char* s, unsigned int seed) {" << std::endl;
+		stream << "\t\tunsigned int h = 2166136261u ^ (seed * 0x9E3779B9u);" << std::endl;
+		stream << "\t\twhile (*s) {" << std::endl;
+		stream << "\t\t\th = (h ^ (unsigned char)*s++) * 16777619u;" << std::endl;
+		stream << "\t\t}" << std::endl;
+		stream << std::endl;
+		stream << "\t\th ^= h >> 16;" << std::endl;
+		stream << "\t\th *= 0x85EBCA6Bu;" << std::endl;
+		stream << "\t\th ^= h >> 13;" << std::endl;
+		stream << "\t\th *= 0xC2B2AE35u;" << std::endl;
+		stream << "\t\th ^= h >> 16;" << std::endl;
+		stream << "\t\treturn h;" << std::endl;
+		stream << "\t}" << std::endl;
+		stream << std::endl;
+		stream << "\tconstexpr bool equal(const char* a, const char* b) {" << std::endl;
+		stream << "\t\twhile (*a && *a == *b) {" << std::endl;
+		stream << "\t\t\ta++;" << std::endl;
+		stream << "\t\t\tb++;" << std::endl;
+		stream << "\t\t}" << std::endl;
+		stream << std::endl;
+		stream << "\t\treturn *a == *b;" << std::endl;
+		stream << "\t}" << std::endl;
+		stream << std::endl;
+		stream << "\tstruct Slot {" << std::endl;
+		stream << "\t\tconst char* name;" << std::endl;
+		stream << "\t\tint id;" << std::endl;
+		stream << "\t};" << std::endl;
+		stream << std::endl;
+
+		stream << "\tconstexpr unsigned int Displacements[" << hash.displacements().size() << "] = {";
+		for (std::size_t i = 0; i < hash.displacements().size(); i++) {
+			stream << (i % 16 == 0 ? "\n\t\t" : " ") << hash.displacements()[i] << ",";
+		}
+		stream << std::endl << "\t};" << std::endl;
+		stream << std::endl;
+
+		stream << "\tconstexpr Slot Slots[" << hash.slots().size() << "] = {" << std::endl;
+		for (auto& slot : hash.slots()) {
+			if (slot.name) {
+				stream << "\t\t{ \"" << slot.name << "\", " << slot.classid << " }," << std::endl;
+			}
+			else {
+				stream << "\t\t{ nullptr, -1 }," << std::endl;
+			}
+		}
+		stream << "\t};" << std::endl;
+		stream << std::endl;
+
+		stream << "\tconstexpr int find(const char* name) {" << std::endl;
+		stream << "\t\tunsigned int d = Displacements[hash(name, 0) % " << hash.displacements().size() << "];" << std::endl;
+		stream << "\t\tconst Slot& slot = Slots[hash(name, d) & " << hash.slots().size() - 1 << "];" << std::endl;
+		stream << "\t\treturn slot.name && equal(slot.name, name) ? slot.id : -1;" << std::endl;
+		stream << "\t}" << std::endl;
+		stream << "}" << std::endl;
+		return true;
+	}
+}
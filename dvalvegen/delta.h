@@ -0,0 +1,244 @@
+#pragma once
+
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "dvalvegen.h"
+#include "simd.h"
+
+namespace dvalvegen {
+	inline std::uint64_t diffMask64(const std::uint8_t* a, const std::uint8_t* b) {
+		/// One bit per byte that differs between two 64 byte blocks
+#if defined(DVALVEGEN_AVX2)
+		__m256i eq0 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)a), _mm256_loadu_si256((const __m256i*)b));
+		__m256i eq1 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(a + 32)), _mm256_loadu_si256((const __m256i*)(b + 32)));
+		std::uint64_t lo = (std::uint32_t)_mm256_movemask_epi8(eq0);
+		std::uint64_t hi = (std::uint32_t)_mm256_movemask_epi8(eq1);
+		return ~(lo | (hi << 32));
+#elif defined(DVALVEGEN_SSE2)
+		std::uint64_t eq = 0;
+		for (int i = 0; i < 4; i++) {
+			__m128i va = _mm_loadu_si128((const __m128i*)(a + i * 16));
+			__m128i vb = _mm_loadu_si128((const __m128i*)(b + i * 16));
+			eq |= (std::uint64_t)(std::uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) << (i * 16);
+		}
+		return ~eq;
+#else
+		std::uint64_t mask = 0;
+		for (int i = 0; i < 64; i += 8) {
+			std::uint64_t wa, wb;
+			std::memcpy(&wa, a + i, 8);
+			std::memcpy(&wb, b + i, 8);
+
+			if (wa != wb) {
+				for (int j = 0; j < 8; j++) {
+					if (a[i + j] != b[i + j]) {
+						mask |= 1ull << (i + j);
+					}
+				}
+			}
+		}
+		return mask;
+#endif
+	}
+
+	inline std::uint64_t diffMaskTail(const std::uint8_t* a, const std::uint8_t* b, int n) {
+		/// Same as diffMask64 for the last, partial block (n < 64)
+		std::uint64_t mask = 0;
+		for (int i = 0; i < n; i++) {
+			if (a[i] != b[i]) {
+				mask |= 1ull << i;
+			}
+		}
+		return mask;
+	}
+
+	class DeltaPlan {
+		/// Byte span and field table of one class, used to diff two snapshots of an entity
+	public:
+		DeltaPlan(Class& cls) {
+			std::vector<FlatField> flat = cls.getFlatFields();
+
+			int end = 0;
+			m_base = -1;
+			for (auto& f : flat) {
+				if (f.size <= 0) {
+					continue;
+				}
+
+				if (m_base == -1) {
+					m_base = f.offset;
+				}
+
+				m_fields.push_back({ f.prop, f.offset, f.size });
+				end = std::max(end, f.offset + f.size);
+			}
+
+			if (m_base == -1) {
+				m_base = 0;
+			}
+
+			m_size = end - m_base;
+			for (auto& f : m_fields) {
+				f.offset -= m_base;
+			}
+
+			// For every 64 byte block, the first field that reaches into it
+			// Fields are sorted by offset, so scanning from there until a field starts past the block is enough
+			uint nblocks = (m_size + 63) / 64;
+			m_blockfirst.assign(nblocks, (uint)m_fields.size());
+			for (uint i = 0; i < m_fields.size(); i++) {
+				uint first = m_fields[i].offset / 64;
+				uint last = (m_fields[i].offset + m_fields[i].size - 1) / 64;
+				for (uint b = first; b <= last; b++) {
+					m_blockfirst[b] = std::min(m_blockfirst[b], i);
+				}
+			}
+		}
+
+		int base() const {
+			return m_base;
+		}
+
+		int size() const {
+			return m_size;
+		}
+
+		uint numFields() const {
+			return (uint)m_fields.size();
+		}
+
+		uint numWords() const {
+			return ((uint)m_fields.size() + 63) / 64;
+		}
+
+		ClassProp* field(uint i) const {
+			return m_fields[i].prop;
+		}
+
+		uint fieldId(uint i) const {
+			return m_fields[i].prop->id();
+		}
+
+		std::string fieldName(uint i) const {
+			return m_fields[i].prop->getFormattedName();
+		}
+
+		int fieldOffset(uint i) const {
+			return m_base + m_fields[i].offset;
+		}
+
+		int fieldSize(uint i) const {
+			return m_fields[i].size;
+		}
+
+		void capture(const void* entity, void* out) const {
+			/// Copies the networked byte span of an entity, out must hold size() bytes
+			std::memcpy(out, (const std::uint8_t*)entity + m_base, m_size);
+		}
+
+		uint compare(const void* prev, const void* cur, std::uint64_t* changed) const {
+			/// Diffs two snapshots made by capture(), fills numWords() words of changed-field bits
+			/// Returns the number of changed fields
+			const std::uint8_t* a = (const std::uint8_t*)prev;
+			const std::uint8_t* b = (const std::uint8_t*)cur;
+			uint nchanged = 0;
+
+			std::memset(changed, 0, sizeof(std::uint64_t) * numWords());
+
+			for (int start = 0, block = 0; start < m_size; start += 64, block++) {
+				int len = std::min(64, m_size - start);
+				std::uint64_t mask = len == 64 ? diffMask64(a + start, b + start) : diffMaskTail(a + start, b + start, len);
+
+				if (!mask) {
+					continue;
+				}
+
+				for (uint i = m_blockfirst[block]; i < m_fields.size() && m_fields[i].offset < start + 64; i++) {
+					int lo = std::max(m_fields[i].offset, start) - start;
+					int hi = std::min(m_fields[i].offset + m_fields[i].size, start + 64) - start;
+
+					if (hi <= lo) {
+						continue;
+					}
+
+					std::uint64_t range = (hi - lo == 64 ? ~0ull : (1ull << (hi - lo)) - 1) << lo;
+					std::uint64_t bit = 1ull << (i & 63);
+
+					if ((mask & range) && !(changed[i >> 6] & bit)) {
+						changed[i >> 6] |= bit;
+						nchanged++;
+					}
+				}
+			}
+
+			return nchanged;
+		}
+
+		uint compareMany(const void* prev, const void* cur, uint count, std::uint64_t* changed) const {
+			/// Diffs count snapshots laid out back to back (size() bytes each)
+			/// changed receives numWords() words per entity, returns the number of entities that changed
+			const std::uint8_t* a = (const std::uint8_t*)prev;
+			const std::uint8_t* b = (const std::uint8_t*)cur;
+			uint nentities = 0;
+
+			for (uint i = 0; i < count; i++) {
+				if (compare(a + (std::size_t)i * m_size, b + (std::size_t)i * m_size, changed + (std::size_t)i * numWords())) {
+					nentities++;
+				}
+			}
+
+			return nentities;
+		}
+
+		template<typename F>
+		void forEachChanged(const std::uint64_t* changed, F fn) const {
+			/// Calls fn(i) for every set bit, where i is the plan-local field index
+			for (uint w = 0; w < numWords(); w++) {
+				std::uint64_t bits = changed[w];
+				while (bits) {
+					fn(w * 64 + (uint)simd::ctz64(bits));
+					bits &= bits - 1;
+				}
+			}
+		}
+
+	private:
+		struct Entry {
+			ClassProp* prop;
+			int offset;
+			int size;
+		};
+
+		int m_base = 0;
+		int m_size = 0;
+		std::vector<Entry> m_fields;
+		std::vector<uint> m_blockfirst;
+	};
+
+	// Plans point into the model, they're dropped with it
+	std::unordered_map<std::string, DeltaPlan> g_DeltaPlans;
+	std::uint64_t g_DeltaPlansGeneration = 0;
+
+	DeltaPlan& getDeltaPlan(const std::string& tablename) {
+		/// Plans handed out before the model changed (createClasses, addVersion, resetClasses) are invalid, get them again
+		if (g_DeltaPlansGeneration != g_ModelGeneration) {
+			g_DeltaPlans.clear();
+			g_DeltaPlansGeneration = g_ModelGeneration;
+		}
+
+		auto it = g_DeltaPlans.find(tablename);
+		if (it == g_DeltaPlans.end()) {
+			it = g_DeltaPlans.try_emplace(tablename, g_Classes.at(tablename)).first;
+		}
+
+		return it->second;
+	}
+
+	DeltaPlan& getDeltaPlan(ClientClass* cclass) {
+		return getDeltaPlan(cclass->m_pRecvTable->GetName());
+	}
+}
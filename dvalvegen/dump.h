@@ -0,0 +1,475 @@
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <initializer_list>
+
+#include "dvalvegen.h"
+#include "classids.h"
+
+namespace dvalvegen {
+	// Human readable dumps of the class graph, every format gets the same callbacks from one traversal
+	// so NetVars.txt, ClassIds.h and the machine readable ones can all come out of a single pass:
+	//   TreeDump nvs{ "NetVars.txt" };
+	//   CsvDump csv{ "NetVars.csv" };
+	//   dumpGraph(head, { &nvs, &csv });
+
+	class DumpWriter {
+		/// Buffered file output, nothing is flushed or allocated per line
+	public:
+		DumpWriter(const std::string& path, std::size_t buffersize = 1 << 16) {
+			m_file = std::fopen(path.c_str(), "wb");
+			m_failed = m_file == nullptr; // close() has to report it even if nothing was ever flushed
+			m_buffer.reset(new char[buffersize]);
+			m_capacity = buffersize;
+		}
+
+		~DumpWriter() {
+			close();
+		}
+
+		DumpWriter(const DumpWriter&) = delete;
+		DumpWriter& operator=(const DumpWriter&) = delete;
+
+		bool ok() const {
+			return m_file && !m_failed;
+		}
+
+		bool close() {
+			if (m_file) {
+				flush();
+				m_failed |= std::fclose(m_file) != 0;
+				m_file = nullptr;
+			}
+
+			return !m_failed;
+		}
+
+		void put(const char* s, std::size_t n) {
+			if (m_used + n > m_capacity) {
+				flush();
+
+				// Doesn't fit even into an empty buffer
+				if (n > m_capacity) {
+					write(s, n);
+					return;
+				}
+			}
+
+			std::memcpy(m_buffer.get() + m_used, s, n);
+			m_used += n;
+		}
+
+		void put(const char* s) {
+			put(s, std::strlen(s));
+		}
+
+		void put(char c) {
+			if (m_used == m_capacity) {
+				flush();
+			}
+
+			m_buffer[m_used++] = c;
+		}
+
+		void putInt(std::int64_t v) {
+			char digits[24];
+			char* p = digits + sizeof(digits);
+			std::uint64_t u = v < 0 ? 0 - (std::uint64_t)v : (std::uint64_t)v;
+
+			do {
+				*--p = (char)('0' + u % 10);
+				u /= 10;
+			} while (u);
+
+			if (v < 0) {
+				*--p = '-';
+			}
+
+			put(p, digits + sizeof(digits) - p);
+		}
+
+		void putHex(std::uint32_t v) {
+			/// Lowercase without leading zeros, like std::hex
+			char digits[8];
+			char* p = digits + sizeof(digits);
+
+			do {
+				*--p = "0123456789abcdef"[v & 0xF];
+				v >>= 4;
+			} while (v);
+
+			put(p, digits + sizeof(digits) - p);
+		}
+
+		void putJson(const char* s, bool quoted = true) {
+			/// Escaped JSON string, unquoted to build one from several parts
+			if (quoted) {
+				put('"');
+			}
+
+			while (*s) {
+				// Names hardly ever need escaping, copy the plain run in one go
+				const char* run = s;
+				while (*s && *s != '"' && *s != '\\' && (unsigned char)*s >= 0x20) {
+					s++;
+				}
+				put(run, s - run);
+
+				if (*s == '"' || *s == '\\') {
+					put('\\');
+					put(*s++);
+				}
+				else if (*s) {
+					put("\\u00", 4);
+					put("0123456789abcdef"[(*s >> 4) & 0xF]);
+					put("0123456789abcdef"[*s & 0xF]);
+					s++;
+				}
+			}
+
+			if (quoted) {
+				put('"');
+			}
+		}
+
+		static bool csvNeedsQuotes(const char* s) {
+			return std::strpbrk(s, ",\"\r\n") != nullptr;
+		}
+
+		void putCsv(const char* s) {
+			/// Quoted only if it has to be
+			if (!csvNeedsQuotes(s)) {
+				put(s);
+				return;
+			}
+
+			put('"');
+			putCsvQuoted(s);
+			put('"');
+		}
+
+		void putCsvQuoted(const char* s) {
+			/// Inside a quoted field, quotes are doubled
+			for (; *s; s++) {
+				if (*s == '"') {
+					put('"');
+				}
+				put(*s);
+			}
+		}
+
+		void flush() {
+			if (m_used) {
+				write(m_buffer.get(), m_used);
+				m_used = 0;
+			}
+		}
+
+	private:
+		void write(const char* s, std::size_t n) {
+			if (!m_file || std::fwrite(s, 1, n, m_file) != n) {
+				m_failed = true;
+			}
+		}
+
+		std::FILE* m_file = nullptr;
+		std::unique_ptr<char[]> m_buffer;
+		std::size_t m_capacity = 0;
+		std::size_t m_used = 0;
+		bool m_failed = false;
+	};
+
+	struct DumpProp {
+		ClientClass* cclass;
+		RecvTable* table;			// Table the prop is in
+		RecvProp* prop;
+		uint depth;					// Levels below the class's table
+		int absolute;				// Offset from the start of the entity, the datatables on the way added up
+		const char* const* path;	// Prop names from the class's table down to this one
+		uint pathsize;
+	};
+
+	class DumpFormat {
+		/// Receives the traversal of dumpGraph, implementations override what they need
+	public:
+		DumpFormat(const std::string& path) : m_out{ path } {
+
+		}
+
+		virtual ~DumpFormat() {
+
+		}
+
+		virtual void begin(ClientClass* /*head*/) {
+
+		}
+
+		virtual void beginClass(ClientClass* /*cclass*/) {
+
+		}
+
+		virtual void table(ClientClass* /*cclass*/, RecvTable* /*table*/, uint /*depth*/) {
+
+		}
+
+		virtual void prop(const DumpProp& /*prop*/) {
+
+		}
+
+		virtual void endClass(ClientClass* /*cclass*/) {
+
+		}
+
+		virtual void end(ClientClass* /*head*/) {
+
+		}
+
+		bool ok() const {
+			return m_out.ok();
+		}
+
+		bool close() {
+			return m_out.close();
+		}
+
+	protected:
+		DumpWriter m_out;
+	};
+
+	class TreeDump : public DumpFormat {
+		/// The indented NetVars.txt layout, datatables are marked with ! and expanded below
+	public:
+		TreeDump(const std::string& path) : DumpFormat{ path } {
+
+		}
+
+		void table(ClientClass* /*cclass*/, RecvTable* table, uint depth) override {
+			indent(depth);
+			m_out.put(table->m_pNetTableName ? table->m_pNetTableName : "Unknown");
+			m_out.put('\n');
+		}
+
+		void prop(const DumpProp& prop) override {
+			indent(prop.depth);
+			m_out.put(prop.prop->szGetName());
+			m_out.put(" [ 0x");
+			m_out.putHex((std::uint32_t)prop.prop->GetOffset());
+
+			if (prop.prop->GetType() == DPT_DataTable) {
+				m_out.put(" ] !\n");
+			}
+			else {
+				m_out.put(" ] ");
+				m_out.put(propTypeName(prop.prop->GetType()));
+				m_out.put('\n');
+			}
+		}
+
+		void endClass(ClientClass* /*cclass*/) override {
+			m_out.put('\n');
+		}
+
+	private:
+		void indent(uint depth) {
+			for (uint i = 0; i < depth; i++) {
+				m_out.put(" -> ");
+			}
+		}
+	};
+
+	class ClassIdDump : public DumpFormat {
+		/// ClassIds.h, the ClassId enum followed by the constexpr name lookup from printClassIdHash
+	public:
+		ClassIdDump(const std::string& path) : DumpFormat{ path } {
+
+		}
+
+		void begin(ClientClass* /*head*/) override {
+			m_out.put("#pragma once\n\nenum ClassId {\n");
+		}
+
+		void beginClass(ClientClass* cclass) override {
+			m_out.put('\t');
+			m_out.put(cclass->m_pNetworkName ? cclass->m_pNetworkName : "Unknown");
+			m_out.put(" = ");
+			m_out.putInt(cclass->m_ClassID);
+			m_out.put(cclass->m_pNext ? ",\n" : "\n");
+		}
+
+		void end(ClientClass* head) override {
+			m_out.put("};\n\n");
+
+			// Once per dump, not worth its own writer
+			std::ostringstream hash;
+			printClassIdHash(head, hash);
+			m_out.put(hash.str().c_str());
+		}
+	};
+
+	class JsonLinesDump : public DumpFormat {
+		/// One JSON object per prop, path is the dotted name from the class's table
+	public:
+		JsonLinesDump(const std::string& path) : DumpFormat{ path } {
+
+		}
+
+		void prop(const DumpProp& prop) override {
+			m_out.put("{\"class\":");
+			m_out.putJson(prop.cclass->m_pNetworkName ? prop.cclass->m_pNetworkName : "Unknown");
+			m_out.put(",\"table\":");
+			m_out.putJson(prop.table->m_pNetTableName ? prop.table->m_pNetTableName : "Unknown");
+			m_out.put(",\"path\":\"");
+			for (uint i = 0; i < prop.pathsize; i++) {
+				if (i) {
+					m_out.put('.');
+				}
+				m_out.putJson(prop.path[i], false);
+			}
+			m_out.put("\",\"type\":\"");
+			m_out.put(propTypeName(prop.prop->GetType()));
+			m_out.put("\",\"offset\":");
+			m_out.putInt(prop.prop->GetOffset());
+			m_out.put(",\"absolute\":");
+			m_out.putInt(prop.absolute);
+			m_out.put(",\"elements\":");
+			m_out.putInt(prop.prop->GetNumElements());
+			m_out.put(",\"stride\":");
+			m_out.putInt(prop.prop->GetElementStride());
+			m_out.put(",\"flags\":");
+			m_out.putInt(prop.prop->GetFlags());
+			m_out.put("}\n");
+		}
+	};
+
+	class CsvDump : public DumpFormat {
+		/// One row per prop with the offset flattened to the start of the entity
+	public:
+		CsvDump(const std::string& path) : DumpFormat{ path } {
+
+		}
+
+		void begin(ClientClass* /*head*/) override {
+			m_out.put("class,table,path,type,offset,absolute,elements,stride,flags\n");
+		}
+
+		void prop(const DumpProp& prop) override {
+			m_out.putCsv(prop.cclass->m_pNetworkName ? prop.cclass->m_pNetworkName : "Unknown");
+			m_out.put(',');
+			m_out.putCsv(prop.table->m_pNetTableName ? prop.table->m_pNetTableName : "Unknown");
+			m_out.put(',');
+
+			bool quoted = false;
+			for (uint i = 0; i < prop.pathsize; i++) {
+				quoted |= DumpWriter::csvNeedsQuotes(prop.path[i]);
+			}
+
+			if (quoted) {
+				m_out.put('"');
+			}
+			for (uint i = 0; i < prop.pathsize; i++) {
+				if (i) {
+					m_out.put('.');
+				}
+
+				if (quoted) {
+					m_out.putCsvQuoted(prop.path[i]);
+				}
+				else {
+					m_out.put(prop.path[i]);
+				}
+			}
+			if (quoted) {
+				m_out.put('"');
+			}
+			m_out.put(',');
+			m_out.put(propTypeName(prop.prop->GetType()));
+			m_out.put(',');
+			m_out.putInt(prop.prop->GetOffset());
+			m_out.put(',');
+			m_out.putInt(prop.absolute);
+			m_out.put(',');
+			m_out.putInt(prop.prop->GetNumElements());
+			m_out.put(',');
+			m_out.putInt(prop.prop->GetElementStride());
+			m_out.put(',');
+			m_out.putInt(prop.prop->GetFlags());
+			m_out.put('\n');
+		}
+	};
+
+	class DumpWalker {
+		/// Walks every class's table tree once and hands each table and prop to all formats
+	public:
+		DumpWalker(std::initializer_list<DumpFormat*> formats) : m_formats{ formats } {
+			m_path.reserve(32);
+		}
+
+		std::uint64_t walk(ClientClass* head) {
+			/// Returns the number of props visited, datatables included
+			m_props = 0;
+
+			for (DumpFormat* f : m_formats) {
+				f->begin(head);
+			}
+
+			for (ClientClass* cclass = head; cclass; cclass = cclass->m_pNext) {
+				for (DumpFormat* f : m_formats) {
+					f->beginClass(cclass);
+				}
+
+				if (cclass->m_pRecvTable) {
+					walkTable(cclass, cclass->m_pRecvTable, 0, 0);
+				}
+
+				for (DumpFormat* f : m_formats) {
+					f->endClass(cclass);
+				}
+			}
+
+			for (DumpFormat* f : m_formats) {
+				f->end(head);
+			}
+
+			return m_props;
+		}
+
+	private:
+		void walkTable(ClientClass* cclass, RecvTable* table, uint depth, int base) {
+			for (DumpFormat* f : m_formats) {
+				f->table(cclass, table, depth);
+			}
+
+			for (int i = 0; i < table->GetNumProps(); i++) {
+				RecvProp* prop = table->GetProp(i);
+				m_path.push_back(prop->szGetName());
+
+				DumpProp dp{ cclass, table, prop, depth + 1, base + prop->GetOffset(), m_path.data(), (uint)m_path.size() };
+				for (DumpFormat* f : m_formats) {
+					f->prop(dp);
+				}
+				m_props++;
+
+				if (prop->GetType() == DPT_DataTable && prop->GetDataTable()) {
+					walkTable(cclass, prop->GetDataTable(), depth + 1, dp.absolute);
+				}
+
+				m_path.pop_back();
+			}
+		}
+
+		std::vector<DumpFormat*> m_formats;
+		std::vector<const char*> m_path;
+		std::uint64_t m_props = 0;
+	};
+
+	std::uint64_t dumpGraph(ClientClass* head, std::initializer_list<DumpFormat*> formats) {
+		/// Runs every format over the graph in one pass, returns the number of props visited
+		return DumpWalker{ formats }.walk(head);
+	}
+}
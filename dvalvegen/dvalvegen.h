@@ -2,10 +2,26 @@
 
 #include <string>
 #include <vector>
+#include <map>
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
 #include <sstream>
+#include <fstream>
 #include <filesystem>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <functional>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "trace.h"
+#include "ring.h"
+#include "memory.h"
 
 namespace dvalvegen {
 	using uint = unsigned int;
@@ -16,7 +32,20 @@ namespace dvalvegen {
 	class RecvProp;
 	class CRecvProxyData;
 	class IClientNetworkable;
-	enum SendPropType;
+	class SyntheticGraph;
+
+	enum SendPropType
+	{
+		DPT_Int = 0,
+		DPT_Float,
+		DPT_Vector,
+		DPT_VectorXY, // Only encodes the XY of a vector, ignores Z
+		DPT_String,
+		DPT_Array,	// An array of the base types (can't be of datatables).
+		DPT_DataTable,
+		DPT_Int64,
+		DPT_NUMSendPropTypes
+	};
 
 	class DVariant
 	{
@@ -29,30 +58,18 @@ namespace dvalvegen {
 			const char	*m_pString;
 			void	*m_pData;
 			float	m_Vector[3];
-			__int64	m_Int64;
+			std::int64_t	m_Int64;
 		};
 		SendPropType	m_Type;
 	};
 
-	enum SendPropType
-	{
-		DPT_Int = 0,
-		DPT_Float,
-		DPT_Vector,
-		DPT_VectorXY, // Only encodes the XY of a vector, ignores Z
-		DPT_String,
-		DPT_Array,	// An array of the base types (can't be of datatables).
-		DPT_DataTable,
-		DPT_Int64,
-		DPT_NUMSendPropTypes
-	};
-
 	typedef void(*RecvVarProxyFn)(const CRecvProxyData *pData, void *pStruct, void *pOut);
 	typedef void(*DataTableRecvVarProxyFn)(const RecvProp *pProp, void **pOut, void *pData, int objectID);
 	typedef void(*ArrayLengthRecvProxyFn)(void *pStruct, int objectID, int currentArrayLength);
 
 	class RecvProp
 	{
+		friend class SyntheticGraph;
 
 	public:
 
@@ -273,7 +290,22 @@ namespace dvalvegen {
 		int				m_ClassID;	// Managed by the engine.
 	};
 
-	std::unordered_map<std::string, Class> g_Classes;
+	// Names kept by the model, counted under memory::Names
+	using ModelName = memory::String<memory::Names>;
+
+	memory::Map<ModelName, Class, memory::Classes> g_Classes;
+	memory::Vector<ClassProp*, memory::Props> g_Fields; // Indexed by field ID
+	ClientClass* g_ClientClasses = nullptr; // Last list passed to createClasses
+	bool g_BakeOffsets = false;
+	memory::Set<RecvTable*, memory::Classes> g_WalkedTables;
+	std::uint64_t g_ModelGeneration = 0; // Bumped whenever the model changes, caches built from it compare against it
+
+	struct SdkVersion {
+		std::string name;
+		ClientClass* head;
+	};
+
+	std::vector<SdkVersion> g_Versions; // Builds merged with addVersion, each gets its own offset column
 
 	class FCharBuffer {
 		/// String buffer that expands but never shrinks
@@ -283,26 +315,35 @@ namespace dvalvegen {
 				return;
 			}
 
-			char* newmem = (char*)std::malloc(sizeof(char) * (newsize + 1));
+			// pop only gives back size, the memory is still there
+			if (newsize <= m_capacity) {
+				m_size = newsize;
+				return;
+			}
+
+			char* newmem = (char*)memory::resource(memory::Output)->allocate(newsize + 1, 1);
 
 			if (m_data) {
 				std::memcpy(newmem, m_data, sizeof(char) * (m_size + 1));
-				std::free(m_data);
+				memory::resource(memory::Output)->deallocate(m_data, m_capacity + 1, 1);
 			}
 
 			m_data = newmem;
 			m_size = newsize;
+			m_capacity = newsize;
 		}
 
 	public:
 		FCharBuffer(uint size = 0) {
 			m_size = size;
-			m_data = (char*)std::calloc(size + 1, sizeof(char));
+			m_capacity = size;
+			m_data = (char*)memory::resource(memory::Output)->allocate(size + 1, 1);
+			std::memset(m_data, 0, size + 1);
 		}
 
 		~FCharBuffer() {
 			if (m_data) {
-				std::free(m_data);
+				memory::resource(memory::Output)->deallocate(m_data, m_capacity + 1, 1);
 			}
 		}
 
@@ -336,6 +377,7 @@ namespace dvalvegen {
 
 	private:
 		uint m_size = 0;
+		uint m_capacity = 0; // What m_data was allocated with
 		uint m_null = 0;
 		char* m_data = nullptr;
 	};
@@ -369,6 +411,72 @@ namespace dvalvegen {
 	};
 
 
+	inline const char* propTypeName(SendPropType type) {
+		switch (type) {
+		case DPT_Int:
+			return "Int";
+		case DPT_Float:
+			return "Float";
+		case DPT_Vector:
+			return "Vector";
+		case DPT_VectorXY:
+			return "VectorXY";
+		case DPT_String:
+			return "String";
+		case DPT_Array:
+			return "Array";
+		case DPT_DataTable:
+			return "DataTable";
+		case DPT_Int64:
+			return "Int64";
+		case DPT_NUMSendPropTypes:
+			return "NUMSendPropTypes";
+		default:
+			return "UnknownType";
+		}
+	}
+
+	int getPropSize(RecvProp* p);
+
+	int getArrayStride(RecvTable* table) {
+		/// Distance between the elements of an array table
+		int n = table->GetNumProps();
+		if (n == 0) {
+			return 0;
+		}
+
+		return n > 1 ? table->GetProp(1)->GetOffset() - table->GetProp(0)->GetOffset() : getPropSize(table->GetProp(0));
+	}
+
+	int getPropSize(RecvProp* p) {
+		/// Size of the prop in the entity's memory, as far as the recv table can tell
+		switch (p->GetType()) {
+		case DPT_Int:
+		case DPT_Float:
+			return 4;
+		case DPT_Int64:
+			return 8;
+		case DPT_Vector:
+			return 12;
+		case DPT_VectorXY:
+			return 8;
+		case DPT_String:
+			return p->m_StringBufferSize;
+		case DPT_DataTable: {
+			// Only arrays have a meaningful size here, nested classes are flattened instead
+			RecvTable* table = p->GetDataTable();
+			int n = table->GetNumProps();
+			if (n == 0) {
+				return 0;
+			}
+
+			return getArrayStride(table) * (n - 1) + getPropSize(table->GetProp(0));
+		}
+		default:
+			return 0;
+		}
+	}
+
 	class ClassProp {
 	public:
 		ClassProp(RecvProp* prop, uint addoffset = 0) {
@@ -381,12 +489,25 @@ namespace dvalvegen {
 			return m_prop;
 		}
 
+		uint id() {
+			return m_id;
+		}
+
+		Class* parent() {
+			return m_parent;
+		}
+
+		void bind(Class* parent, uint id) {
+			m_parent = parent;
+			m_id = id;
+		}
+
 		std::string getFormattedName() {
 			if (m_fname == "") {
 				m_fname = m_prop->GetName();
 
 				while (true) {
-					int p = m_fname.find("[");
+					std::size_t p = m_fname.find("[");
 					if (p != std::string::npos) {
 						m_fname[p] = '_';
 					}
@@ -396,7 +517,7 @@ namespace dvalvegen {
 				}
 
 				while (true) {
-					int p = m_fname.find("]");
+					std::size_t p = m_fname.find("]");
 					if (p != std::string::npos) {
 						m_fname.erase(m_fname.begin() + p);
 					}
@@ -406,7 +527,7 @@ namespace dvalvegen {
 				}
 
 				while (true) {
-					int p = m_fname.find(".");
+					std::size_t p = m_fname.find(".");
 					if (p != std::string::npos) {
 						m_fname[p] = '_';
 					}
@@ -416,7 +537,7 @@ namespace dvalvegen {
 				}
 
 				while (true) {
-					int p = m_fname.find("\"");
+					std::size_t p = m_fname.find("\"");
 					if (p != std::string::npos) {
 						m_fname.erase(m_fname.begin() + p);
 					}
@@ -433,13 +554,22 @@ namespace dvalvegen {
 			return m_fname;
 		}
 
-		void print(std::ostream& stream, int indents, Class& parent, std::unordered_set<std::string>& dependencies);
+		void print(std::ostream& stream, int indents, std::unordered_set<std::string>& forwards);
+		void printBaked(std::ostream& stream, int indents, const std::string& getter);
 
 	private:
-		std::string m_fname;
+		ModelName m_fname;
 		SendPropType m_type;
 		uint m_addoffset;
 		RecvProp* m_prop;
+		uint m_id = (uint)-1;
+		Class* m_parent = nullptr;
+	};
+
+	struct FlatField {
+		ClassProp* prop;
+		int offset;
+		int size;
 	};
 
 	class Class {
@@ -455,7 +585,7 @@ namespace dvalvegen {
 
 		void addBaseclass(std::string baseclass) {
 			for (auto& it : m_baseclasses) {
-				if (it == baseclass) {
+				if (it.str() == baseclass) {
 					return;
 				}
 			}
@@ -465,18 +595,23 @@ namespace dvalvegen {
 
 		void addProp(RecvProp* prop, uint addoffset = 0) {
 			ClassProp p{ prop, addoffset };
-			m_props.try_emplace(p.getFormattedName(), p);
+			auto it = m_props.try_emplace(p.getFormattedName(), p);
+			if (it.second) {
+				it.first->second.bind(this, (uint)g_Fields.size());
+				g_Fields.push_back(&it.first->second);
+				DVALVEGEN_TRACE_COUNT(Props, 1);
+			}
 		}
 
 		std::string getBaseclass(int i) {
 			return m_baseclasses[i];
 		}
 
-		std::vector<std::string>& baseclasses() {
+		memory::Vector<ModelName, memory::Classes>& baseclasses() {
 			return m_baseclasses;
 		}
 
-		std::unordered_map<std::string, ClassProp>& props() {
+		memory::Map<ModelName, ClassProp, memory::Props>& props() {
 			return m_props;
 		}
 
@@ -495,7 +630,38 @@ namespace dvalvegen {
 			return m_table->GetName();
 		}
 
-		void print(std::ostream& stream, int indents, std::unordered_set<std::string>& dependencies) {
+		RecvTable* table() {
+			return m_table;
+		}
+
+		void flatten(std::vector<FlatField>& fields, int base = 0);
+		void printReflection(std::ostream& stream, std::unordered_set<std::string>& dependencies);
+
+		std::vector<FlatField> getFlatFields() {
+			/// All leaf fields of the class including base classes and nested tables, sorted by absolute offset
+			std::vector<FlatField> fields;
+			flatten(fields);
+
+			std::stable_sort(fields.begin(), fields.end(), [](const FlatField& a, const FlatField& b) {
+				return a.offset < b.offset;
+			});
+
+			// Ints are assumed to be 4 bytes wide, but plenty of them are bools or shorts,
+			// so don't let a field run into the next one
+			for (uint i = 0; i < fields.size(); i++) {
+				for (uint j = i + 1; j < fields.size(); j++) {
+					if (fields[j].offset > fields[i].offset) {
+						fields[i].size = std::min(fields[i].size, fields[j].offset - fields[i].offset);
+						break;
+					}
+				}
+			}
+
+			return fields;
+		}
+
+		void print(std::ostream& stream, int indents, std::unordered_set<std::string>& dependencies, std::unordered_set<std::string>& forwards) {
+			/// dependencies need a full include (base classes), forwards are only used through pointers and get declared
 			static Indenter ind{ "\t" };
 
 			stream << ind.get(indents) << "class " << getFormattedName();
@@ -519,9 +685,9 @@ namespace dvalvegen {
 
 				stream << " {" << std::endl << ind.get(indents) << "public:" << std::endl;
 
-				int propsdone = 0;
-				for (auto p : m_props) {
-					p.second.print(stream, indents + 1, *this, dependencies);
+				std::size_t propsdone = 0;
+				for (auto& p : m_props) {
+					p.second.print(stream, indents + 1, forwards);
 					
 					if (propsdone != m_props.size() - 1) {
 						stream << std::endl;
@@ -535,9 +701,9 @@ namespace dvalvegen {
 		}
 
 	private:
-		std::string m_fname = "";
-		std::vector<std::string> m_baseclasses;
-		std::unordered_map<std::string, ClassProp> m_props;
+		ModelName m_fname;
+		memory::Vector<ModelName, memory::Classes> m_baseclasses;
+		memory::Map<ModelName, ClassProp, memory::Props> m_props;
 		RecvTable* m_table = nullptr;
 	};
 
@@ -546,13 +712,13 @@ namespace dvalvegen {
 
 		switch (p->GetType()) {
 		case DPT_Int:
-			r = "__int32";
+			r = "std::int32_t";
 			break;
 		case DPT_Float:
 			r = "float";
 			break;
 		case DPT_Int64:
-			r = "__int64";
+			r = "std::int64_t";
 			break;
 		case DPT_Vector:
 			r = "Vector";
@@ -574,7 +740,21 @@ namespace dvalvegen {
 		return r;
 	}
 
-	void ClassProp::print(std::ostream& stream, int indents, Class& parent, std::unordered_set<std::string>& dependencies) {
+	void ClassProp::printBaked(std::ostream& stream, int indents, const std::string& getter) {
+		/// Constant offset path of an accessor, used while the live graph matches the baked one
+		static Indenter ind{ "\t" };
+
+		if (!g_BakeOffsets) {
+			return;
+		}
+
+		stream << ind.get(indents) << "if (dvalvegen::g_Baked) {" << std::endl;
+		stream << ind.get(indents + 1) << "return " << getter << "(this, 0x" << std::hex << m_prop->GetOffset() << std::dec << ");" << std::endl;
+		stream << ind.get(indents) << "}" << std::endl;
+		stream << std::endl;
+	}
+
+	void ClassProp::print(std::ostream& stream, int indents, std::unordered_set<std::string>& forwards) {
 		static Indenter ind{ "\t" };
 
 		if (m_type == DPT_DataTable) {
@@ -582,28 +762,147 @@ namespace dvalvegen {
 				// If there is no class for this table, it must be an array
 				// Ok so if it's an array of other arrays this is going to break, but let's hope Valve never does this				
 				stream << ind.get(indents) << "inline " << type2str(m_prop->GetDataTable()->GetProp(0)) << "* " << getFormattedName() << "() {" << std::endl;
-				stream << ind.get(indents + 1) << "static int offset = dvalvegen::getOffset(\"" << parent.getName() << "\", \"" << getFormattedName() << "\");" << std::endl;
-				stream << ind.get(indents + 1) << "return (" << type2str(m_prop->GetDataTable()->GetProp(0)) << "*)((int)this + offset);" << std::endl;
+				stream << ind.get(indents + 1) << "DVALVEGEN_COUNT(" << m_id << ");" << std::endl;
+				printBaked(stream, indents + 1, "dvalvegen::field<" + type2str(m_prop->GetDataTable()->GetProp(0)) + ">");
+				stream << ind.get(indents + 1) << "return dvalvegen::field<" << type2str(m_prop->GetDataTable()->GetProp(0)) << ">(this, dvalvegen::g_Offsets[" << m_id << "]);" << std::endl;
 				stream << ind.get(indents) << "}" << std::endl;
 				stream << std::endl;
 				stream << ind.get(indents) << "inline int " << getFormattedName() << "_Size() {" << std::endl;
-				stream << ind.get(indents + 1) << "static int ret = dvalvegen::getDTArraySize(\"" << parent.getName() << "\", \"" << getFormattedName() << "\");" << std::endl;
-				stream << ind.get(indents + 1) << "return ret;" << std::endl;
+				if (g_BakeOffsets) {
+					stream << ind.get(indents + 1) << "if (dvalvegen::g_Baked) {" << std::endl;
+					stream << ind.get(indents + 2) << "return " << m_prop->GetDataTable()->GetNumProps() << ";" << std::endl;
+					stream << ind.get(indents + 1) << "}" << std::endl;
+					stream << std::endl;
+				}
+				stream << ind.get(indents + 1) << "return dvalvegen::g_ArraySizes[" << m_id << "];" << std::endl;
 				stream << ind.get(indents) << "}" << std::endl;
 				return;
 			}
 			else {
-				dependencies.emplace(g_Classes[m_prop->GetDataTable()->GetName()].getFormattedName());
+				// Nested classes are only ever returned by pointer, a declaration is enough
+				forwards.emplace(g_Classes[m_prop->GetDataTable()->GetName()].getFormattedName());
 			}
 		}
 
-		stream << ind.get(indents) << "inline " << type2str(m_prop) << "* " << getFormattedName() << "() {" << std::endl;
-		stream << ind.get(indents + 1) << "static int offset = dvalvegen::getOffset(\"" << parent.getName() << "\", \"" << getFormattedName() << "\");" << std::endl;
-		stream << ind.get(indents + 1) << "return (" << type2str(m_prop) << "*)((int)this + offset);" << std::endl;
+		if (m_type == DPT_String) {
+			stream << ind.get(indents) << "inline " << type2str(m_prop) << "* " << getFormattedName() << "() {" << std::endl;
+			stream << ind.get(indents + 1) << "DVALVEGEN_COUNT(" << m_id << ");" << std::endl;
+			printBaked(stream, indents + 1, "dvalvegen::field<" + type2str(m_prop) + ">");
+			stream << ind.get(indents + 1) << "return dvalvegen::field<" << type2str(m_prop) << ">(this, dvalvegen::g_Offsets[" << m_id << "]);" << std::endl;
+			stream << ind.get(indents) << "}" << std::endl;
+			return;
+		}
+
+		// The access policy is a template parameter, so one accessor serves pointers, references, copies and atomic reads
+		stream << ind.get(indents) << "template<typename P = dvalvegen::DefaultAccess>" << std::endl;
+		stream << ind.get(indents) << "DVALVEGEN_FORCEINLINE typename P::template Result<" << type2str(m_prop) << "> " << getFormattedName() << "() {" << std::endl;
+		stream << ind.get(indents + 1) << "DVALVEGEN_COUNT(" << m_id << ");" << std::endl;
+		printBaked(stream, indents + 1, "P::template get<" + type2str(m_prop) + ">");
+		stream << ind.get(indents + 1) << "return P::template get<" << type2str(m_prop) << ">(this, dvalvegen::g_Offsets[" << m_id << "]);" << std::endl;
 		stream << ind.get(indents) << "}" << std::endl;
 	}
 
-	void createClass(RecvTable* table, Class* parent = nullptr) {
+	void Class::flatten(std::vector<FlatField>& fields, int base) {
+		for (auto& bc : m_baseclasses) {
+			// Baseclass props are always at offset 0
+			g_Classes[bc].flatten(fields, base);
+		}
+
+		for (auto& p : m_props) {
+			RecvProp* prop = p.second.prop();
+			int offset = base + prop->GetOffset();
+
+			if (prop->GetType() == DPT_DataTable && g_Classes.count(prop->GetDataTable()->GetName()) != 0) {
+				g_Classes[prop->GetDataTable()->GetName()].flatten(fields, offset);
+			}
+			else {
+				fields.push_back({ &p.second, offset, getPropSize(prop) });
+			}
+		}
+	}
+
+	void Class::printReflection(std::ostream& stream, std::unordered_set<std::string>& dependencies) {
+		/// ClassFields specialization of the class, printed after it in its header
+		/// Inherited fields come from the base classes' specializations, the text only depends on this class
+		static Indenter ind{ "\t" };
+		std::string name = getFormattedName();
+
+		// ClassFields is declared there, classes without props or bases need it as well
+		dependencies.emplace("dvalvegen");
+
+		stream << std::endl << "namespace dvalvegen {" << std::endl;
+		stream << ind.get(1) << "template<>" << std::endl;
+		stream << ind.get(1) << "struct ClassFields<" << name << "> {" << std::endl;
+
+		if (m_props.empty()) {
+			stream << ind.get(2) << "static constexpr std::array<FieldDesc, 0> Declared{};" << std::endl;
+		}
+		else {
+			stream << ind.get(2) << "static constexpr std::array<FieldDesc, " << m_props.size() << "> Declared{{" << std::endl;
+
+			for (auto& p : m_props) {
+				RecvProp* prop = p.second.prop();
+				SendPropType type = prop->GetType();
+				int size = getPropSize(prop);
+				int stride = size;
+				int count = 1;
+
+				if (type == DPT_DataTable) {
+					RecvTable* table = prop->GetDataTable();
+					if (g_Classes.count(table->GetName()) == 0) {
+						// Array, described by its elements
+						type = table->GetProp(0)->GetType();
+						size = getPropSize(table->GetProp(0));
+						stride = getArrayStride(table);
+						count = table->GetNumProps();
+					}
+					else {
+						size = stride = 0;
+					}
+				}
+
+				stream << ind.get(3) << "{ \"" << p.second.getFormattedName() << "\", " << p.second.id() << ", DPT_" << propTypeName(type) << ", "
+					<< size << ", " << stride << ", " << count << " }," << std::endl;
+			}
+
+			stream << ind.get(2) << "}};" << std::endl;
+		}
+
+		stream << ind.get(2) << "static constexpr auto All = joinFields(";
+		for (auto& bc : m_baseclasses) {
+			stream << "ClassFields<" << g_Classes[bc].getFormattedName() << ">::All, ";
+		}
+		stream << "Declared);" << std::endl << std::endl;
+
+		// Every call is spelled out, the compiler sees the accessors exactly as if they were called by hand
+		stream << ind.get(2) << "template<typename V>" << std::endl;
+		if (m_baseclasses.empty() && m_props.empty()) {
+			// Nothing to visit, unnamed so -Wextra doesn't flag them in user code
+			stream << ind.get(2) << "static DVALVEGEN_FORCEINLINE void visit(" << name << "*, V&) {" << std::endl;
+		}
+		else {
+			stream << ind.get(2) << "static DVALVEGEN_FORCEINLINE void visit(" << name << "* self, V& visitor) {" << std::endl;
+		}
+
+		for (auto& bc : m_baseclasses) {
+			stream << ind.get(3) << "ClassFields<" << g_Classes[bc].getFormattedName() << ">::visit(self, visitor);" << std::endl;
+		}
+
+		uint i = 0;
+		for (auto& p : m_props) {
+			RecvProp* prop = p.second.prop();
+			bool plain = prop->GetType() == DPT_String || (prop->GetType() == DPT_DataTable && g_Classes.count(prop->GetDataTable()->GetName()) == 0);
+
+			// Strings and arrays have plain accessors, everything else takes the access policy
+			stream << ind.get(3) << "visitor(Declared[" << i++ << "], self->" << p.second.getFormattedName() << (plain ? "" : "<Pointer>") << "());" << std::endl;
+		}
+
+		stream << ind.get(2) << "}" << std::endl;
+		stream << ind.get(1) << "};" << std::endl;
+		stream << "}" << std::endl;
+	}
+
+	void createClass(RecvTable* table) {
 		std::string tablename = table->GetName();
 
 		if (table->GetNumProps() > 0) {
@@ -620,12 +919,16 @@ namespace dvalvegen {
 		// Create the class if it doesn't exist yet
 		if (g_Classes.count(table->GetName()) == 0) {
 			g_Classes.try_emplace(tablename, Class{ table });
+			DVALVEGEN_TRACE_COUNT(Classes, 1);
 		}
-		else {
+
+		if (!g_WalkedTables.insert(table).second) {
 			// Nothing new here...
 			return;
 		}
 
+		DVALVEGEN_TRACE_SCOPE_DETAIL("createClass", table->m_pNetTableName);
+
 		Class* ctx = &g_Classes[tablename];
 
 		// Now iterate over its props
@@ -674,7 +977,11 @@ namespace dvalvegen {
 	}
 
 	void createClasses(void* clientclass) {
+		DVALVEGEN_TRACE_SCOPE("createClasses");
 		ClientClass* cclass = (ClientClass*)clientclass;
+		g_ClientClasses = cclass;
+		g_ModelGeneration++;
+
 		while (cclass) {
 			if (cclass->m_pRecvTable) {
 				createClass(cclass->m_pRecvTable);
@@ -684,33 +991,252 @@ namespace dvalvegen {
 		}
 	}
 
-	void printClasses(std::string dirpath) {
-		if (dirpath[dirpath.size() - 1] == '/' || dirpath[dirpath.size() - 1] == '\\') {
-			dirpath.erase(dirpath.begin() + dirpath.size() - 1);
+	void addVersion(void* clientclass, const std::string& name) {
+		/// Merges another build's graph into the model, printClasses then emits one SDK with an offset column per version
+		/// Tables and props missing from some builds are kept, the first build a prop was seen in decides its type
+		DVALVEGEN_TRACE_SCOPE("addVersion");
+		ClientClass* cclass = (ClientClass*)clientclass;
+		g_ModelGeneration++;
+		if (!g_ClientClasses) {
+			g_ClientClasses = cclass;
+		}
+
+		for (ClientClass* c = cclass; c; c = c->m_pNext) {
+			if (c->m_pRecvTable) {
+				createClass(c->m_pRecvTable);
+			}
+		}
+
+		g_Versions.push_back({ name, cclass });
+	}
+
+	void resetClasses() {
+		/// Drops the model so another graph can be loaded into the same process
+		/// Swapped out rather than cleared, so the buckets and the field table are given back as well
+		decltype(g_Classes){}.swap(g_Classes);
+		decltype(g_Fields){}.swap(g_Fields);
+		decltype(g_WalkedTables){}.swap(g_WalkedTables);
+		g_Versions.clear();
+		g_ClientClasses = nullptr;
+		g_ModelGeneration++;
+	}
+
+	int propIndex(RecvTable* table, RecvProp* prop) {
+		/// Index of prop in table, by name if it came from another version's table
+		if (prop >= table->m_pProps && prop < table->m_pProps + table->m_nProps) {
+			return (int)(prop - table->m_pProps);
+		}
+
+		for (int i = 0; i < table->m_nProps; i++) {
+			if (table->m_pProps[i].m_pVarName && std::strcmp(table->m_pProps[i].m_pVarName, prop->m_pVarName) == 0) {
+				return i;
+			}
+		}
+
+		return 0;
+	}
+
+	void resolveVersion(ClientClass* cclass, std::vector<int>& offsets, std::vector<int>& sizes, std::vector<char>& present) {
+		/// Same lookup the generated runtime does, by table and prop name, for a version known at generation time
+		DVALVEGEN_TRACE_SCOPE("resolveVersion");
+		offsets.assign(g_Fields.size(), 0);
+		sizes.assign(g_Fields.size(), 0);
+		present.assign(g_Fields.size(), 0);
+
+		std::unordered_map<std::string, std::vector<ClassProp*>> bytable;
+		for (auto p : g_Fields) {
+			bytable[p->parent()->getName()].push_back(p);
+		}
+
+		std::unordered_set<RecvTable*> visited;
+		std::vector<RecvTable*> stack;
+
+		for (; cclass; cclass = cclass->m_pNext) {
+			if (cclass->m_pRecvTable) {
+				stack.push_back(cclass->m_pRecvTable);
+			}
+		}
+
+		while (!stack.empty()) {
+			RecvTable* table = stack.back();
+			stack.pop_back();
+
+			if (!visited.insert(table).second) {
+				continue;
+			}
+
+			auto it = bytable.find(table->GetName());
+			for (int i = 0; i < table->m_nProps; i++) {
+				RecvProp* prop = &table->m_pProps[i];
+
+				if (it != bytable.end() && prop->m_pVarName) {
+					for (auto p : it->second) {
+						if (!present[p->id()] && std::strcmp(p->prop()->m_pVarName, prop->m_pVarName) == 0) {
+							offsets[p->id()] = prop->GetOffset();
+							sizes[p->id()] = prop->GetDataTable() ? prop->GetDataTable()->m_nProps : 0;
+							present[p->id()] = 1;
+						}
+					}
+				}
+
+				if (prop->GetDataTable()) {
+					stack.push_back(prop->GetDataTable());
+				}
+			}
+		}
+	}
+
+	inline std::uint64_t fingerprintMix(std::uint64_t h, std::uint64_t v) {
+		h ^= v + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+		h *= 0xFF51AFD7ED558CCDull;
+		return h ^ (h >> 32);
+	}
+
+	inline std::uint64_t fingerprintString(std::uint64_t h, const char* s) {
+		if (!s) {
+			return fingerprintMix(h, 0);
+		}
+
+		std::uint64_t fnv = 14695981039346656037ull;
+		for (; *s; s++) {
+			fnv = (fnv ^ (std::uint8_t)*s) * 1099511628211ull;
+		}
+
+		return fingerprintMix(h, fnv);
+	}
+
+	std::uint64_t fingerprintTable(RecvTable* table, std::unordered_map<RecvTable*, std::uint64_t>& memo) {
+		auto it = memo.find(table);
+		if (it != memo.end()) {
+			return it->second;
+		}
+
+		std::uint64_t h = fingerprintString(0, table->m_pNetTableName);
+		h = fingerprintMix(h, (std::uint64_t)table->m_nProps);
+
+		for (int i = 0; i < table->m_nProps; i++) {
+			RecvProp* prop = &table->m_pProps[i];
+
+			h = fingerprintString(h, prop->m_pVarName);
+			h = fingerprintMix(h, (std::uint64_t)prop->GetType());
+			h = fingerprintMix(h, (std::uint64_t)(std::uint32_t)prop->GetOffset());
+			h = fingerprintMix(h, (std::uint64_t)(std::uint32_t)prop->GetNumElements());
+
+			if (prop->GetDataTable()) {
+				h = fingerprintMix(h, fingerprintTable(prop->GetDataTable(), memo));
+			}
+		}
+
+		memo[table] = h;
+		return h;
+	}
+
+	std::uint64_t graphFingerprint(ClientClass* cclass) {
+		/// Structural hash of the graph: class IDs and names, table names, prop names, types, offsets and array sizes
+		/// The generated runtime carries a copy of this, both have to produce the same value
+		DVALVEGEN_TRACE_SCOPE("graphFingerprint");
+		std::unordered_map<RecvTable*, std::uint64_t> memo;
+		std::uint64_t h = 0;
+
+		for (; cclass; cclass = cclass->m_pNext) {
+			h = fingerprintMix(h, (std::uint64_t)(std::uint32_t)cclass->m_ClassID);
+			h = fingerprintString(h, cclass->m_pNetworkName);
+			h = fingerprintMix(h, cclass->m_pRecvTable ? fingerprintTable(cclass->m_pRecvTable, memo) : 0);
+		}
+
+		return h;
+	}
+
+	// File name -> contents, everything printClasses would write
+	using SdkFiles = std::map<std::string, std::string>;
+
+	// Takes each generated file as soon as it's rendered, the text can be moved from
+	// Big files come in several pieces with the same name, in order, each one is appended to the last
+	using SdkSink = std::function<void(std::string& name, std::string& text)>;
+
+	constexpr std::streamoff SdkPieceSize = 1 << 18;
+
+	// Rendered class headers by classTextKey, lets a long running generator skip classes that didn't change
+	using ClassTextCache = std::unordered_map<std::uint64_t, std::string>;
+
+	std::uint64_t classTextKey(Class& c, bool bake) {
+		/// Covers everything Class::print looks at, two classes with the same key render to the same text
+		std::uint64_t h = fingerprintString(0, c.getFormattedName().c_str());
+		h = fingerprintMix(h, bake);
+
+		for (auto& bc : c.baseclasses()) {
+			h = fingerprintString(h, g_Classes[bc].getFormattedName().c_str());
 		}
 
-		dirpath += "/dvalvegen/";
+		// Same iteration order as print
+		for (auto& p : c.props()) {
+			RecvProp* prop = p.second.prop();
+			// Arrays are tables without a class, described by their elements, type2str would add an empty class for them
+			bool array = prop->GetType() == DPT_DataTable && g_Classes.count(prop->GetDataTable()->GetName()) == 0;
+
+			h = fingerprintString(h, p.second.getFormattedName().c_str());
+			h = fingerprintString(h, array ? "" : type2str(prop).c_str());
+			h = fingerprintMix(h, p.second.id());
+			h = fingerprintMix(h, bake ? (std::uint32_t)prop->GetOffset() : 0);
+			h = fingerprintMix(h, (std::uint32_t)getPropSize(prop)); // Sizes go into the reflection table
+
+			if (array && prop->GetDataTable()->GetNumProps() > 0) {
+				h = fingerprintString(h, type2str(prop->GetDataTable()->GetProp(0)).c_str());
+				h = fingerprintMix(h, (std::uint32_t)prop->GetDataTable()->GetNumProps());
+				h = fingerprintMix(h, (std::uint32_t)getArrayStride(prop->GetDataTable()));
+			}
+		}
+
+		return h;
+	}
+
+	void renderClasses(const SdkSink& emit, bool bake = false, ClassTextCache* cache = nullptr, const std::unordered_set<std::string>* tables = nullptr) {
+		/// With bake set, the current offsets are written into the accessors as constants,
+		/// the generated initialize() only falls back to resolving them if the live graph differs
+		/// With tables set, only the headers of those classes are rendered, e.g. from regenerationFilter, the runtime always is
+		DVALVEGEN_TRACE_SCOPE("renderClasses");
+
+		// An SDK built from several versions already has the offsets of each, there's nothing to bake
+		bake = bake && g_Versions.size() < 2;
+		g_BakeOffsets = bake;
+
+		// Classes of a multi version SDK print every version's offsets, the key doesn't cover those
+		if (g_Versions.size() > 1) {
+			cache = nullptr;
+		}
 
-		std::filesystem::create_directories(dirpath);
+		// The render streams allocate from memory::Output, what's handed to the sink is a plain string
+		auto emitFile = [&emit](std::string name, std::string_view text) {
+			std::string s{ text };
+			emit(name, s);
+		};
 
-		auto write_dvalvegen = [&dirpath]() {
-			std::ofstream oh{ dirpath + "dvalvegen.h" };
+		auto write_dvalvegen = [&emitFile, bake]() {
+			DVALVEGEN_TRACE_SCOPE("writeRuntime");
+			memory::OStream<memory::Output> oh;
 			oh <<
 				"#pragma once\n"
 				"\n"
 				"#include <string>\n"
-				"#include <vector>\n"
-				"#include <unordered_map>\n"
+				"#include <array>\n"
+				"#include <cstddef>\n"
+				"#include <cstdint>\n"
+				"#include <cstring>\n"
 				"#include \"Vector.h\"\n"
 				"\n"
+				"#ifdef _MSC_VER\n"
+				"#include <intrin.h>\n"
+				"#endif\n"
+				"\n"
+				"#ifdef DVALVEGEN_PROFILE\n"
+				"#include <atomic>\n"
+				"#endif\n"
+				"\n"
 				"namespace dvalvegen {\n"
 				"\tusing uint = unsigned int;\n"
 				"\n"
-				"\tclass Class;\n"
-				"\tclass ClassProp;\n"
 				"\tclass RecvTable;\n"
 				"\tclass RecvProp;\n"
-				"\tenum SendPropType;\n"
 				"\n"
 				"\tenum SendPropType {\n"
 				"\t\tDPT_Int = 0,\n"
@@ -814,225 +1340,1698 @@ namespace dvalvegen {
 				"\t\tint m_ClassID;\n"
 				"\t};\n"
 				"\n"
-				"\textern std::unordered_map<std::string, Class> g_Classes;\n"
+				"\t// Resolved offsets and array sizes of every generated field, indexed by field ID\n";
+			oh << "\tconstexpr unsigned int FieldCount = " << g_Fields.size() << ";\n";
+			oh <<
+				"\textern std::int32_t g_Offsets[];\n"
+				"\textern std::int32_t g_ArraySizes[];\n"
 				"\n"
-				"\tclass ClassProp {\n"
-				"\tpublic:\n"
-				"\t\tClassProp(RecvProp* prop, uint addoffset = 0) {\n"
-				"\t\t\tm_prop = prop;\n"
-				"\t\t\tm_type = prop->GetType();\n"
-				"\t\t\tm_addoffset = addoffset;\n"
-				"\t\t}\n"
+				"#if defined(_MSC_VER)\n"
+				"#define DVALVEGEN_FORCEINLINE __forceinline\n"
+				"#else\n"
+				"#define DVALVEGEN_FORCEINLINE inline __attribute__((always_inline))\n"
+				"#endif\n"
 				"\n"
-				"\t\tRecvProp* prop() {\n"
-				"\t\t\treturn m_prop;\n"
-				"\t\t}\n"
+				"\t// Accessors go through byte pointers, never through an integer, so they are 64-bit clean\n"
+				"\t// and the compiler keeps track of which object a field belongs to\n"
+				"\ttemplate<typename T>\n"
+				"\tinline T* field(void* self, std::ptrdiff_t offset) {\n"
+				"\t\treturn reinterpret_cast<T*>(static_cast<std::byte*>(self) + offset);\n"
+				"\t}\n"
 				"\n"
-				"\t\tstd::string getFormattedName() {\n"
-				"\t\t\tif (m_fname == \"\") {\n"
-				"\t\t\t\tm_fname = m_prop->GetName();\n"
+				"\t// Copy of a field, no alignment or aliasing requirements on the object\n"
+				"\ttemplate<typename T>\n"
+				"\tDVALVEGEN_FORCEINLINE T load(const void* self, std::ptrdiff_t offset) {\n"
+				"\t\tT value;\n"
+				"\t\tstd::memcpy(&value, static_cast<const std::byte*>(self) + offset, sizeof(T));\n"
+				"\t\treturn value;\n"
+				"\t}\n"
 				"\n"
-				"\t\t\t\twhile (true) {\n"
-				"\t\t\t\t\tint p = m_fname.find(\"[\");\n"
-				"\t\t\t\t\tif (p != std::string::npos) {\n"
-				"\t\t\t\t\t\tm_fname[p] = '_';\n"
-				"\t\t\t\t\t}\n"
-				"\t\t\t\t\telse {\n"
-				"\t\t\t\t\t\tbreak;\n"
-				"\t\t\t\t\t}\n"
-				"\t\t\t\t}\n"
+				"\t// Component-wise, gcc keeps a 12 byte memcpy on the stack and stops hoisting the offset loads around it\n"
+				"\ttemplate<>\n"
+				"\tDVALVEGEN_FORCEINLINE Vector load<Vector>(const void* self, std::ptrdiff_t offset) {\n"
+				"\t\treturn { load<float>(self, offset), load<float>(self, offset + 4), load<float>(self, offset + 8) };\n"
+				"\t}\n"
 				"\n"
-				"\t\t\t\twhile (true) {\n"
-				"\t\t\t\t\tint p = m_fname.find(\"]\");\n"
-				"\t\t\t\t\tif (p != std::string::npos) {\n"
-				"\t\t\t\t\t\tm_fname.erase(m_fname.begin() + p);\n"
-				"\t\t\t\t\t}\n"
-				"\t\t\t\t\telse {\n"
-				"\t\t\t\t\t\tbreak;\n"
-				"\t\t\t\t\t}\n"
-				"\t\t\t\t}\n"
+				"\ttemplate<>\n"
+				"\tDVALVEGEN_FORCEINLINE Vector2D load<Vector2D>(const void* self, std::ptrdiff_t offset) {\n"
+				"\t\treturn { load<float>(self, offset), load<float>(self, offset + 4) };\n"
+				"\t}\n"
 				"\n"
-				"\t\t\t\twhile (true) {\n"
-				"\t\t\t\t\tint p = m_fname.find(\".\");\n"
-				"\t\t\t\t\tif (p != std::string::npos) {\n"
-				"\t\t\t\t\t\tm_fname[p] = '_';\n"
-				"\t\t\t\t\t}\n"
-				"\t\t\t\t\telse {\n"
-				"\t\t\t\t\t\tbreak;\n"
-				"\t\t\t\t\t}\n"
-				"\t\t\t\t}\n"
+				"\t// Relaxed atomic read of a 4 or 8 byte field, for fields the game thread writes while we read them\n"
+				"\ttemplate<typename T>\n"
+				"\tDVALVEGEN_FORCEINLINE T relaxedLoad(const T* p) {\n"
+				"\t\tstatic_assert(sizeof(T) == 4 || sizeof(T) == 8, \"Only 4 and 8 byte fields can be read atomically\");\n"
+				"\t\tT value;\n"
+				"#if defined(_MSC_VER)\n"
+				"\t\tif constexpr (sizeof(T) == 4) {\n"
+				"\t\t\t__int32 raw = __iso_volatile_load32((const volatile __int32*)p);\n"
+				"\t\t\tstd::memcpy(&value, &raw, sizeof(T));\n"
+				"\t\t}\n"
+				"\t\telse {\n"
+				"\t\t\t__int64 raw = __iso_volatile_load64((const volatile __int64*)p);\n"
+				"\t\t\tstd::memcpy(&value, &raw, sizeof(T));\n"
+				"\t\t}\n"
+				"#else\n"
+				"\t\t__atomic_load(p, &value, __ATOMIC_RELAXED);\n"
+				"#endif\n"
+				"\t\treturn value;\n"
+				"\t}\n"
 				"\n"
-				"\t\t\t\twhile (true) {\n"
-				"\t\t\t\t\tint p = m_fname.find(\"\\\"\");\n"
-				"\t\t\t\t\tif (p != std::string::npos) {\n"
-				"\t\t\t\t\t\tm_fname.erase(m_fname.begin() + p);\n"
-				"\t\t\t\t\t}\n"
-				"\t\t\t\t\telse {\n"
-				"\t\t\t\t\t\tbreak;\n"
-				"\t\t\t\t\t}\n"
-				"\t\t\t\t}\n"
+				"\t// Each component is atomic on its own, the vector as a whole can still tear\n"
+				"\tDVALVEGEN_FORCEINLINE Vector relaxedLoad(const Vector* p) {\n"
+				"\t\treturn { relaxedLoad(&p->x), relaxedLoad(&p->y), relaxedLoad(&p->z) };\n"
+				"\t}\n"
 				"\n"
-				"\t\t\t\tif (m_fname[0] >= '0' && m_fname[0] <= '9') {\n"
-				"\t\t\t\t\tm_fname = \"_\" + m_fname;\n"
-				"\t\t\t\t}\n"
-				"\t\t\t}\n"
+				"\tDVALVEGEN_FORCEINLINE Vector2D relaxedLoad(const Vector2D* p) {\n"
+				"\t\treturn { relaxedLoad(&p->x), relaxedLoad(&p->y) };\n"
+				"\t}\n"
 				"\n"
-				"\t\t\treturn m_fname;\n"
-				"\t\t}\n"
+				"\t// Access policies, picked per call site, e.g. player->m_iHealth<dvalvegen::Value>()\n"
+				"\t// Accessors without one use DVALVEGEN_DEFAULT_ACCESS, dvalvegen::Pointer unless defined otherwise\n"
+				"\tstruct Pointer {\n"
+				"\t\ttemplate<typename T>\n"
+				"\t\tusing Result = T*;\n"
 				"\n"
-				"\tprivate:\n"
-				"\t\tSendPropType m_type;\n"
-				"\t\tstd::string m_fname = \"\";\n"
-				"\t\tuint m_addoffset;\n"
-				"\t\tRecvProp* m_prop;\n"
+				"\t\ttemplate<typename T>\n"
+				"\t\tstatic DVALVEGEN_FORCEINLINE T* get(void* self, std::ptrdiff_t offset) {\n"
+				"\t\t\treturn field<T>(self, offset);\n"
+				"\t\t}\n"
 				"\t};\n"
 				"\n"
-				"\tclass Class {\n"
-				"\tpublic:\n"
-				"\t\tClass(RecvTable* table) {\n"
-				"\t\t\tm_table = table;\n"
+				"\tstruct Reference {\n"
+				"\t\ttemplate<typename T>\n"
+				"\t\tusing Result = T&;\n"
+				"\n"
+				"\t\ttemplate<typename T>\n"
+				"\t\tstatic DVALVEGEN_FORCEINLINE T& get(void* self, std::ptrdiff_t offset) {\n"
+				"\t\t\treturn *field<T>(self, offset);\n"
 				"\t\t}\n"
+				"\t};\n"
 				"\n"
-				"\t\tClass() {\n"
+				"\tstruct Value {\n"
+				"\t\ttemplate<typename T>\n"
+				"\t\tusing Result = T;\n"
 				"\n"
+				"\t\ttemplate<typename T>\n"
+				"\t\tstatic DVALVEGEN_FORCEINLINE T get(void* self, std::ptrdiff_t offset) {\n"
+				"\t\t\treturn load<T>(self, offset);\n"
 				"\t\t}\n"
+				"\t};\n"
 				"\n"
-				"\t\tvoid addBaseclass(std::string baseclass) {\n"
-				"\t\t\tfor (auto& it : m_baseclasses) {\n"
-				"\t\t\t\tif (it == baseclass) {\n"
-				"\t\t\t\t\treturn;\n"
-				"\t\t\t\t}\n"
-				"\t\t\t}\n"
+				"\tstruct Relaxed {\n"
+				"\t\ttemplate<typename T>\n"
+				"\t\tusing Result = T;\n"
 				"\n"
-				"\t\t\tm_baseclasses.push_back(baseclass);\n"
+				"\t\ttemplate<typename T>\n"
+				"\t\tstatic DVALVEGEN_FORCEINLINE T get(void* self, std::ptrdiff_t offset) {\n"
+				"\t\t\treturn relaxedLoad(field<T>(self, offset));\n"
 				"\t\t}\n"
+				"\t};\n"
 				"\n"
-				"\t\tvoid addProp(RecvProp* prop, uint addoffset = 0) {\n"
-				"\t\t\tClassProp cp{ prop, addoffset };\n"
-				"\t\t\tm_props.emplace(cp.getFormattedName(), cp);\n"
-				"\t\t}\n"
+				"#ifndef DVALVEGEN_DEFAULT_ACCESS\n"
+				"#define DVALVEGEN_DEFAULT_ACCESS dvalvegen::Pointer\n"
+				"#endif\n"
 				"\n"
-				"\t\tstd::unordered_map<std::string, ClassProp>& props() {\n"
-				"\t\t\treturn m_props;\n"
-				"\t\t}\n"
-				"\n"
-				"\t\tstd::string getName() {\n"
-				"\t\t\treturn m_table->GetName();\n"
-				"\t\t}\n"
+				"\tusing DefaultAccess = DVALVEGEN_DEFAULT_ACCESS;\n"
 				"\n"
-				"\tprivate:\n"
-				"\t\tstd::vector<std::string> m_baseclasses;\n"
-				"\t\tstd::unordered_map<std::string, ClassProp> m_props;\n"
-				"\t\tRecvTable* m_table = nullptr;\n"
+				"\t// Compile-time description of a generated field, ClassFields<C>::All lists every field of C including its base classes'\n"
+				"\t// size is one element, stride the distance between elements and count their number when the SDK was generated (g_ArraySizes has the live one)\n"
+				"\t// Nested classes have a size of 0, strings the size of their buffer\n"
+				"\tstruct FieldDesc {\n"
+				"\t\tconst char* name = nullptr;\n"
+				"\t\tunsigned int id = 0;\n"
+				"\t\tSendPropType type = DPT_Int;\n"
+				"\t\tunsigned int size = 0;\n"
+				"\t\tunsigned int stride = 0;\n"
+				"\t\tunsigned int count = 0;\n"
 				"\t};\n"
 				"\n"
-				"\tvoid createClass(RecvTable* table, Class* parent = nullptr);\n"
+				"\t// Specialized after every generated class: Declared are its own fields, All the base classes' followed by those\n"
+				"\ttemplate<typename C>\n"
+				"\tstruct ClassFields;\n"
+				"\n"
+				"\ttemplate<std::size_t... N>\n"
+				"\tconstexpr std::array<FieldDesc, (N + ... + 0)> joinFields(const std::array<FieldDesc, N>&... parts) {\n"
+				"\t\tstd::array<FieldDesc, (N + ... + 0)> r{};\n"
+				"\t\tstd::size_t i = 0;\n"
+				"\t\tauto append = [&r, &i](const auto& part) {\n"
+				"\t\t\tfor (std::size_t j = 0; j < part.size(); j++) {\n"
+				"\t\t\t\tr[i++] = part[j];\n"
+				"\t\t\t}\n"
+				"\t\t};\n"
+				"\n"
+				"\t\t(append(parts), ...);\n"
+				"\t\treturn r;\n"
+				"\t}\n"
+				"\n"
+				"\t// Calls visitor(const FieldDesc&, field) for every field of C in the order of ClassFields<C>::All, field is what the\n"
+				"\t// accessor returns as dvalvegen::Pointer. It unrolls into the accessor calls, no lookups by name or ID at runtime\n"
+				"\t// Fields the current build doesn't have are visited as well, check hasField(desc.id) where that matters\n"
+				"\ttemplate<typename C, typename V>\n"
+				"\tDVALVEGEN_FORCEINLINE void forEachField(C* self, V&& visitor) {\n"
+				"\t\tClassFields<C>::visit(self, visitor);\n"
+				"\t}\n"
+				"\n"
+				"\t// Resolves only the fields the SDK was generated with, walking each needed table once\n"
+				"\tvoid createClasses(void* clientclass);\n"
+				"\tunsigned int getUnresolvedCount();\n"
+				"\n"
+				"\t// Name based lookups, linear and only there for code that doesn't know field IDs\n"
 				"\tint getOffset(std::string base, std::string prop);\n"
 				"\tint getDTArraySize(std::string base, std::string prop);\n"
-				"\tvoid createClasses(void* clientclass);\n"
+				"\tint findField(std::string base, std::string prop);\n"
+				"\n"
+				"\t// False for fields the current build doesn't have, their accessors point at the start of the object\n"
+				"\tbool hasField(unsigned int id);\n"
+				"\n"
+				"#ifdef DVALVEGEN_PROFILE\n"
+				"\t// Every accessor counts its calls, in a block of counters per thread\n"
+				"\tstd::atomic<unsigned long long>* registerProfileThread();\n"
+				"\n"
+				"\tinline void countAccess(unsigned int id) {\n"
+				"\t\tthread_local std::atomic<unsigned long long>* counters = registerProfileThread();\n"
+				"\n"
+				"\t\t// Only this thread writes its block, so there's no need for a locked add\n"
+				"\t\tstd::atomic<unsigned long long>& c = counters[id];\n"
+				"\t\tc.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);\n"
+				"\t}\n"
+				"\n"
+				"\tunsigned long long getAccessCount(unsigned int id);\n"
+				"\tstd::string profileReport();\n"
+				"\tvoid resetProfile();\n"
+				"\n"
+				"#define DVALVEGEN_COUNT(id) dvalvegen::countAccess(id)\n"
+				"#else\n"
+				"#define DVALVEGEN_COUNT(id)\n"
+				"#endif\n"
+				"\n"
+				"\t// Which of the versions the SDK was generated from matched, -1 if none did and offsets were resolved at runtime\n"
+				"\tint getVersion();\n"
+				"\tconst char* getVersionName();\n"
+				"\n"
+				"\tunsigned long long graphFingerprint(void* clientclass);\n"
+				"\n"
+				"\tenum CacheState {\n"
+				"\t\tCacheNone,\n"
+				"\t\tCacheLoaded,\t\t// Offsets came from the cache, full check still running\n"
+				"\t\tCacheVerified,\n"
+				"\t\tCacheStale\t\t// The cache didn't match, offsets have been resolved again and wait for refreshOffsets()\n"
+				"\t};\n"
+				"\n"
+				"\t// cachepath is optional, with it a matching cache from an earlier run replaces walking the class graph\n"
+				"\tbool initialize(void* clientclass, const char* cachepath = nullptr);\n"
+				"\tCacheState getCacheState();\n"
+				"\t// Takes the offsets the cache check resolved again after CacheStale, call it from the thread that uses the accessors\n"
+				"\t// Until then the ones from the cache stay in use, the check never writes the tables itself\n"
+				"\tbool refreshOffsets();\n"
+				"\n"
+				"\t// Shares the resolved offsets, the class ID map and the graph fingerprint with other local processes\n"
+				"\t// The process that called initialize() publishes, the others attach and never walk the graph themselves\n"
+				"\t// name is e.g. \"/dvalvegen\" (POSIX shared memory) or \"Local\\\\dvalvegen\" (Windows)\n"
+				"\tbool publishShared(const char* name);\n"
+				"\tbool attachShared(const char* name);\n"
+				"\t// Copies the table again if it was republished since, call it from the thread that uses the accessors\n"
+				"\tbool refreshShared();\n"
+				"\tvoid closeShared();\n"
+				"\t// POSIX only, shared memory outlives its processes until removed\n"
+				"\tvoid removeShared(const char* name);\n"
+				"\tint getSharedClassId(const char* networkname);\n"
+				"\tunsigned long long getSharedFingerprint();\n"
+				"\t// Fingerprint of the graph the offsets were baked from, 0 if they weren't\n";
+			oh << "\tconstexpr unsigned long long BakedFingerprint = 0x" << std::hex << (bake && g_ClientClasses ? graphFingerprint(g_ClientClasses) : 0) << std::dec << "ull;\n";
+			oh <<
+				"\n"
+				"#ifdef DVALVEGEN_TRUST_BAKED\n"
+				"\t// Skips the check in initialize(), only safe if you know the build never changes\n"
+				"\tconstexpr bool g_Baked = true;\n"
+				"#else\n"
+				"\textern bool g_Baked;\n"
+				"#endif\n"
 				"}";
-			oh.close();
+			emitFile("dvalvegen.h", oh.str());
 
-			std::ofstream ocpp{ dirpath + "dvalvegen.cpp" };
+			memory::OStream<memory::Output> ocpp;
 			ocpp <<
 				"#include \"dvalvegen.h\"\n"
 				"\n"
+				"#include <cstdio>\n"
+				"#include <cstring>\n"
+				"#include <cstdint>\n"
+				"#include <atomic>\n"
+				"#include <thread>\n"
+				"#include <mutex>\n"
+				"#include <memory>\n"
+				"#include <new>\n"
+				"#include <algorithm>\n"
+				"#include <vector>\n"
+				"#include <unordered_map>\n"
+				"#include <unordered_set>\n"
+				"\n"
+				"#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)\n"
+				"#define DVALVEGEN_SSE2\n"
+				"#include <emmintrin.h>\n"
+				"#endif\n"
+				"\n"
+				"#ifdef _WIN32\n"
+				"#define WIN32_LEAN_AND_MEAN\n"
+				"#define NOMINMAX\n"
+				"#include <windows.h>\n"
+				"#else\n"
+				"#include <fcntl.h>\n"
+				"#include <unistd.h>\n"
+				"#include <sys/mman.h>\n"
+				"#include <sys/stat.h>\n"
+				"#endif\n"
+				"\n"
 				"namespace dvalvegen {\n"
-				"\tstd::unordered_map<std::string, Class> g_Classes;\n"
+				"\tstruct FieldInfo {\n"
+				"\t\tconst char* table;\n"
+				"\t\tconst char* prop;\t\t// Name in the recv table\n"
+				"\t\tconst char* name;\t\t// Name of the accessor\n"
+				"\t\tint index;\t\t\t\t// Where the prop was in its table when the SDK was generated\n"
+				"\t};\n"
+				"\n"
+				"\tstruct TableInfo {\n"
+				"\t\tconst char* name;\n"
+				"\t\tunsigned int first;\t\t// Range in TableFields\n"
+				"\t\tunsigned int count;\n"
+				"\t};\n"
+				"\n";
+
+			// Fields in ID order, plus their IDs grouped by table so the resolver can go table by table
+			std::map<std::string, std::vector<uint>> tablefields;
+			for (auto p : g_Fields) {
+				tablefields[p->parent()->getName()].push_back(p->id());
+			}
+
+			// The tables grow with the number of fields, they go out in pieces instead of all at once
+			auto flush_cpp = [&emitFile, &ocpp]() {
+				if (ocpp.tellp() >= SdkPieceSize) {
+					emitFile("dvalvegen.cpp", ocpp.str());
+					ocpp.str("");
+				}
+			};
+
+			ocpp << "\tstatic const FieldInfo Fields[] = {\n";
+			for (auto p : g_Fields) {
+				RecvTable* table = p->parent()->table();
+				ocpp << "\t\t{ \"" << table->GetName() << "\", \"" << p->prop()->GetName() << "\", \"" << p->getFormattedName() << "\", " << propIndex(table, p->prop()) << " },\n";
+				flush_cpp();
+			}
+			if (g_Fields.empty()) {
+				ocpp << "\t\t{ \"\", \"\", \"\", 0 },\n";
+			}
+			ocpp << "\t};\n\n";
+
+			ocpp << "\tstatic const unsigned int TableFields[] = {";
+			uint n = 0;
+			for (auto& t : tablefields) {
+				for (uint id : t.second) {
+					ocpp << (n++ % 16 == 0 ? "\n\t\t" : " ") << id << ",";
+				}
+				flush_cpp();
+			}
+			if (n == 0) {
+				ocpp << "\n\t\t0,";
+			}
+			ocpp << "\n\t};\n\n";
+
+			// Sorted by name for the binary search in findTable
+			ocpp << "\tstatic const TableInfo Tables[] = {\n";
+			n = 0;
+			for (auto& t : tablefields) {
+				ocpp << "\t\t{ \"" << t.first << "\", " << n << ", " << t.second.size() << " },\n";
+				n += (uint)t.second.size();
+			}
+			if (tablefields.empty()) {
+				ocpp << "\t\t{ \"\", 0, 0 },\n";
+			}
+			ocpp << "\t};\n\n";
+			ocpp << "\tstatic const unsigned int TableCount = " << tablefields.size() << ";\n\n";
+
+			// One row per version merged with addVersion, picked by fingerprint in initialize()
+			std::vector<std::vector<int>> voffsets(g_Versions.size());
+			std::vector<std::vector<int>> vsizes(g_Versions.size());
+			std::vector<std::vector<char>> vpresent(g_Versions.size());
+
+			for (uint v = 0; v < g_Versions.size(); v++) {
+				resolveVersion(g_Versions[v].head, voffsets[v], vsizes[v], vpresent[v]);
+			}
+
+			auto write_rows = [&ocpp, &flush_cpp](const char* decl, auto& rows) {
+				ocpp << "\tstatic const " << decl << "[][FieldCount ? FieldCount : 1] = {\n";
+				for (auto& row : rows) {
+					ocpp << "\t\t{";
+					for (uint i = 0; i < row.size(); i++) {
+						ocpp << (i % 16 == 0 ? "\n\t\t\t" : " ") << (int)row[i] << ",";
+						if (i % 16 == 15) {
+							flush_cpp();
+						}
+					}
+					ocpp << "\n\t\t},\n";
+				}
+				if (rows.empty()) {
+					ocpp << "\t\t{ 0 },\n";
+				}
+				ocpp << "\t};\n\n";
+			};
+
+			ocpp << "\tstatic const unsigned int VersionCount = " << g_Versions.size() << ";\n\n";
+
+			ocpp << "\tstatic const char* const VersionNames[] = {\n";
+			for (auto& v : g_Versions) {
+				ocpp << "\t\t\"" << v.name << "\",\n";
+			}
+			if (g_Versions.empty()) {
+				ocpp << "\t\t\"\",\n";
+			}
+			ocpp << "\t};\n\n";
+
+			ocpp << "\tstatic const unsigned long long VersionFingerprints[] = {\n";
+			for (auto& v : g_Versions) {
+				ocpp << "\t\t0x" << std::hex << graphFingerprint(v.head) << std::dec << "ull,\n";
+			}
+			if (g_Versions.empty()) {
+				ocpp << "\t\t0,\n";
+			}
+			ocpp << "\t};\n\n";
+
+			write_rows("std::int32_t VersionOffsets", voffsets);
+			write_rows("std::int32_t VersionArraySizes", vsizes);
+			write_rows("unsigned char VersionPresent", vpresent);
+
+			// What the accessors have baked in, so the tables hold the same values when the baked path is taken
+			std::vector<std::vector<int>> boffsets(bake ? 1 : 0);
+			std::vector<std::vector<int>> bsizes(bake ? 1 : 0);
+			std::vector<std::vector<char>> bpresent(bake ? 1 : 0);
+
+			if (bake) {
+				resolveVersion(g_ClientClasses, boffsets[0], bsizes[0], bpresent[0]);
+			}
+
+			write_rows("std::int32_t BakedOffsets", boffsets);
+			write_rows("std::int32_t BakedArraySizes", bsizes);
+			write_rows("unsigned char BakedPresent", bpresent);
+
+			ocpp <<
 				"\n"
-				"\tvoid createClass(RecvTable* table, Class* parent) {\n"
-				"\t\tstd::string tablename = table->GetName();\n"
+				"\tstd::int32_t g_Offsets[FieldCount];\n"
+				"\tstd::int32_t g_ArraySizes[FieldCount];\n"
+				"\tstatic unsigned char g_Present[FieldCount];\n"
+				"\tstatic int g_Version = -1;\n"
 				"\n"
-				"\t\tif (table->GetNumProps() > 0) {\n"
-				"\t\t\tif (table->GetProp(0)->GetName()[0] >= '0' && table->GetProp(0)->GetName()[0] <= '9') {\n"
-				"\t\t\t\tif (table->GetProp(0)->GetType() == DPT_DataTable) {\n"
-				"\t\t\t\t\tcreateClass(table->GetProp(0)->GetDataTable());\n"
-				"\t\t\t\t}\n"
-				"\t\t\t\treturn;\n"
+				"#ifndef DVALVEGEN_TRUST_BAKED\n"
+				"\tbool g_Baked = false;\n"
+				"#endif\n"
+				"\n"
+				"\tstatic ClientClass* g_ClientClasses = nullptr;\n"
+				"\tstatic unsigned int g_Unresolved = FieldCount;\n"
+				"\n"
+				"\tstatic const TableInfo* findTable(const char* name) {\n"
+				"\t\tunsigned int lo = 0;\n"
+				"\t\tunsigned int hi = TableCount;\n"
+				"\n"
+				"\t\twhile (lo < hi) {\n"
+				"\t\t\tunsigned int mid = (lo + hi) / 2;\n"
+				"\t\t\tint c = std::strcmp(Tables[mid].name, name);\n"
+				"\n"
+				"\t\t\tif (c == 0) {\n"
+				"\t\t\t\treturn &Tables[mid];\n"
 				"\t\t\t}\n"
-				"\t\t}\n"
 				"\n"
-				"\t\tif (g_Classes.count(table->GetName()) == 0) {\n"
-				"\t\t\tg_Classes.try_emplace(tablename, Class{ table });\n"
+				"\t\t\tif (c < 0) {\n"
+				"\t\t\t\tlo = mid + 1;\n"
+				"\t\t\t}\n"
+				"\t\t\telse {\n"
+				"\t\t\t\thi = mid;\n"
+				"\t\t\t}\n"
 				"\t\t}\n"
-				"\t\telse {\n"
+				"\n"
+				"\t\treturn nullptr;\n"
+				"\t}\n"
+				"\n"
+				"\tstruct OffsetTable {\n"
+				"\t\tstd::int32_t offsets[FieldCount];\n"
+				"\t\tstd::int32_t sizes[FieldCount];\n"
+				"\t\tunsigned char present[FieldCount];\n"
+				"\t\tunsigned int unresolved;\n"
+				"\t};\n"
+				"\n"
+				"\tstatic void resolveTable(RecvTable* table, OffsetTable& out, std::unordered_set<RecvTable*>& visited) {\n"
+				"\t\tif (!table || !visited.insert(table).second) {\n"
 				"\t\t\treturn;\n"
 				"\t\t}\n"
 				"\n"
-				"\t\tClass* ctx = &g_Classes[tablename];\n"
-				"\n"
-				"\t\tfor (int i = 0; i < table->GetNumProps(); i++) {\n"
-				"\t\t\tRecvProp* prop = table->GetProp(i);\n"
+				"\t\tconst TableInfo* info = table->m_pNetTableName ? findTable(table->m_pNetTableName) : nullptr;\n"
 				"\n"
-				"\t\t\tif (prop->GetName() == \"baseclass\") {\n"
-				"\t\t\t\tctx->addBaseclass(prop->GetDataTable()->GetName());\n"
-				"\t\t\t\tcreateClass(prop->GetDataTable());\n"
-				"\t\t\t}\n"
-				"\t\t\telse {\n"
-				"\t\t\t\tSendPropType propt = prop->GetType();\n"
+				"\t\tif (info) {\n"
+				"\t\t\tfor (unsigned int i = 0; i < info->count; i++) {\n"
+				"\t\t\t\tunsigned int id = TableFields[info->first + i];\n"
+				"\t\t\t\tconst FieldInfo& field = Fields[id];\n"
+				"\t\t\t\tRecvProp* prop = nullptr;\n"
 				"\n"
-				"\t\t\t\tif (propt == DPT_Array || propt == DPT_NUMSendPropTypes) {\n"
-				"\t\t\t\t\tcontinue;\n"
+				"\t\t\t\t// Props rarely move within a table, so the index from generation time is checked first\n"
+				"\t\t\t\tif (field.index < table->m_nProps && table->m_pProps[field.index].m_pVarName && std::strcmp(table->m_pProps[field.index].m_pVarName, field.prop) == 0) {\n"
+				"\t\t\t\t\tprop = &table->m_pProps[field.index];\n"
 				"\t\t\t\t}\n"
-				"\n"
-				"\t\t\t\tif (propt == DPT_DataTable) {\n"
-				"\t\t\t\t\tif (prop->GetDataTable()->GetNumProps() > 0) {\n"
-				"\t\t\t\t\t\tif (prop->GetName() == prop->GetDataTable()->GetName()) {\n"
-				"\t\t\t\t\t\t\tif (prop->GetDataTable()->GetProp(0)->GetType() != DPT_Array && prop->GetDataTable()->GetProp(0)->GetType() != DPT_NUMSendPropTypes) {\n"
-				"\t\t\t\t\t\t\t\tctx->addProp(prop);\n"
-				"\t\t\t\t\t\t\t}\n"
-				"\t\t\t\t\t\t\tcontinue;\n"
-				"\t\t\t\t\t\t}\n"
-				"\t\t\t\t\t\telse {\n"
-				"\t\t\t\t\t\t\tcreateClass(prop->GetDataTable());\n"
+				"\t\t\t\telse {\n"
+				"\t\t\t\t\tfor (int j = 0; j < table->m_nProps; j++) {\n"
+				"\t\t\t\t\t\tif (table->m_pProps[j].m_pVarName && std::strcmp(table->m_pProps[j].m_pVarName, field.prop) == 0) {\n"
+				"\t\t\t\t\t\t\tprop = &table->m_pProps[j];\n"
+				"\t\t\t\t\t\t\tbreak;\n"
 				"\t\t\t\t\t\t}\n"
 				"\t\t\t\t\t}\n"
 				"\t\t\t\t}\n"
 				"\n"
-				"\t\t\t\tctx->addProp(prop);\n"
+				"\t\t\t\tif (prop) {\n"
+				"\t\t\t\t\tout.offsets[id] = prop->GetOffset();\n"
+				"\t\t\t\t\tout.sizes[id] = prop->GetDataTable() ? prop->GetDataTable()->m_nProps : 0;\n"
+				"\t\t\t\t\tout.present[id] = 1;\n"
+				"\t\t\t\t\tout.unresolved--;\n"
+				"\t\t\t\t}\n"
+				"\t\t\t}\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tfor (int i = 0; i < table->m_nProps; i++) {\n"
+				"\t\t\tif (table->m_pProps[i].GetDataTable()) {\n"
+				"\t\t\t\tresolveTable(table->m_pProps[i].GetDataTable(), out, visited);\n"
 				"\t\t\t}\n"
 				"\t\t}\n"
 				"\t}\n"
 				"\n"
+				"\tstatic std::unique_ptr<OffsetTable> resolveOffsets(ClientClass* head) {\n"
+				"\t\t/// Into a table of its own, the live one is only ever overwritten as a whole\n"
+				"\t\tstd::unique_ptr<OffsetTable> table{ new OffsetTable{} };\n"
+				"\t\tstd::unordered_set<RecvTable*> visited;\n"
+				"\t\ttable->unresolved = FieldCount;\n"
+				"\n"
+				"\t\tfor (ClientClass* cclass = head; cclass; cclass = cclass->m_pNext) {\n"
+				"\t\t\tresolveTable(cclass->m_pRecvTable, *table, visited);\n"
+				"\t\t}\n"
+				"\n"
+				"\t\treturn table;\n"
+				"\t}\n"
+				"\n"
+				"\tstatic void useOffsets(const std::int32_t* offsets, const std::int32_t* sizes, const unsigned char* present) {\n"
+				"\t\t// Resolved ones or those known at generation time, baked or one of the versions\n"
+				"\t\tstd::memcpy(g_Offsets, offsets, sizeof(g_Offsets));\n"
+				"\t\tstd::memcpy(g_ArraySizes, sizes, sizeof(g_ArraySizes));\n"
+				"\t\tstd::memcpy(g_Present, present, sizeof(g_Present));\n"
+				"\n"
+				"\t\tg_Unresolved = 0;\n"
+				"\t\tfor (unsigned int i = 0; i < FieldCount; i++) {\n"
+				"\t\t\tg_Unresolved += !g_Present[i];\n"
+				"\t\t}\n"
+				"\t}\n"
+				"\n"
+				"\tvoid createClasses(void* clientclass) {\n"
+				"\t\tstd::unique_ptr<OffsetTable> table = resolveOffsets((ClientClass*)clientclass);\n"
+				"\t\tuseOffsets(table->offsets, table->sizes, table->present);\n"
+				"\t}\n"
+				"\n"
+				"\tunsigned int getUnresolvedCount() {\n"
+				"\t\treturn g_Unresolved;\n"
+				"\t}\n"
+				"\n"
 				"\tint getOffset(std::string base, std::string prop) {\n"
-				"\t\treturn g_Classes.at(base).props().at(prop).prop()->GetOffset();\n"
+				"\t\tfor (unsigned int i = 0; i < FieldCount; i++) {\n"
+				"\t\t\tif (base == Fields[i].table && prop == Fields[i].name) {\n"
+				"\t\t\t\treturn g_Offsets[i];\n"
+				"\t\t\t}\n"
+				"\t\t}\n"
+				"\n"
+				"\t\treturn 0;\n"
+				"\t}\n"
+				"\n"
+				"\tint findField(std::string base, std::string prop) {\n"
+				"\t\tfor (unsigned int i = 0; i < FieldCount; i++) {\n"
+				"\t\t\tif (base == Fields[i].table && prop == Fields[i].name) {\n"
+				"\t\t\t\treturn (int)i;\n"
+				"\t\t\t}\n"
+				"\t\t}\n"
+				"\n"
+				"\t\treturn -1;\n"
+				"\t}\n"
+				"\n"
+				"\tbool hasField(unsigned int id) {\n"
+				"\t\treturn id < FieldCount && (g_Baked || g_Present[id]);\n"
+				"\t}\n"
+				"\n"
+				"\tint getVersion() {\n"
+				"\t\treturn g_Version;\n"
+				"\t}\n"
+				"\n"
+				"\tconst char* getVersionName() {\n"
+				"\t\treturn g_Version >= 0 ? VersionNames[g_Version] : nullptr;\n"
 				"\t}\n"
 				"\n"
 				"\tint getDTArraySize(std::string base, std::string prop) {\n"
-				"\t\treturn g_Classes.at(base).props().at(prop).prop()->GetDataTable()->GetNumProps();\n"
+				"\t\tfor (unsigned int i = 0; i < FieldCount; i++) {\n"
+				"\t\t\tif (base == Fields[i].table && prop == Fields[i].name) {\n"
+				"\t\t\t\treturn g_ArraySizes[i];\n"
+				"\t\t\t}\n"
+				"\t\t}\n"
+				"\n"
+				"\t\treturn 0;\n"
 				"\t}\n"
 				"\n"
-				"\tvoid createClasses(void* clientclass) {\n"
-				"\t\tClientClass* cclass = (ClientClass*)clientclass;\n"
-				"\t\twhile (cclass) {\n"
+				"\tstatic unsigned long long fingerprintMix(unsigned long long h, unsigned long long v) {\n"
+				"\t\th ^= v + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);\n"
+				"\t\th *= 0xFF51AFD7ED558CCDull;\n"
+				"\t\treturn h ^ (h >> 32);\n"
+				"\t}\n"
+				"\n"
+				"\tstatic unsigned long long fingerprintString(unsigned long long h, const char* s) {\n"
+				"\t\tif (!s) {\n"
+				"\t\t\treturn fingerprintMix(h, 0);\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tunsigned long long fnv = 14695981039346656037ull;\n"
+				"\t\tfor (; *s; s++) {\n"
+				"\t\t\tfnv = (fnv ^ (unsigned char)*s) * 1099511628211ull;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\treturn fingerprintMix(h, fnv);\n"
+				"\t}\n"
+				"\n"
+				"\tstatic unsigned long long fingerprintTable(RecvTable* table, std::unordered_map<RecvTable*, unsigned long long>& memo) {\n"
+				"\t\tauto it = memo.find(table);\n"
+				"\t\tif (it != memo.end()) {\n"
+				"\t\t\treturn it->second;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tunsigned long long h = fingerprintString(0, table->m_pNetTableName);\n"
+				"\t\th = fingerprintMix(h, (unsigned long long)table->m_nProps);\n"
+				"\n"
+				"\t\tfor (int i = 0; i < table->m_nProps; i++) {\n"
+				"\t\t\tRecvProp* prop = &table->m_pProps[i];\n"
+				"\n"
+				"\t\t\th = fingerprintString(h, prop->m_pVarName);\n"
+				"\t\t\th = fingerprintMix(h, (unsigned long long)prop->GetType());\n"
+				"\t\t\th = fingerprintMix(h, (unsigned long long)(unsigned int)prop->GetOffset());\n"
+				"\t\t\th = fingerprintMix(h, (unsigned long long)(unsigned int)prop->GetNumElements());\n"
+				"\n"
+				"\t\t\tif (prop->GetDataTable()) {\n"
+				"\t\t\t\th = fingerprintMix(h, fingerprintTable(prop->GetDataTable(), memo));\n"
+				"\t\t\t}\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tmemo[table] = h;\n"
+				"\t\treturn h;\n"
+				"\t}\n"
+				"\n"
+				"\tunsigned long long graphFingerprint(void* clientclass) {\n"
+				"\t\tstd::unordered_map<RecvTable*, unsigned long long> memo;\n"
+				"\t\tunsigned long long h = 0;\n"
+				"\n"
+				"\t\tfor (ClientClass* cclass = (ClientClass*)clientclass; cclass; cclass = cclass->m_pNext) {\n"
+				"\t\t\th = fingerprintMix(h, (unsigned long long)(unsigned int)cclass->m_ClassID);\n"
+				"\t\t\th = fingerprintString(h, cclass->m_pNetworkName);\n"
+				"\t\t\th = fingerprintMix(h, cclass->m_pRecvTable ? fingerprintTable(cclass->m_pRecvTable, memo) : 0);\n"
+				"\t\t}\n"
+				"\n"
+				"\t\treturn h;\n"
+				"\t}\n"
+				"\n"
+				"\tstruct CacheHeader {\n"
+				"\t\tchar magic[8];\n"
+				"\t\tunsigned long long quick;\n"
+				"\t\tunsigned long long full;\n"
+				"\t\tunsigned int count;\t\t// Followed by count offsets, count array sizes and count presence flags\n"
+				"\t\tunsigned int unresolved;\n"
+				"\t};\n"
+				"\n"
+				"\tstatic const char CacheMagic[8] = { 'D', 'V', 'G', 'O', 'F', 'C', '3', 0 };\n"
+				"\tstatic std::atomic<int> g_CacheState{ CacheNone };\n"
+				"\tstatic std::atomic<OffsetTable*> g_StaleOffsets{ nullptr };\n"
+				"\n"
+				"\tstatic unsigned long long quickNameHash(const char* s) {\n"
+				"\t\tif (!s) {\n"
+				"\t\t\treturn 0;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tunsigned long long h = 14695981039346656037ull;\n"
+				"\n"
+				"#ifdef DVALVEGEN_SSE2\n"
+				"\t\t// Aligned 16 byte loads never cross a page, so reading around the string is safe\n"
+				"\t\t// Bytes outside of it are zeroed before mixing\n"
+				"\t\tconst char* p = (const char*)((std::uintptr_t)s & ~(std::uintptr_t)15);\n"
+				"\t\tunsigned int skip = (unsigned int)(s - p);\n"
+				"\t\t__m128i zero = _mm_setzero_si128();\n"
+				"\n"
+				"\t\twhile (true) {\n"
+				"\t\t\t__m128i v = _mm_load_si128((const __m128i*)p);\n"
+				"\t\t\tunsigned int z = ((unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)) >> skip) << skip;\n"
+				"\n"
+				"\t\t\tunsigned char chunk[16];\n"
+				"\t\t\t_mm_storeu_si128((__m128i*)chunk, v);\n"
+				"\n"
+				"\t\t\tunsigned int end = 16;\n"
+				"\t\t\tif (z) {\n"
+				"\t\t\t\tfor (end = 0; !(z & (1u << end)); end++);\n"
+				"\t\t\t}\n"
+				"\n"
+				"\t\t\tstd::memset(chunk, 0, skip);\n"
+				"\t\t\tstd::memset(chunk + end, 0, 16 - end);\n"
+				"\n"
+				"\t\t\tunsigned long long lo, hi;\n"
+				"\t\t\tstd::memcpy(&lo, chunk, 8);\n"
+				"\t\t\tstd::memcpy(&hi, chunk + 8, 8);\n"
+				"\t\t\th = fingerprintMix(fingerprintMix(h, lo), hi);\n"
+				"\n"
+				"\t\t\tif (z) {\n"
+				"\t\t\t\tbreak;\n"
+				"\t\t\t}\n"
+				"\n"
+				"\t\t\tp += 16;\n"
+				"\t\t\tskip = 0;\n"
+				"\t\t}\n"
+				"#else\n"
+				"\t\tfor (; *s; s++) {\n"
+				"\t\t\th = (h ^ (unsigned char)*s) * 1099511628211ull;\n"
+				"\t\t}\n"
+				"#endif\n"
+				"\n"
+				"\t\treturn h;\n"
+				"\t}\n"
+				"\n"
+				"\tstatic unsigned long long quickFingerprint(ClientClass* head) {\n"
+				"\t\t// Only looks at the class list and the top level tables, no prop walking\n"
+				"\t\t// Table pointers are taken relative to the first one, so the module moving around doesn't matter\n"
+				"\t\tstd::uintptr_t base = head && head->m_pRecvTable ? (std::uintptr_t)head->m_pRecvTable : 0;\n"
+				"\t\tunsigned long long h = 0;\n"
+				"\t\tunsigned int count = 0;\n"
+				"\n"
+				"\t\tfor (ClientClass* cclass = head; cclass; cclass = cclass->m_pNext) {\n"
+				"\t\t\th = fingerprintMix(h, (unsigned long long)(unsigned int)cclass->m_ClassID);\n"
+				"\t\t\th = fingerprintMix(h, quickNameHash(cclass->m_pNetworkName));\n"
+				"\n"
 				"\t\t\tif (cclass->m_pRecvTable) {\n"
-				"\t\t\t\tcreateClass(cclass->m_pRecvTable);\n"
+				"\t\t\t\th = fingerprintMix(h, (unsigned long long)((std::uintptr_t)cclass->m_pRecvTable - base));\n"
+				"\t\t\t\th = fingerprintMix(h, quickNameHash(cclass->m_pRecvTable->m_pNetTableName));\n"
+				"\t\t\t\th = fingerprintMix(h, (unsigned long long)cclass->m_pRecvTable->m_nProps);\n"
+				"\t\t\t}\n"
+				"\n"
+				"\t\t\tcount++;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\treturn fingerprintMix(h, count);\n"
+				"\t}\n"
+				"\n"
+				"\tstatic bool loadCache(const char* path, unsigned long long quick) {\n"
+				"\t\t// The file is just the two arrays, so mapping it and copying them out is all there is to do\n"
+				"#ifdef _WIN32\n"
+				"\t\tHANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);\n"
+				"\t\tif (file == INVALID_HANDLE_VALUE) {\n"
+				"\t\t\treturn false;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tLARGE_INTEGER fsize;\n"
+				"\t\tHANDLE mapping = NULL;\n"
+				"\t\tconst void* data = nullptr;\n"
+				"\t\tstd::size_t size = 0;\n"
+				"\n"
+				"\t\tif (GetFileSizeEx(file, &fsize) && fsize.QuadPart > 0) {\n"
+				"\t\t\tmapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tif (mapping) {\n"
+				"\t\t\tdata = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);\n"
+				"\t\t\tsize = (std::size_t)fsize.QuadPart;\n"
+				"\t\t}\n"
+				"#else\n"
+				"\t\tint fd = open(path, O_RDONLY);\n"
+				"\t\tif (fd < 0) {\n"
+				"\t\t\treturn false;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tstruct stat st;\n"
+				"\t\tconst void* data = nullptr;\n"
+				"\t\tstd::size_t size = 0;\n"
+				"\n"
+				"\t\tif (fstat(fd, &st) == 0 && st.st_size > 0) {\n"
+				"\t\t\tvoid* m = mmap(nullptr, (std::size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);\n"
+				"\t\t\tdata = m == MAP_FAILED ? nullptr : m;\n"
+				"\t\t\tsize = (std::size_t)st.st_size;\n"
+				"\t\t}\n"
+				"#endif\n"
+				"\n"
+				"\t\tconst CacheHeader* header = (const CacheHeader*)data;\n"
+				"\t\tbool ok = header && size == sizeof(CacheHeader) + (sizeof(std::int32_t) * 2 + 1) * FieldCount\n"
+				"\t\t\t&& std::memcmp(header->magic, CacheMagic, sizeof(CacheMagic)) == 0 && header->quick == quick && header->count == FieldCount;\n"
+				"\n"
+				"\t\tif (ok) {\n"
+				"\t\t\tconst std::int32_t* offsets = (const std::int32_t*)(header + 1);\n"
+				"\t\t\tstd::memcpy(g_Offsets, offsets, sizeof(std::int32_t) * FieldCount);\n"
+				"\t\t\tstd::memcpy(g_ArraySizes, offsets + FieldCount, sizeof(std::int32_t) * FieldCount);\n"
+				"\t\t\tstd::memcpy(g_Present, offsets + FieldCount * 2, FieldCount);\n"
+				"\t\t\tg_Unresolved = header->unresolved;\n"
+				"\t\t\tg_CacheState = CacheLoaded;\n"
+				"\t\t}\n"
+				"\n"
+				"#ifdef _WIN32\n"
+				"\t\tif (data) {\n"
+				"\t\t\tUnmapViewOfFile(data);\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tif (mapping) {\n"
+				"\t\t\tCloseHandle(mapping);\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tCloseHandle(file);\n"
+				"#else\n"
+				"\t\tif (data) {\n"
+				"\t\t\tmunmap((void*)data, size);\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tclose(fd);\n"
+				"#endif\n"
+				"\n"
+				"\t\treturn ok;\n"
+				"\t}\n"
+				"\n"
+				"\tstatic void writeCache(const char* path, unsigned long long quick, unsigned long long full, const OffsetTable& table) {\n"
+				"\t\tCacheHeader header;\n"
+				"\t\tstd::memcpy(header.magic, CacheMagic, sizeof(CacheMagic));\n"
+				"\t\theader.quick = quick;\n"
+				"\t\theader.full = full;\n"
+				"\t\theader.count = FieldCount;\n"
+				"\t\theader.unresolved = table.unresolved;\n"
+				"\n"
+				"\t\t// Written next to the old one and swapped in, so a concurrent start never maps half a file\n"
+				"\t\tstd::string tmp = std::string{ path } + \".tmp\";\n"
+				"\t\tFILE* f = std::fopen(tmp.c_str(), \"wb\");\n"
+				"\t\tif (!f) {\n"
+				"\t\t\treturn;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tstd::fwrite(&header, sizeof(header), 1, f);\n"
+				"\t\tstd::fwrite(table.offsets, sizeof(std::int32_t), FieldCount, f);\n"
+				"\t\tstd::fwrite(table.sizes, sizeof(std::int32_t), FieldCount, f);\n"
+				"\t\tstd::fwrite(table.present, 1, FieldCount, f);\n"
+				"\t\tstd::fclose(f);\n"
+				"\n"
+				"\t\tstd::remove(path);\n"
+				"\t\tstd::rename(tmp.c_str(), path);\n"
+				"\t}\n"
+				"\n"
+				"\tCacheState getCacheState() {\n"
+				"\t\treturn (CacheState)g_CacheState.load();\n"
+				"\t}\n"
+				"\n"
+				"\tbool refreshOffsets() {\n"
+				"\t\t/// One atomic exchange when there's nothing new\n"
+				"\t\tstd::unique_ptr<OffsetTable> table{ g_StaleOffsets.exchange(nullptr, std::memory_order_acquire) };\n"
+				"\t\tif (!table) {\n"
+				"\t\t\treturn false;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tuseOffsets(table->offsets, table->sizes, table->present);\n"
+				"\t\treturn true;\n"
+				"\t}\n"
+				"\n"
+				"\tbool initialize(void* clientclass, const char* cachepath) {\n"
+				"\t\tg_ClientClasses = (ClientClass*)clientclass;\n"
+				"\t\tg_Version = -1;\n"
+				"#ifndef DVALVEGEN_TRUST_BAKED\n"
+				"\t\tg_Baked = false;\n"
+				"#endif\n"
+				"\n"
+				"\t\tunsigned long long full = BakedFingerprint != 0 || VersionCount != 0 ? graphFingerprint(clientclass) : 0;\n"
+				"\n"
+				"\t\t// Baked offsets are only trusted if the live graph is the one they were baked from\n"
+				"\t\t// The tables get the same values, for the name based lookups, hasField and publishShared\n"
+				"\t\tif (BakedFingerprint != 0 && full == BakedFingerprint) {\n"
+				"\t\t\tuseOffsets(BakedOffsets[0], BakedArraySizes[0], BakedPresent[0]);\n"
+				"#ifndef DVALVEGEN_TRUST_BAKED\n"
+				"\t\t\tg_Baked = true;\n"
+				"#endif\n"
+				"\t\t\treturn true;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\t// Generated from several builds, if this is one of them its offsets are already known\n"
+				"\t\tfor (unsigned int v = 0; v < VersionCount; v++) {\n"
+				"\t\t\tif (full == VersionFingerprints[v]) {\n"
+				"\t\t\t\tuseOffsets(VersionOffsets[v], VersionArraySizes[v], VersionPresent[v]);\n"
+				"\t\t\t\tg_Version = (int)v;\n"
+				"\t\t\t\treturn true;\n"
+				"\t\t\t}\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tunsigned long long quick = 0;\n"
+				"\n"
+				"\t\tif (cachepath) {\n"
+				"\t\t\tquick = quickFingerprint(g_ClientClasses);\n"
+				"\n"
+				"\t\t\tif (loadCache(cachepath, quick)) {\n"
+				"\t\t\t\t// The quick fingerprint doesn't look at props, check the full one off the critical path\n"
+				"\t\t\t\t// On a mismatch the offsets are resolved again into a table of their own, the cache is rewritten from it\n"
+				"\t\t\t\t// and refreshOffsets() takes it over on the thread that reads the live tables\n"
+				"\t\t\t\tstd::string path = cachepath;\n"
+				"\t\t\t\tClientClass* head = g_ClientClasses;\n"
+				"\t\t\t\tstd::thread{ [path, quick, head] {\n"
+				"\t\t\t\t\tunsigned long long full = graphFingerprint(head);\n"
+				"\t\t\t\t\tCacheHeader header;\n"
+				"\t\t\t\t\tFILE* f = std::fopen(path.c_str(), \"rb\");\n"
+				"\t\t\t\t\tbool ok = f && std::fread(&header, sizeof(header), 1, f) == 1 && header.full == full;\n"
+				"\n"
+				"\t\t\t\t\tif (f) {\n"
+				"\t\t\t\t\t\tstd::fclose(f);\n"
+				"\t\t\t\t\t}\n"
+				"\n"
+				"\t\t\t\t\tif (!ok) {\n"
+				"\t\t\t\t\t\tstd::unique_ptr<OffsetTable> table = resolveOffsets(head);\n"
+				"\t\t\t\t\t\twriteCache(path.c_str(), quick, full, *table);\n"
+				"\t\t\t\t\t\tdelete g_StaleOffsets.exchange(table.release(), std::memory_order_release);\n"
+				"\t\t\t\t\t}\n"
+				"\n"
+				"\t\t\t\t\tg_CacheState = ok ? CacheVerified : CacheStale;\n"
+				"\t\t\t\t} }.detach();\n"
+				"\n"
+				"\t\t\t\treturn true;\n"
 				"\t\t\t}\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tstd::unique_ptr<OffsetTable> table = resolveOffsets(g_ClientClasses);\n"
+				"\t\tuseOffsets(table->offsets, table->sizes, table->present);\n"
+				"\n"
+				"\t\tif (cachepath) {\n"
+				"\t\t\twriteCache(cachepath, quick, graphFingerprint(clientclass), *table);\n"
+				"\t\t}\n"
+				"\n"
+				"\t\treturn false;\n"
+				"\t}\n"
+				"\n"
+				"\tstatic const char SharedMagic[8] = { 'D', 'V', 'G', 'S', 'H', 'M', '1', 0 };\n"
+				"\tstatic const unsigned int SharedClassCapacity = 4096;\n"
+				"\n"
+				"\tstruct SharedClass {\n"
+				"\t\tchar name[60];\n"
+				"\t\tstd::int32_t id;\n"
+				"\t};\n"
+				"\n"
+				"\tstruct SharedHeader {\n"
+				"\t\tchar magic[8];\n"
+				"\t\tunsigned long long layout;\t\t\t\t// Which SDK the table belongs to, see sharedLayout()\n"
+				"\t\tstd::atomic<unsigned int> sequence;\t\t// Seqlock, odd while the publisher is writing\n"
+				"\t\tunsigned int fieldcount;\n"
+				"\t\tunsigned int classcount;\n"
+				"\t\tunsigned int unresolved;\n"
+				"\t\tint version;\n"
+				"\t\tunsigned long long fingerprint;\n"
+				"\t\t// Followed by offsets, array sizes, presence bytes and the classes sorted by name\n"
+				"\t};\n"
+				"\n"
+				"\tstatic const std::size_t SharedSize = sizeof(SharedHeader) + (sizeof(std::int32_t) * 2 + 1) * FieldCount + sizeof(SharedClass) * SharedClassCapacity + 8;\n"
+				"\n"
+				"\tstatic SharedHeader* g_Shared = nullptr;\n"
+				"\tstatic bool g_SharedWritable = false;\n"
+				"\tstatic unsigned int g_SharedSequence = 0;\n"
+				"\tstatic unsigned long long g_SharedFingerprint = 0;\n"
+				"\tstatic std::vector<SharedClass> g_SharedClasses;\n"
+				"#ifdef _WIN32\n"
+				"\tstatic HANDLE g_SharedMapping = NULL;\n"
+				"#endif\n"
+				"\n"
+				"\tstatic std::int32_t* sharedOffsets(SharedHeader* header) {\n"
+				"\t\treturn (std::int32_t*)(header + 1);\n"
+				"\t}\n"
+				"\n"
+				"\tstatic SharedClass* sharedClasses(SharedHeader* header) {\n"
+				"\t\t// Aligned, the presence bytes before it have an arbitrary length\n"
+				"\t\tstd::uintptr_t p = (std::uintptr_t)(sharedOffsets(header) + FieldCount * 2) + FieldCount;\n"
+				"\t\treturn (SharedClass*)((p + 7) & ~(std::uintptr_t)7);\n"
+				"\t}\n"
 				"\n"
-				"\t\t\tcclass = cclass->m_pNext;\n"
+				"\tstatic unsigned long long sharedLayout() {\n"
+				"\t\t/// Two SDKs only share a table if they were generated with the same fields in the same order\n"
+				"\t\tunsigned long long h = fingerprintMix(0, FieldCount);\n"
+				"\t\tfor (unsigned int i = 0; i < FieldCount; i++) {\n"
+				"\t\t\th = fingerprintString(fingerprintString(h, Fields[i].table), Fields[i].prop);\n"
 				"\t\t}\n"
+				"\n"
+				"\t\treturn h;\n"
 				"\t}\n"
+				"\n"
+				"\tstatic SharedHeader* mapShared(const char* name, bool writable) {\n"
+				"#ifdef _WIN32\n"
+				"\t\tg_SharedMapping = writable\n"
+				"\t\t\t? CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, (DWORD)SharedSize, name)\n"
+				"\t\t\t: OpenFileMappingA(FILE_MAP_READ, FALSE, name);\n"
+				"\n"
+				"\t\tif (!g_SharedMapping) {\n"
+				"\t\t\treturn nullptr;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tvoid* m = MapViewOfFile(g_SharedMapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, SharedSize);\n"
+				"\t\tif (!m) {\n"
+				"\t\t\tCloseHandle(g_SharedMapping);\n"
+				"\t\t\tg_SharedMapping = NULL;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\treturn (SharedHeader*)m;\n"
+				"#else\n"
+				"\t\tint fd = shm_open(name, writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);\n"
+				"\t\tif (fd < 0) {\n"
+				"\t\t\treturn nullptr;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tstruct stat st;\n"
+				"\t\tbool ok = writable ? ftruncate(fd, (off_t)SharedSize) == 0 : fstat(fd, &st) == 0 && (std::size_t)st.st_size >= SharedSize;\n"
+				"\t\tvoid* m = ok ? mmap(nullptr, SharedSize, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;\n"
+				"\t\tclose(fd);\n"
+				"\n"
+				"\t\treturn m == MAP_FAILED ? nullptr : (SharedHeader*)m;\n"
+				"#endif\n"
+				"\t}\n"
+				"\n"
+				"\tvoid closeShared() {\n"
+				"\t\tif (g_Shared) {\n"
+				"#ifdef _WIN32\n"
+				"\t\t\tUnmapViewOfFile(g_Shared);\n"
+				"\t\t\tCloseHandle(g_SharedMapping);\n"
+				"\t\t\tg_SharedMapping = NULL;\n"
+				"#else\n"
+				"\t\t\tmunmap(g_Shared, SharedSize);\n"
+				"#endif\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tg_Shared = nullptr;\n"
+				"\t\tg_SharedWritable = false;\n"
+				"\t}\n"
+				"\n"
+				"\tvoid removeShared(const char* name) {\n"
+				"#ifndef _WIN32\n"
+				"\t\tshm_unlink(name);\n"
+				"#endif\n"
+				"\t}\n"
+				"\n"
+				"\tbool publishShared(const char* name) {\n"
+				"\t\t/// Call after initialize(), and again whenever the offsets change, readers pick it up with refreshShared()\n"
+				"\t\tif (!g_ClientClasses) {\n"
+				"\t\t\treturn false;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\t// Nothing resolved, readers would take a zeroed table as valid offsets\n"
+				"\t\tif (FieldCount && g_Unresolved == FieldCount) {\n"
+				"\t\t\treturn false;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tif (!g_SharedWritable) {\n"
+				"\t\t\tcloseShared();\n"
+				"\t\t\tg_Shared = mapShared(name, true);\n"
+				"\t\t\tg_SharedWritable = g_Shared != nullptr;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tif (!g_Shared) {\n"
+				"\t\t\treturn false;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tstd::vector<SharedClass> classes;\n"
+				"\t\tfor (ClientClass* cclass = g_ClientClasses; cclass && classes.size() < SharedClassCapacity; cclass = cclass->m_pNext) {\n"
+				"\t\t\tSharedClass c{};\n"
+				"\t\t\tstd::strncpy(c.name, cclass->m_pNetworkName, sizeof(c.name) - 1);\n"
+				"\t\t\tc.id = cclass->m_ClassID;\n"
+				"\t\t\tclasses.push_back(c);\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tstd::sort(classes.begin(), classes.end(), [](const SharedClass& a, const SharedClass& b) {\n"
+				"\t\t\treturn std::strcmp(a.name, b.name) < 0;\n"
+				"\t\t});\n"
+				"\n"
+				"\t\tunsigned long long fingerprint = graphFingerprint(g_ClientClasses);\n"
+				"\t\tSharedHeader* header = g_Shared;\n"
+				"\n"
+				"\t\t// Odd sequence while writing, readers that saw it or see it change retry\n"
+				"\t\tunsigned int sequence = header->sequence.load(std::memory_order_relaxed);\n"
+				"\t\tsequence += sequence & 1;\n"
+				"\t\theader->sequence.store(sequence + 1, std::memory_order_relaxed);\n"
+				"\t\tstd::atomic_thread_fence(std::memory_order_release);\n"
+				"\n"
+				"\t\tstd::memcpy(header->magic, SharedMagic, sizeof(SharedMagic));\n"
+				"\t\theader->layout = sharedLayout();\n"
+				"\t\theader->fieldcount = FieldCount;\n"
+				"\t\theader->classcount = (unsigned int)classes.size();\n"
+				"\t\theader->unresolved = g_Unresolved;\n"
+				"\t\theader->version = g_Version;\n"
+				"\t\theader->fingerprint = fingerprint;\n"
+				"\n"
+				"\t\tstd::memcpy(sharedOffsets(header), g_Offsets, sizeof(std::int32_t) * FieldCount);\n"
+				"\t\tstd::memcpy(sharedOffsets(header) + FieldCount, g_ArraySizes, sizeof(std::int32_t) * FieldCount);\n"
+				"\t\tstd::memcpy(sharedOffsets(header) + FieldCount * 2, g_Present, FieldCount);\n"
+				"\t\tstd::memcpy(sharedClasses(header), classes.data(), sizeof(SharedClass) * classes.size());\n"
+				"\n"
+				"\t\theader->sequence.store(sequence + 2, std::memory_order_release);\n"
+				"\t\treturn true;\n"
+				"\t}\n"
+				"\n"
+				"\tstatic bool readShared(bool force) {\n"
+				"\t\t/// Copies the whole table out of the segment, retrying until it got one the publisher didn't touch meanwhile\n"
+				"\t\tif (!g_Shared) {\n"
+				"\t\t\treturn false;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tstd::vector<std::int32_t> offsets(FieldCount * 2);\n"
+				"\t\tstd::vector<unsigned char> present(FieldCount);\n"
+				"\t\tstd::vector<SharedClass> classes;\n"
+				"\t\tSharedHeader header;\n"
+				"\t\tunsigned int before;\n"
+				"\n"
+				"\t\tfor (;;) {\n"
+				"\t\t\tbefore = g_Shared->sequence.load(std::memory_order_acquire);\n"
+				"\n"
+				"\t\t\tif (!force && before == g_SharedSequence) {\n"
+				"\t\t\t\treturn false;\n"
+				"\t\t\t}\n"
+				"\n"
+				"\t\t\tif (before == 0) {\n"
+				"\t\t\t\treturn false;\t// Created but never published\n"
+				"\t\t\t}\n"
+				"\n"
+				"\t\t\tif (before & 1) {\n"
+				"\t\t\t\tstd::this_thread::yield();\n"
+				"\t\t\t\tcontinue;\n"
+				"\t\t\t}\n"
+				"\n"
+				"\t\t\tstd::memcpy((void*)&header, (const void*)g_Shared, sizeof(header));\n"
+				"\t\t\tunsigned int count = std::min(header.classcount, SharedClassCapacity);\n"
+				"\t\t\tclasses.resize(count);\n"
+				"\n"
+				"\t\t\tstd::memcpy(offsets.data(), sharedOffsets(g_Shared), sizeof(std::int32_t) * FieldCount * 2);\n"
+				"\t\t\tstd::memcpy(present.data(), sharedOffsets(g_Shared) + FieldCount * 2, FieldCount);\n"
+				"\t\t\tstd::memcpy(classes.data(), sharedClasses(g_Shared), sizeof(SharedClass) * count);\n"
+				"\n"
+				"\t\t\tstd::atomic_thread_fence(std::memory_order_acquire);\n"
+				"\t\t\tif (g_Shared->sequence.load(std::memory_order_relaxed) == before) {\n"
+				"\t\t\t\tbreak;\n"
+				"\t\t\t}\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tif (std::memcmp(header.magic, SharedMagic, sizeof(SharedMagic)) != 0 || header.fieldcount != FieldCount || header.layout != sharedLayout()) {\n"
+				"\t\t\treturn false;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tstd::memcpy(g_Offsets, offsets.data(), sizeof(std::int32_t) * FieldCount);\n"
+				"\t\tstd::memcpy(g_ArraySizes, offsets.data() + FieldCount, sizeof(std::int32_t) * FieldCount);\n"
+				"\t\tstd::memcpy(g_Present, present.data(), FieldCount);\n"
+				"\t\tg_Unresolved = header.unresolved;\n"
+				"\t\tg_Version = header.version;\n"
+				"\t\tg_SharedFingerprint = header.fingerprint;\n"
+				"\t\tg_SharedClasses = std::move(classes);\n"
+				"\t\tg_SharedSequence = before;\n"
+				"\t\treturn true;\n"
+				"\t}\n"
+				"\n"
+				"\tbool attachShared(const char* name) {\n"
+				"\t\t/// Maps a published table read-only and takes its offsets, false if there is none or it's from another SDK\n"
+				"\t\tcloseShared();\n"
+				"\t\tg_Shared = mapShared(name, false);\n"
+				"\t\tg_SharedSequence = 0;\n"
+				"\n"
+				"\t\tif (!readShared(true)) {\n"
+				"\t\t\tcloseShared();\n"
+				"\t\t\treturn false;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\treturn true;\n"
+				"\t}\n"
+				"\n"
+				"\tbool refreshShared() {\n"
+				"\t\t/// One atomic load when nothing changed\n"
+				"\t\treturn readShared(false);\n"
+				"\t}\n"
+				"\n"
+				"\tint getSharedClassId(const char* networkname) {\n"
+				"\t\tauto it = std::lower_bound(g_SharedClasses.begin(), g_SharedClasses.end(), networkname, [](const SharedClass& c, const char* name) {\n"
+				"\t\t\treturn std::strcmp(c.name, name) < 0;\n"
+				"\t\t});\n"
+				"\n"
+				"\t\treturn it != g_SharedClasses.end() && std::strcmp(it->name, networkname) == 0 ? it->id : -1;\n"
+				"\t}\n"
+				"\n"
+				"\tunsigned long long getSharedFingerprint() {\n"
+				"\t\treturn g_SharedFingerprint;\n"
+				"\t}\n"
+				"#ifdef DVALVEGEN_PROFILE\n"
+				"\tstatic std::mutex g_ProfileMutex;\n"
+				"\tstatic std::vector<std::atomic<unsigned long long>*> g_ProfileThreads;\n"
+				"\n"
+				"\tstd::atomic<unsigned long long>* registerProfileThread() {\n"
+				"\t\t// Whole cache lines, so counters of two threads never share one\n"
+				"\t\tstd::size_t bytes = (sizeof(std::atomic<unsigned long long>) * FieldCount + 63) / 64 * 64;\n"
+				"\t\tstd::atomic<unsigned long long>* counters = (std::atomic<unsigned long long>*)::operator new(bytes, std::align_val_t{ 64 });\n"
+				"\n"
+				"\t\tfor (unsigned int i = 0; i < FieldCount; i++) {\n"
+				"\t\t\tnew (&counters[i]) std::atomic<unsigned long long>(0);\n"
+				"\t\t}\n"
+				"\n"
+				"\t\t// Never freed, counts of threads that exited still show up in the report\n"
+				"\t\tstd::lock_guard<std::mutex> lock{ g_ProfileMutex };\n"
+				"\t\tg_ProfileThreads.push_back(counters);\n"
+				"\t\treturn counters;\n"
+				"\t}\n"
+				"\n"
+				"\tunsigned long long getAccessCount(unsigned int id) {\n"
+				"\t\tstd::lock_guard<std::mutex> lock{ g_ProfileMutex };\n"
+				"\t\tunsigned long long n = 0;\n"
+				"\n"
+				"\t\tfor (auto counters : g_ProfileThreads) {\n"
+				"\t\t\tn += counters[id].load(std::memory_order_relaxed);\n"
+				"\t\t}\n"
+				"\n"
+				"\t\treturn n;\n"
+				"\t}\n"
+				"\n"
+				"\tstd::string profileReport() {\n"
+				"\t\t/// Fields that were accessed, most used first\n"
+				"\t\tstd::vector<unsigned long long> totals(FieldCount, 0);\n"
+				"\t\tunsigned long long total = 0;\n"
+				"\n"
+				"\t\t{\n"
+				"\t\t\tstd::lock_guard<std::mutex> lock{ g_ProfileMutex };\n"
+				"\t\t\tfor (auto counters : g_ProfileThreads) {\n"
+				"\t\t\t\tfor (unsigned int i = 0; i < FieldCount; i++) {\n"
+				"\t\t\t\t\ttotals[i] += counters[i].load(std::memory_order_relaxed);\n"
+				"\t\t\t\t}\n"
+				"\t\t\t}\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tstd::vector<unsigned int> ids;\n"
+				"\t\tfor (unsigned int i = 0; i < FieldCount; i++) {\n"
+				"\t\t\tif (totals[i]) {\n"
+				"\t\t\t\tids.push_back(i);\n"
+				"\t\t\t\ttotal += totals[i];\n"
+				"\t\t\t}\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tstd::sort(ids.begin(), ids.end(), [&totals](unsigned int a, unsigned int b) {\n"
+				"\t\t\treturn totals[a] > totals[b];\n"
+				"\t\t});\n"
+				"\n"
+				"\t\tstd::string report;\n"
+				"\t\tchar line[256];\n"
+				"\n"
+				"\t\tstd::snprintf(line, sizeof(line), \"%-40s %-32s %14s %8s\\n\", \"Field\", \"Class\", \"Calls\", \"Share\");\n"
+				"\t\treport += line;\n"
+				"\n"
+				"\t\tfor (unsigned int id : ids) {\n"
+				"\t\t\tstd::snprintf(line, sizeof(line), \"%-40s %-32s %14llu %7.2f%%\\n\", Fields[id].name, Fields[id].table, totals[id], 100.0 * totals[id] / total);\n"
+				"\t\t\treport += line;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\treturn report;\n"
+				"\t}\n"
+				"\n"
+				"\tvoid resetProfile() {\n"
+				"\t\tstd::lock_guard<std::mutex> lock{ g_ProfileMutex };\n"
+				"\t\tfor (auto counters : g_ProfileThreads) {\n"
+				"\t\t\tfor (unsigned int i = 0; i < FieldCount; i++) {\n"
+				"\t\t\t\tcounters[i].store(0, std::memory_order_relaxed);\n"
+				"\t\t\t}\n"
+				"\t\t}\n"
+				"\t}\n"
+				"#endif\n"
 				"}\n";
-			ocpp.close();
+			emitFile("dvalvegen.cpp", ocpp.str());
+
+			// Engine layout vectors and the batch kernels that work on them
+			memory::OStream<memory::Output> ov;
+			ov <<
+				"#pragma once\n"
+				"\n"
+				"#include <cmath>\n"
+				"#include <cstddef>\n"
+				"#include <cstdint>\n"
+				"\n"
+				"#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)\n"
+				"#define DVALVEGEN_VECTOR_SSE\n"
+				"#include <emmintrin.h>\n"
+				"#endif\n"
+				"\n"
+				"// Same layout as the engine's Vector and Vector2D, 12 and 8 bytes without padding\n"
+				"class Vector {\n"
+				"public:\n"
+				"\tfloat x, y, z;\n"
+				"\n"
+				"\tVector() = default;\n"
+				"\n"
+				"\tVector(float x, float y, float z) : x(x), y(y), z(z) {\n"
+				"\n"
+				"\t}\n"
+				"\n"
+				"\tVector operator+(const Vector& v) const {\n"
+				"\t\treturn { x + v.x, y + v.y, z + v.z };\n"
+				"\t}\n"
+				"\n"
+				"\tVector operator-(const Vector& v) const {\n"
+				"\t\treturn { x - v.x, y - v.y, z - v.z };\n"
+				"\t}\n"
+				"\n"
+				"\tVector operator*(float f) const {\n"
+				"\t\treturn { x * f, y * f, z * f };\n"
+				"\t}\n"
+				"\n"
+				"\tfloat dot(const Vector& v) const {\n"
+				"\t\treturn x * v.x + y * v.y + z * v.z;\n"
+				"\t}\n"
+				"\n"
+				"\tfloat lengthSqr() const {\n"
+				"\t\treturn dot(*this);\n"
+				"\t}\n"
+				"\n"
+				"\tfloat length() const {\n"
+				"\t\treturn std::sqrt(lengthSqr());\n"
+				"\t}\n"
+				"\n"
+				"\tfloat distToSqr(const Vector& v) const {\n"
+				"\t\treturn (*this - v).lengthSqr();\n"
+				"\t}\n"
+				"};\n"
+				"\n"
+				"class Vector2D {\n"
+				"public:\n"
+				"\tfloat x, y;\n"
+				"\n"
+				"\tVector2D() = default;\n"
+				"\n"
+				"\tVector2D(float x, float y) : x(x), y(y) {\n"
+				"\n"
+				"\t}\n"
+				"\n"
+				"\tVector2D operator+(const Vector2D& v) const {\n"
+				"\t\treturn { x + v.x, y + v.y };\n"
+				"\t}\n"
+				"\n"
+				"\tVector2D operator-(const Vector2D& v) const {\n"
+				"\t\treturn { x - v.x, y - v.y };\n"
+				"\t}\n"
+				"\n"
+				"\tVector2D operator*(float f) const {\n"
+				"\t\treturn { x * f, y * f };\n"
+				"\t}\n"
+				"\n"
+				"\tfloat lengthSqr() const {\n"
+				"\t\treturn x * x + y * y;\n"
+				"\t}\n"
+				"};\n"
+				"\n"
+				"static_assert(sizeof(Vector) == 12, \"Vector has to match the engine's layout\");\n"
+				"static_assert(sizeof(Vector2D) == 8, \"Vector2D has to match the engine's layout\");\n"
+				"\n"
+				"namespace dvalvegen {\n"
+				"\tnamespace vec {\n"
+				"\t\t// Batch kernels take either a strided array (base, stride in bytes), e.g. a column of vectors,\n"
+				"\t\t// or a list of entities plus the accessor of the field, e.g. &C_BasePlayer::m_vecOrigin\n"
+				"\n"
+				"\t\tinline const Vector& at(const void* base, std::size_t stride, std::size_t i) {\n"
+				"\t\t\treturn *(const Vector*)((const std::uint8_t*)base + stride * i);\n"
+				"\t\t}\n"
+				"\n"
+				"#ifdef DVALVEGEN_VECTOR_SSE\n"
+				"\t\tinline __m128 load(const Vector& v) {\n"
+				"\t\t\t/// x y z 0, never reads past the 12 bytes\n"
+				"\t\t\treturn _mm_movelh_ps(_mm_castpd_ps(_mm_load_sd((const double*)&v.x)), _mm_load_ss(&v.z));\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tinline void store(Vector& v, __m128 r) {\n"
+				"\t\t\t_mm_store_sd((double*)&v.x, _mm_castps_pd(r));\n"
+				"\t\t\t_mm_store_ss(&v.z, _mm_movehl_ps(r, r));\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tinline __m128 load(const Vector2D& v) {\n"
+				"\t\t\treturn _mm_castpd_ps(_mm_load_sd((const double*)&v.x));\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tinline void store(Vector2D& v, __m128 r) {\n"
+				"\t\t\t_mm_store_sd((double*)&v.x, _mm_castps_pd(r));\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tinline __m128 distanceSqr4(__m128 a, __m128 b, __m128 c, __m128 d, __m128 px, __m128 py, __m128 pz) {\n"
+				"\t\t\t// Four x y z 0 rows to x, y and z columns\n"
+				"\t\t\t_MM_TRANSPOSE4_PS(a, b, c, d);\n"
+				"\t\t\t__m128 dx = _mm_sub_ps(a, px);\n"
+				"\t\t\t__m128 dy = _mm_sub_ps(b, py);\n"
+				"\t\t\t__m128 dz = _mm_sub_ps(c, pz);\n"
+				"\t\t\treturn _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));\n"
+				"\t\t}\n"
+				"#endif\n"
+				"\n"
+				"\t\tinline void distanceSqr(const void* base, std::size_t stride, std::size_t count, const Vector& point, float* out) {\n"
+				"\t\t\t/// Squared distance of every vector to point\n"
+				"\t\t\tstd::size_t i = 0;\n"
+				"\n"
+				"#ifdef DVALVEGEN_VECTOR_SSE\n"
+				"\t\t\t__m128 px = _mm_set1_ps(point.x);\n"
+				"\t\t\t__m128 py = _mm_set1_ps(point.y);\n"
+				"\t\t\t__m128 pz = _mm_set1_ps(point.z);\n"
+				"\n"
+				"\t\t\tfor (; i + 4 <= count; i += 4) {\n"
+				"\t\t\t\t__m128 r = distanceSqr4(load(at(base, stride, i)), load(at(base, stride, i + 1)), load(at(base, stride, i + 2)), load(at(base, stride, i + 3)), px, py, pz);\n"
+				"\t\t\t\t_mm_storeu_ps(out + i, r);\n"
+				"\t\t\t}\n"
+				"#endif\n"
+				"\n"
+				"\t\t\tfor (; i < count; i++) {\n"
+				"\t\t\t\tout[i] = at(base, stride, i).distToSqr(point);\n"
+				"\t\t\t}\n"
+				"\t\t}\n"
+				"\n"
+				"\t\ttemplate<typename C>\n"
+				"\t\tstd::ptrdiff_t fieldOffset(C* const* entities, std::size_t count, Vector* (C::*field)()) {\n"
+				"\t\t\t/// Generated accessors are this + offset, so the offset is taken once instead of calling the accessor per entity\n"
+				"\t\t\treturn count ? (const std::uint8_t*)(entities[0]->*field)() - (const std::uint8_t*)entities[0] : 0;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\ttemplate<typename C>\n"
+				"\t\tconst Vector& at(C* const* entities, std::size_t i, std::ptrdiff_t offset) {\n"
+				"\t\t\treturn *(const Vector*)((const std::uint8_t*)entities[i] + offset);\n"
+				"\t\t}\n"
+				"\n"
+				"\t\ttemplate<typename C>\n"
+				"\t\tvoid distanceSqr(C* const* entities, std::size_t count, Vector* (C::*field)(), const Vector& point, float* out) {\n"
+				"\t\t\tstd::ptrdiff_t offset = fieldOffset(entities, count, field);\n"
+				"\t\t\tstd::size_t i = 0;\n"
+				"\n"
+				"#ifdef DVALVEGEN_VECTOR_SSE\n"
+				"\t\t\t__m128 px = _mm_set1_ps(point.x);\n"
+				"\t\t\t__m128 py = _mm_set1_ps(point.y);\n"
+				"\t\t\t__m128 pz = _mm_set1_ps(point.z);\n"
+				"\n"
+				"\t\t\tfor (; i + 4 <= count; i += 4) {\n"
+				"\t\t\t\t__m128 r = distanceSqr4(load(at(entities, i, offset)), load(at(entities, i + 1, offset)), load(at(entities, i + 2, offset)), load(at(entities, i + 3, offset)), px, py, pz);\n"
+				"\t\t\t\t_mm_storeu_ps(out + i, r);\n"
+				"\t\t\t}\n"
+				"#endif\n"
+				"\n"
+				"\t\t\tfor (; i < count; i++) {\n"
+				"\t\t\t\tout[i] = at(entities, i, offset).distToSqr(point);\n"
+				"\t\t\t}\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tinline bool inside(const Vector& v, const Vector& mins, const Vector& maxs) {\n"
+				"#ifdef DVALVEGEN_VECTOR_SSE\n"
+				"\t\t\t__m128 r = load(v);\n"
+				"\t\t\t__m128 ok = _mm_and_ps(_mm_cmpge_ps(r, load(mins)), _mm_cmple_ps(r, load(maxs)));\n"
+				"\t\t\treturn (_mm_movemask_ps(ok) & 7) == 7;\n"
+				"#else\n"
+				"\t\t\treturn v.x >= mins.x && v.y >= mins.y && v.z >= mins.z && v.x <= maxs.x && v.y <= maxs.y && v.z <= maxs.z;\n"
+				"#endif\n"
+				"\t\t}\n"
+				"\n"
+				"#ifdef DVALVEGEN_VECTOR_SSE\n"
+				"\t\tinline int inside4(__m128 a, __m128 b, __m128 c, __m128 d, __m128 lx, __m128 ly, __m128 lz, __m128 hx, __m128 hy, __m128 hz) {\n"
+				"\t\t\t/// One bit per row that is inside the box\n"
+				"\t\t\t_MM_TRANSPOSE4_PS(a, b, c, d);\n"
+				"\t\t\t__m128 ok = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(a, lx), _mm_cmple_ps(a, hx)), _mm_and_ps(_mm_cmpge_ps(b, ly), _mm_cmple_ps(b, hy)));\n"
+				"\t\t\tok = _mm_and_ps(ok, _mm_and_ps(_mm_cmpge_ps(c, lz), _mm_cmple_ps(c, hz)));\n"
+				"\t\t\treturn _mm_movemask_ps(ok);\n"
+				"\t\t}\n"
+				"#endif\n"
+				"\n"
+				"\t\tinline std::size_t cull(const void* base, std::size_t stride, std::size_t count, const Vector& mins, const Vector& maxs, std::uint32_t* out) {\n"
+				"\t\t\t/// Writes the indices of the vectors inside the box to out, returns how many there were\n"
+				"\t\t\tstd::size_t n = 0;\n"
+				"\t\t\tstd::size_t i = 0;\n"
+				"\n"
+				"#ifdef DVALVEGEN_VECTOR_SSE\n"
+				"\t\t\t__m128 lx = _mm_set1_ps(mins.x), ly = _mm_set1_ps(mins.y), lz = _mm_set1_ps(mins.z);\n"
+				"\t\t\t__m128 hx = _mm_set1_ps(maxs.x), hy = _mm_set1_ps(maxs.y), hz = _mm_set1_ps(maxs.z);\n"
+				"\n"
+				"\t\t\tfor (; i + 4 <= count; i += 4) {\n"
+				"\t\t\t\tint bits = inside4(load(at(base, stride, i)), load(at(base, stride, i + 1)), load(at(base, stride, i + 2)), load(at(base, stride, i + 3)), lx, ly, lz, hx, hy, hz);\n"
+				"\t\t\t\tfor (int k = 0; k < 4; k++) {\n"
+				"\t\t\t\t\tout[n] = (std::uint32_t)(i + k);\n"
+				"\t\t\t\t\tn += (bits >> k) & 1;\n"
+				"\t\t\t\t}\n"
+				"\t\t\t}\n"
+				"#endif\n"
+				"\n"
+				"\t\t\tfor (; i < count; i++) {\n"
+				"\t\t\t\tout[n] = (std::uint32_t)i;\n"
+				"\t\t\t\tn += inside(at(base, stride, i), mins, maxs);\n"
+				"\t\t\t}\n"
+				"\n"
+				"\t\t\treturn n;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\ttemplate<typename C>\n"
+				"\t\tstd::size_t cull(C* const* entities, std::size_t count, Vector* (C::*field)(), const Vector& mins, const Vector& maxs, std::uint32_t* out) {\n"
+				"\t\t\tstd::ptrdiff_t offset = fieldOffset(entities, count, field);\n"
+				"\t\t\tstd::size_t n = 0;\n"
+				"\t\t\tstd::size_t i = 0;\n"
+				"\n"
+				"#ifdef DVALVEGEN_VECTOR_SSE\n"
+				"\t\t\t__m128 lx = _mm_set1_ps(mins.x), ly = _mm_set1_ps(mins.y), lz = _mm_set1_ps(mins.z);\n"
+				"\t\t\t__m128 hx = _mm_set1_ps(maxs.x), hy = _mm_set1_ps(maxs.y), hz = _mm_set1_ps(maxs.z);\n"
+				"\n"
+				"\t\t\tfor (; i + 4 <= count; i += 4) {\n"
+				"\t\t\t\tint bits = inside4(load(at(entities, i, offset)), load(at(entities, i + 1, offset)), load(at(entities, i + 2, offset)), load(at(entities, i + 3, offset)), lx, ly, lz, hx, hy, hz);\n"
+				"\t\t\t\tfor (int k = 0; k < 4; k++) {\n"
+				"\t\t\t\t\tout[n] = (std::uint32_t)(i + k);\n"
+				"\t\t\t\t\tn += (bits >> k) & 1;\n"
+				"\t\t\t\t}\n"
+				"\t\t\t}\n"
+				"#endif\n"
+				"\n"
+				"\t\t\tfor (; i < count; i++) {\n"
+				"\t\t\t\tout[n] = (std::uint32_t)i;\n"
+				"\t\t\t\tn += inside(at(entities, i, offset), mins, maxs);\n"
+				"\t\t\t}\n"
+				"\n"
+				"\t\t\treturn n;\n"
+				"\t\t}\n"
+				"\n"
+				"\t\tinline void lerp(const void* from, std::size_t fromstride, const void* to, std::size_t tostride, std::size_t count, float t, Vector* out) {\n"
+				"\t\t\t/// out[i] = from[i] + (to[i] - from[i]) * t, e.g. interpolating between two snapshots\n"
+				"#ifdef DVALVEGEN_VECTOR_SSE\n"
+				"\t\t\t__m128 vt = _mm_set1_ps(t);\n"
+				"\n"
+				"\t\t\tfor (std::size_t i = 0; i < count; i++) {\n"
+				"\t\t\t\t__m128 a = load(at(from, fromstride, i));\n"
+				"\t\t\t\t__m128 b = load(at(to, tostride, i));\n"
+				"\t\t\t\tstore(out[i], _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), vt)));\n"
+				"\t\t\t}\n"
+				"#else\n"
+				"\t\t\tfor (std::size_t i = 0; i < count; i++) {\n"
+				"\t\t\t\tconst Vector& a = at(from, fromstride, i);\n"
+				"\t\t\t\tout[i] = a + (at(to, tostride, i) - a) * t;\n"
+				"\t\t\t}\n"
+				"#endif\n"
+				"\t\t}\n"
+				"\t}\n"
+				"}\n";
+			emitFile("Vector.h", ov.str());
 		};
 
 		write_dvalvegen();
 
-		for (auto c : dvalvegen::g_Classes) {
+		// Every class declared once, for code that only passes pointers around
+		memory::OStream<memory::Output> ofwd;
+		ofwd << "#pragma once" << std::endl << std::endl;
+
+		std::vector<std::string> names;
+		for (auto& c : dvalvegen::g_Classes) {
+			names.push_back(c.second.getFormattedName());
+		}
+
+		std::sort(names.begin(), names.end());
+		for (auto& name : names) {
+			ofwd << "class " << name << ";" << std::endl;
+		}
+
+		emitFile("dvalvegen_fwd.h", ofwd.str());
+
+		for (auto& c : dvalvegen::g_Classes) {
+			if (tables && !tables->count(c.first)) {
+				continue;
+			}
+
+			DVALVEGEN_TRACE_SCOPE_DETAIL("printClass", c.second.table()->m_pNetTableName);
+
+			std::uint64_t key = cache ? classTextKey(c.second, bake) : 0;
+
+			if (cache) {
+				auto it = cache->find(key);
+				if (it != cache->end()) {
+					emitFile(c.second.getFormattedName() + ".h", it->second);
+					continue;
+				}
+			}
+
 			std::unordered_set<std::string> dps;
-			std::ofstream of{ dirpath + c.second.getFormattedName() + ".h" };
+			std::unordered_set<std::string> fwds;
+			memory::OStream<memory::Output> ss;
+			{
+				DVALVEGEN_TRACE_SCOPE("format");
+				c.second.print(ss, 0, dps, fwds);
+				c.second.printReflection(ss, dps);
+			}
 
+			memory::OStream<memory::Output> of;
 			of << "#pragma once" << std::endl << std::endl;
 
-			std::stringstream ss;
-			c.second.print(ss, 0, dps);
-
 			for (auto& dp : dps) {
 				of << "#include \"" << dp << ".h\"" << std::endl;
 			}
 
+			bool declared = false;
+			for (auto& fwd : fwds) {
+				if (!dps.count(fwd) && fwd != c.second.getFormattedName()) {
+					of << (declared ? "" : "\n") << "class " << fwd << ";" << std::endl;
+					declared = true;
+				}
+			}
+
 			of << std::endl << ss.str();
-			of.close();
+
+			std::string text{ of.str() };
+			if (cache) {
+				cache->emplace(key, text);
+			}
+
+			emitFile(c.second.getFormattedName() + ".h", text);
+		}
+	}
+
+	void renderClasses(SdkFiles& files, bool bake = false, ClassTextCache* cache = nullptr, const std::unordered_set<std::string>* tables = nullptr) {
+		/// Keeps the whole SDK in memory
+		renderClasses([&files](std::string& name, std::string& text) {
+			files[name] += text;
+		}, bake, cache, tables);
+	}
+
+	std::string sdkDirectory(std::string dirpath) {
+		if (dirpath[dirpath.size() - 1] == '/' || dirpath[dirpath.size() - 1] == '\\') {
+			dirpath.erase(dirpath.begin() + dirpath.size() - 1);
+		}
+
+		return dirpath + "/dvalvegen/";
+	}
+
+	struct SdkFile {
+		std::string name;
+		std::string text;
+	};
+
+	bool printClasses(std::string dirpath, bool bake = false, uint queuedepth = 16, const std::unordered_set<std::string>* tables = nullptr) {
+		/// Renders the SDK and writes it to <dirpath>/dvalvegen/, false if a file couldn't be written
+		/// Files are written on a second thread while the next ones are rendered, at most queuedepth of them are in memory at once
+		DVALVEGEN_TRACE_SCOPE("printClasses");
+		dirpath = sdkDirectory(dirpath);
+
+		std::error_code ec;
+		std::filesystem::create_directories(dirpath, ec);
+		if (ec) {
+			return false;
 		}
+
+		SpscRing<SdkFile> queue{ queuedepth };
+		std::atomic<bool> rendered{ false };
+		bool written = true; // Only touched by the writer until it's joined
+
+		// Both sides sleep instead of spinning, the writer while the queue is empty and the renderer while it's full
+		std::mutex mutex;
+		std::condition_variable changed;
+		auto notify = [&mutex, &changed] {
+			// Taking the lock once orders this after a waiter's check of the queue, so the wakeup can't be missed
+			{
+				std::lock_guard<std::mutex> lock{ mutex };
+			}
+
+			changed.notify_all();
+		};
+
+		std::thread writer{ [&queue, &rendered, &dirpath, &written, &mutex, &changed, &notify] {
+			SdkFile file;
+			std::string current;
+			std::unordered_set<std::string> opened;
+			std::ofstream of;
+
+			while (true) {
+				if (!queue.pop(file)) {
+					{
+						std::unique_lock<std::mutex> lock{ mutex };
+						changed.wait(lock, [&queue, &rendered] {
+							return queue.size() > 0 || rendered.load(std::memory_order_acquire);
+						});
+					}
+
+					// Everything was pushed before the flag was set, so an empty queue after it means done
+					if (!queue.pop(file)) {
+						break;
+					}
+				}
+
+				// There's room again
+				notify();
+
+				DVALVEGEN_TRACE_SCOPE("write");
+
+				// Another piece of the file that's already open
+				if (file.name != current) {
+					// Closing flushes, which can fail as well
+					if (of.is_open()) {
+						of.close();
+						written = written && !of.fail();
+					}
+
+					// A file that was already started gets the piece appended, only the first one truncates
+					bool first = opened.insert(file.name).second;
+					of.open(dirpath + file.name, std::ios::binary | (first ? std::ios::trunc : std::ios::app));
+					current = file.name;
+
+					if (first) {
+						DVALVEGEN_TRACE_COUNT(Files, 1);
+					}
+				}
+
+				// Keeps draining after a failure, the renderer would wait on a full queue otherwise
+				of << file.text;
+				written = written && !of.fail();
+				DVALVEGEN_TRACE_COUNT(BytesEmitted, file.text.size());
+
+				// Don't hold on to the buffer until the next file arrives
+				file.text = std::string{};
+			}
+
+			if (of.is_open()) {
+				of.close();
+				written = written && !of.fail();
+			}
+		} };
+
+		struct WriterJoin {
+			/// Lets the writer finish and joins it however rendering ends, a joinable thread going out of scope terminates
+			std::thread& writer;
+			std::atomic<bool>& rendered;
+			std::function<void()> notify;
+
+			~WriterJoin() {
+				rendered.store(true, std::memory_order_release);
+				notify();
+				writer.join();
+			}
+		};
+
+		{
+			WriterJoin join{ writer, rendered, notify };
+
+			renderClasses([&queue, &mutex, &changed, &notify](std::string& name, std::string& text) {
+				SdkFile file{ std::move(name), std::move(text) };
+
+				// Full, the writer is behind
+				while (!queue.push(std::move(file))) {
+					std::unique_lock<std::mutex> lock{ mutex };
+					changed.wait(lock, [&queue] {
+						return queue.size() < queue.capacity();
+					});
+				}
+
+				notify();
+			}, bake, nullptr, tables);
+		}
+
+		return written;
 	}
 }
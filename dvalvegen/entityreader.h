@@ -0,0 +1,221 @@
+#pragma once
+
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+
+#include "dvalvegen.h"
+#include "remote.h"
+
+namespace dvalvegen {
+	struct EntityReadRange {
+		int offset;		// In the entity
+		int size;
+		int staging;	// Where it lands in the entity's slice of the staging buffer
+	};
+
+	struct EntityReadField {
+		uint column;
+		int staging;
+		int size;
+	};
+
+	struct EntityReadPlan {
+		/// Merged byte ranges that cover the selected fields of one class
+		std::vector<EntityReadRange> ranges;
+		std::vector<EntityReadField> fields;
+		int bytes;		// Total size of all ranges
+	};
+
+	class EntityReader {
+		/// Reads a fixed set of fields from many entities of another process with as few reads as possible
+		/// Ranges of the selected fields are merged per class, every entity of a tick goes out in one scatter read,
+		/// and the results are copied into one column per field (structure of arrays)
+	public:
+		EntityReader(MemoryReader& reader) : m_reader(reader) {
+
+		}
+
+		void setFields(const std::vector<uint>& ids, int maxgap = 32) {
+			/// ids are field IDs (ClassProp::id()), fields that are nested classes are ignored
+			/// Ranges closer than maxgap bytes are read as one
+			m_ids = ids;
+			m_maxgap = maxgap;
+			m_columnof.clear();
+			m_widths.clear();
+			m_plans.clear();
+
+			for (uint i = 0; i < ids.size(); i++) {
+				m_columnof.emplace(ids[i], i);
+				m_widths.push_back(ids[i] < g_Fields.size() ? getPropSize(g_Fields[ids[i]]->prop()) : 0);
+			}
+
+			m_columns.assign(ids.size(), {});
+		}
+
+		const EntityReadPlan& plan(Class& cls) {
+			auto it = m_plans.find(&cls);
+			if (it != m_plans.end()) {
+				return it->second;
+			}
+
+			EntityReadPlan& plan = m_plans[&cls];
+			plan.bytes = 0;
+
+			std::vector<char> taken(m_ids.size(), 0);
+			for (auto& f : cls.getFlatFields()) {
+				auto cit = m_columnof.find(f.prop->id());
+				if (cit == m_columnof.end() || taken[cit->second] || f.size <= 0) {
+					continue;
+				}
+
+				taken[cit->second] = 1;
+
+				// Flat fields come sorted by offset, so only the last range can be extended
+				if (!plan.ranges.empty() && f.offset <= plan.ranges.back().offset + plan.ranges.back().size + m_maxgap) {
+					EntityReadRange& r = plan.ranges.back();
+					int end = std::max(r.offset + r.size, f.offset + f.size);
+					plan.bytes += end - (r.offset + r.size);
+					r.size = end - r.offset;
+				}
+				else {
+					plan.ranges.push_back({ f.offset, f.size, plan.bytes });
+					plan.bytes += f.size;
+				}
+
+				EntityReadRange& r = plan.ranges.back();
+				plan.fields.push_back({ cit->second, r.staging + (f.offset - r.offset), std::min(f.size, m_widths[cit->second]) });
+			}
+
+			return plan;
+		}
+
+		void clear() {
+			m_entities.clear();
+		}
+
+		void add(std::uintptr_t address, Class& cls) {
+			m_entities.push_back({ address, &plan(cls), 0, false });
+		}
+
+		bool read() {
+			/// Reads every entity added since clear(), returns false if any of them couldn't be read
+			std::uint64_t calls = m_reader.numCalls();
+
+			int total = 0;
+			for (auto& e : m_entities) {
+				e.staging = total;
+				total += e.plan->bytes;
+			}
+
+			m_staging.resize(total);
+			m_reads.clear();
+
+			for (auto& e : m_entities) {
+				for (auto& r : e.plan->ranges) {
+					m_reads.push_back({ e.address + r.offset, m_staging.data() + e.staging + r.staging, (std::size_t)r.size });
+				}
+			}
+
+			bool ok = m_reader.readv(m_reads.data(), (uint)m_reads.size());
+
+			if (ok) {
+				for (auto& e : m_entities) {
+					e.valid = true;
+				}
+			}
+			else {
+				// One dead entity fails the whole batch, retry them one by one so the rest still comes through
+				std::size_t first = 0;
+				for (auto& e : m_entities) {
+					std::size_t n = e.plan->ranges.size();
+					e.valid = n == 0 || m_reader.readv(m_reads.data() + first, (uint)n);
+					first += n;
+				}
+			}
+
+			decode();
+
+			m_lastcalls = m_reader.numCalls() - calls;
+			return ok;
+		}
+
+		template<typename T>
+		const T* column(uint id) const {
+			/// Values of field id for every entity, in the order they were added, zeroed where the entity doesn't have it
+			auto it = m_columnof.find(id);
+			return it == m_columnof.end() ? nullptr : (const T*)m_columns[it->second].data();
+		}
+
+		const std::uint8_t* get(uint id, uint entity) const {
+			auto it = m_columnof.find(id);
+			if (it == m_columnof.end() || entity >= m_entities.size()) {
+				return nullptr;
+			}
+
+			return m_columns[it->second].data() + (std::size_t)entity * m_widths[it->second];
+		}
+
+		bool valid(uint entity) const {
+			return entity < m_entities.size() && m_entities[entity].valid;
+		}
+
+		uint numEntities() const {
+			return (uint)m_entities.size();
+		}
+
+		std::uint64_t lastCalls() const {
+			/// Reads that went to the OS during the last read()
+			return m_lastcalls;
+		}
+
+		std::size_t lastBytes() const {
+			return m_staging.size();
+		}
+
+		std::size_t lastRanges() const {
+			return m_reads.size();
+		}
+
+	private:
+		struct Entity {
+			std::uintptr_t address;
+			const EntityReadPlan* plan;
+			int staging;
+			bool valid;
+		};
+
+		void decode() {
+			for (uint c = 0; c < m_columns.size(); c++) {
+				m_columns[c].assign(m_entities.size() * (std::size_t)m_widths[c], 0);
+			}
+
+			for (uint i = 0; i < m_entities.size(); i++) {
+				const Entity& e = m_entities[i];
+				if (!e.valid) {
+					continue;
+				}
+
+				const std::uint8_t* src = m_staging.data() + e.staging;
+				for (auto& f : e.plan->fields) {
+					std::memcpy(m_columns[f.column].data() + (std::size_t)i * m_widths[f.column], src + f.staging, f.size);
+				}
+			}
+		}
+
+		MemoryReader& m_reader;
+		std::vector<uint> m_ids;
+		int m_maxgap = 32;
+		std::unordered_map<uint, uint> m_columnof;
+		std::vector<int> m_widths;
+		std::vector<std::vector<std::uint8_t>> m_columns;
+		std::unordered_map<Class*, EntityReadPlan> m_plans;
+
+		std::vector<Entity> m_entities;
+		std::vector<std::uint8_t> m_staging;
+		std::vector<RemoteRead> m_reads;
+		std::uint64_t m_lastcalls = 0;
+	};
+}
@@ -0,0 +1,253 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "dvalvegen.h"
+#include "dump.h"
+
+namespace dvalvegen {
+	// Structural diff of two class graphs, e.g. the build before and after a patch
+	// Both sides can be live lists or graphs loaded with loadSnapshot
+	// Tables are compared top-down from the classes, a table whose fingerprintTable hash matches on both sides
+	// is skipped with everything below it, so only the changed paths of the graph are ever looked at
+
+	struct GraphChange {
+		enum Kind {
+			ClassAdded,
+			ClassRemoved,
+			ClassIdChanged,		// before/after are the class IDs
+			ClassTableChanged,	// The class's recv table was replaced by one with another name, prop is the new name
+			PropAdded,
+			PropRemoved,
+			OffsetMoved,		// before/after are the offsets
+			TypeChanged,		// before/after are SendPropTypes
+			ElementsChanged,	// before/after are the element counts
+		};
+
+		Kind kind;
+		std::string owner;	// Network name for class changes, table name for prop changes
+		std::string prop;
+		std::int64_t before = 0;
+		std::int64_t after = 0;
+	};
+
+	struct GraphDiff {
+		std::vector<GraphChange> changes;
+		std::vector<std::string> dirtytables;	// Tables of the new graph whose own props changed, in the order they were found
+		bool layoutchanged = false;				// Props, tables or classes were added or removed, field IDs of a new SDK won't line up
+		uint tablescompared = 0;
+		uint tablesskipped = 0;					// Identical by hash, nothing below them was visited
+
+		bool empty() const {
+			return changes.empty();
+		}
+	};
+
+	class GraphDiffer {
+	public:
+		GraphDiff diff(ClientClass* before, ClientClass* after) {
+			DVALVEGEN_TRACE_SCOPE("diffGraphs");
+			m_result = {};
+			m_before.clear();
+			m_after.clear();
+			m_visited.clear();
+
+			std::unordered_map<std::string, ClientClass*> old;
+			for (ClientClass* c = before; c; c = c->m_pNext) {
+				old.emplace(name(c->m_pNetworkName), c);
+			}
+
+			for (ClientClass* c = after; c; c = c->m_pNext) {
+				auto it = old.find(name(c->m_pNetworkName));
+				if (it == old.end()) {
+					change(GraphChange::ClassAdded, name(c->m_pNetworkName), "", 0, c->m_ClassID);
+					m_result.layoutchanged = true;
+					continue;
+				}
+
+				ClientClass* o = it->second;
+				old.erase(it);
+
+				if (o->m_ClassID != c->m_ClassID) {
+					change(GraphChange::ClassIdChanged, name(c->m_pNetworkName), "", o->m_ClassID, c->m_ClassID);
+				}
+
+				if (!o->m_pRecvTable || !c->m_pRecvTable) {
+					if (o->m_pRecvTable != c->m_pRecvTable) {
+						change(GraphChange::ClassTableChanged, name(c->m_pNetworkName), c->m_pRecvTable ? name(c->m_pRecvTable->m_pNetTableName) : "", 0, 0);
+						m_result.layoutchanged = true;
+					}
+				}
+				else if (std::strcmp(name(o->m_pRecvTable->m_pNetTableName), name(c->m_pRecvTable->m_pNetTableName))) {
+					change(GraphChange::ClassTableChanged, name(c->m_pNetworkName), name(c->m_pRecvTable->m_pNetTableName), 0, 0);
+					m_result.layoutchanged = true;
+				}
+				else {
+					compareTable(o->m_pRecvTable, c->m_pRecvTable);
+				}
+			}
+
+			// Whatever wasn't matched is gone, in the order of the old list
+			for (ClientClass* c = before; c; c = c->m_pNext) {
+				if (old.count(name(c->m_pNetworkName))) {
+					change(GraphChange::ClassRemoved, name(c->m_pNetworkName), "", c->m_ClassID, 0);
+					m_result.layoutchanged = true;
+				}
+			}
+
+			return std::move(m_result);
+		}
+
+	private:
+		static const char* name(const char* s) {
+			return s ? s : "Unknown";
+		}
+
+		void change(GraphChange::Kind kind, const char* owner, const char* prop, std::int64_t before, std::int64_t after) {
+			m_result.changes.push_back({ kind, owner, prop, before, after });
+		}
+
+		void compareTable(RecvTable* a, RecvTable* b) {
+			// Shared tables, e.g. a base class, are reached once per class using them
+			if (!m_visited.insert(b).second) {
+				return;
+			}
+
+			if (fingerprintTable(a, m_before) == fingerprintTable(b, m_after)) {
+				m_result.tablesskipped++;
+				return;
+			}
+
+			m_result.tablescompared++;
+			const char* table = name(b->m_pNetTableName);
+			bool dirty = false;
+
+			for (int i = 0; i < b->m_nProps; i++) {
+				RecvProp* pb = &b->m_pProps[i];
+				RecvProp* pa = findProp(a, pb->m_pVarName, i);
+
+				if (!pa) {
+					change(GraphChange::PropAdded, table, name(pb->m_pVarName), 0, pb->GetOffset());
+					m_result.layoutchanged = dirty = true;
+					continue;
+				}
+
+				if (pa->GetOffset() != pb->GetOffset()) {
+					change(GraphChange::OffsetMoved, table, name(pb->m_pVarName), pa->GetOffset(), pb->GetOffset());
+					dirty = true;
+				}
+
+				if (pa->GetType() != pb->GetType()) {
+					change(GraphChange::TypeChanged, table, name(pb->m_pVarName), pa->GetType(), pb->GetType());
+					dirty = true;
+				}
+				else if (pa->GetNumElements() != pb->GetNumElements()) {
+					change(GraphChange::ElementsChanged, table, name(pb->m_pVarName), pa->GetNumElements(), pb->GetNumElements());
+					dirty = true;
+				}
+				else if (pa->GetDataTable() && pb->GetDataTable()) {
+					if (std::strcmp(name(pa->GetDataTable()->m_pNetTableName), name(pb->GetDataTable()->m_pNetTableName))) {
+						// Points at another table now, reported as the old prop gone and a new one in its place
+						change(GraphChange::PropRemoved, table, name(pa->m_pVarName), pa->GetOffset(), 0);
+						change(GraphChange::PropAdded, table, name(pb->m_pVarName), 0, pb->GetOffset());
+						m_result.layoutchanged = dirty = true;
+					}
+					else {
+						compareTable(pa->GetDataTable(), pb->GetDataTable());
+					}
+				}
+			}
+
+			for (int i = 0; i < a->m_nProps; i++) {
+				RecvProp* pa = &a->m_pProps[i];
+				if (!findProp(b, pa->m_pVarName, i)) {
+					change(GraphChange::PropRemoved, table, name(pa->m_pVarName), pa->GetOffset(), 0);
+					m_result.layoutchanged = dirty = true;
+				}
+			}
+
+			if (dirty) {
+				m_result.dirtytables.push_back(table);
+			}
+		}
+
+		static RecvProp* findProp(RecvTable* table, const char* propname, int hint) {
+			/// Props mostly keep their index between builds, that one is tried first
+			propname = name(propname);
+
+			if (hint < table->m_nProps && !std::strcmp(name(table->m_pProps[hint].m_pVarName), propname)) {
+				return &table->m_pProps[hint];
+			}
+
+			for (int i = 0; i < table->m_nProps; i++) {
+				if (!std::strcmp(name(table->m_pProps[i].m_pVarName), propname)) {
+					return &table->m_pProps[i];
+				}
+			}
+
+			return nullptr;
+		}
+
+		GraphDiff m_result;
+		std::unordered_map<RecvTable*, std::uint64_t> m_before;	// fingerprintTable memos, every table is hashed once
+		std::unordered_map<RecvTable*, std::uint64_t> m_after;
+		std::unordered_set<RecvTable*> m_visited;
+	};
+
+	GraphDiff diffGraphs(ClientClass* before, ClientClass* after) {
+		return GraphDiffer{}.diff(before, after);
+	}
+
+	bool regenerationFilter(const GraphDiff& diff, std::unordered_set<std::string>& tables) {
+		/// Tables whose class headers printClasses has to write again after the change
+		/// False if the layout changed, field IDs shift then and every header has to be regenerated
+		tables.clear();
+		if (diff.layoutchanged) {
+			return false;
+		}
+
+		tables.insert(diff.dirtytables.begin(), diff.dirtytables.end());
+		return true;
+	}
+
+	void printGraphDiff(const GraphDiff& diff, std::ostream& stream) {
+		/// One line per change, + added, - removed, ~ changed
+		for (auto& c : diff.changes) {
+			switch (c.kind) {
+			case GraphChange::ClassAdded:
+				stream << "+ class " << c.owner << " " << c.after << "\n";
+				break;
+			case GraphChange::ClassRemoved:
+				stream << "- class " << c.owner << " " << c.before << "\n";
+				break;
+			case GraphChange::ClassIdChanged:
+				stream << "~ class " << c.owner << " id " << c.before << " -> " << c.after << "\n";
+				break;
+			case GraphChange::ClassTableChanged:
+				stream << "~ class " << c.owner << " table -> " << c.prop << "\n";
+				break;
+			case GraphChange::PropAdded:
+				stream << "+ " << c.owner << "." << c.prop << " 0x" << std::hex << c.after << std::dec << "\n";
+				break;
+			case GraphChange::PropRemoved:
+				stream << "- " << c.owner << "." << c.prop << " 0x" << std::hex << c.before << std::dec << "\n";
+				break;
+			case GraphChange::OffsetMoved:
+				stream << "~ " << c.owner << "." << c.prop << " 0x" << std::hex << c.before << " -> 0x" << c.after << std::dec << "\n";
+				break;
+			case GraphChange::TypeChanged:
+				stream << "~ " << c.owner << "." << c.prop << " " << propTypeName((SendPropType)c.before) << " -> " << propTypeName((SendPropType)c.after) << "\n";
+				break;
+			case GraphChange::ElementsChanged:
+				stream << "~ " << c.owner << "." << c.prop << " [" << c.before << "] -> [" << c.after << "]\n";
+				break;
+			}
+		}
+	}
+}
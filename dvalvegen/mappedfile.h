@@ -0,0 +1,137 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+namespace dvalvegen {
+	class MappedFile {
+		/// Read-only memory mapping of a whole file
+	public:
+		MappedFile() {
+
+		}
+
+		MappedFile(const std::string& path) {
+			open(path);
+		}
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		~MappedFile() {
+			close();
+		}
+
+		bool open(const std::string& path) {
+			close();
+
+#ifdef _WIN32
+			m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+			if (m_file == INVALID_HANDLE_VALUE) {
+				return false;
+			}
+
+			LARGE_INTEGER size;
+			if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+				close();
+				return false;
+			}
+
+			m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (!m_mapping) {
+				close();
+				return false;
+			}
+
+			m_data = (const std::uint8_t*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+			m_size = (std::size_t)size.QuadPart;
+#else
+			m_fd = ::open(path.c_str(), O_RDONLY);
+			if (m_fd < 0) {
+				return false;
+			}
+
+			struct stat st;
+			if (fstat(m_fd, &st) != 0 || st.st_size == 0) {
+				close();
+				return false;
+			}
+
+			void* data = mmap(nullptr, (std::size_t)st.st_size, PROT_READ, MAP_PRIVATE, m_fd, 0);
+			m_data = data == MAP_FAILED ? nullptr : (const std::uint8_t*)data;
+			m_size = (std::size_t)st.st_size;
+#endif
+
+			if (!m_data) {
+				close();
+				return false;
+			}
+
+			return true;
+		}
+
+		void close() {
+#ifdef _WIN32
+			if (m_data) {
+				UnmapViewOfFile(m_data);
+			}
+
+			if (m_mapping) {
+				CloseHandle(m_mapping);
+			}
+
+			if (m_file != INVALID_HANDLE_VALUE) {
+				CloseHandle(m_file);
+			}
+
+			m_mapping = NULL;
+			m_file = INVALID_HANDLE_VALUE;
+#else
+			if (m_data) {
+				munmap((void*)m_data, m_size);
+			}
+
+			if (m_fd >= 0) {
+				::close(m_fd);
+			}
+
+			m_fd = -1;
+#endif
+			m_data = nullptr;
+			m_size = 0;
+		}
+
+		const std::uint8_t* data() const {
+			return m_data;
+		}
+
+		std::size_t size() const {
+			return m_size;
+		}
+
+		bool isOpen() const {
+			return m_data != nullptr;
+		}
+
+	private:
+		const std::uint8_t* m_data = nullptr;
+		std::size_t m_size = 0;
+
+#ifdef _WIN32
+		HANDLE m_file = INVALID_HANDLE_VALUE;
+		HANDLE m_mapping = NULL;
+#else
+		int m_fd = -1;
+#endif
+	};
+}
@@ -0,0 +1,250 @@
+#pragma once
+
+// Accounting of the generator's own memory: the class model and the output buffers allocate through
+// one counting std::pmr resource per tag, memory::report() lists what each one holds now and at most
+// With a budget set, an allocation that would go over it throws std::bad_alloc instead of being made
+
+#include <memory_resource>
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <sstream>
+#include <ostream>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace dvalvegen {
+	namespace memory {
+		enum Tag {
+			Names,		// Table, class and prop names kept by the model
+			Props,		// ClassProps and the field table
+			Classes,	// Classes, their base class lists and the walked tables
+			Output,		// Text buffers while the SDK is rendered
+			NumTags
+		};
+
+		inline const char* tagName(int tag) {
+			static const char* names[NumTags] = { "names", "props", "classes", "output" };
+			return names[tag];
+		}
+
+		struct Stats {
+			std::uint64_t current;
+			std::uint64_t peak;
+			std::uint64_t allocations;
+		};
+
+		std::atomic<std::uint64_t> g_Budget{ 0 }; // Bytes over all tags, 0 for none
+		std::atomic<std::uint64_t> g_Total{ 0 };
+		std::atomic<std::uint64_t> g_TotalPeak{ 0 };
+
+		inline void raisePeak(std::atomic<std::uint64_t>& peak, std::uint64_t value) {
+			std::uint64_t p = peak.load(std::memory_order_relaxed);
+			while (value > p && !peak.compare_exchange_weak(p, value, std::memory_order_relaxed));
+		}
+
+		class CountingResource : public std::pmr::memory_resource {
+			/// Forwards to upstream and counts what's outstanding, the budget is checked against the total of all tags
+		public:
+			CountingResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource()) {
+				m_upstream = upstream;
+			}
+
+			Stats stats() const {
+				return { m_current.load(std::memory_order_relaxed), m_peak.load(std::memory_order_relaxed), m_allocations.load(std::memory_order_relaxed) };
+			}
+
+			void resetPeak() {
+				m_peak.store(m_current.load(std::memory_order_relaxed), std::memory_order_relaxed);
+				m_allocations.store(0, std::memory_order_relaxed);
+			}
+
+		private:
+			void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+				std::uint64_t total = g_Total.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+				std::uint64_t budget = g_Budget.load(std::memory_order_relaxed);
+
+				if (budget && total > budget) {
+					g_Total.fetch_sub(bytes, std::memory_order_relaxed);
+					throw std::bad_alloc{};
+				}
+
+				void* p;
+				try {
+					p = m_upstream->allocate(bytes, alignment);
+				}
+				catch (...) {
+					g_Total.fetch_sub(bytes, std::memory_order_relaxed);
+					throw;
+				}
+
+				raisePeak(g_TotalPeak, total);
+				raisePeak(m_peak, m_current.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+				m_allocations.fetch_add(1, std::memory_order_relaxed);
+				return p;
+			}
+
+			void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+				m_upstream->deallocate(p, bytes, alignment);
+				m_current.fetch_sub(bytes, std::memory_order_relaxed);
+				g_Total.fetch_sub(bytes, std::memory_order_relaxed);
+			}
+
+			bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+				return this == &other;
+			}
+
+			std::pmr::memory_resource* m_upstream;
+			std::atomic<std::uint64_t> m_current{ 0 };
+			std::atomic<std::uint64_t> m_peak{ 0 };
+			std::atomic<std::uint64_t> m_allocations{ 0 };
+		};
+
+		CountingResource g_Resources[NumTags];
+
+		inline std::pmr::memory_resource* resource(Tag tag) {
+			return &g_Resources[tag];
+		}
+
+		template<typename T, Tag tag>
+		class Allocator {
+			/// Always allocates from the tag's resource, unlike polymorphic_allocator a copy of a container keeps it
+		public:
+			using value_type = T;
+
+			template<typename U>
+			struct rebind {
+				using other = Allocator<U, tag>;
+			};
+
+			Allocator() noexcept {
+
+			}
+
+			template<typename U>
+			Allocator(const Allocator<U, tag>&) noexcept {
+
+			}
+
+			T* allocate(std::size_t n) {
+				return (T*)g_Resources[tag].allocate(n * sizeof(T), alignof(T));
+			}
+
+			void deallocate(T* p, std::size_t n) noexcept {
+				g_Resources[tag].deallocate(p, n * sizeof(T), alignof(T));
+			}
+
+			template<typename U>
+			bool operator==(const Allocator<U, tag>&) const noexcept {
+				return true;
+			}
+
+			template<typename U>
+			bool operator!=(const Allocator<U, tag>&) const noexcept {
+				return false;
+			}
+		};
+
+		template<Tag tag>
+		class String : public std::basic_string<char, std::char_traits<char>, Allocator<char, tag>> {
+			/// Converts to and from std::string, so model names can be looked up and handed out as before
+			using Base = std::basic_string<char, std::char_traits<char>, Allocator<char, tag>>;
+
+		public:
+			using Base::Base;
+
+			String() {
+
+			}
+
+			String(const Base& s) : Base(s) {
+
+			}
+
+			String(const std::string& s) : Base(s.data(), s.size()) {
+
+			}
+
+			operator std::string() const {
+				return std::string(this->data(), this->size());
+			}
+
+			std::string str() const {
+				return *this;
+			}
+		};
+
+		struct StringHash {
+			template<Tag tag>
+			std::size_t operator()(const String<tag>& s) const {
+				return std::hash<std::string_view>{}(std::string_view{ s.data(), s.size() });
+			}
+		};
+
+		template<typename T, Tag tag>
+		using Vector = std::vector<T, Allocator<T, tag>>;
+
+		template<typename K, typename V, Tag tag>
+		using Map = std::unordered_map<K, V, StringHash, std::equal_to<K>, Allocator<std::pair<const K, V>, tag>>;
+
+		template<typename T, Tag tag>
+		using Set = std::unordered_set<T, std::hash<T>, std::equal_to<T>, Allocator<T, tag>>;
+
+		template<Tag tag>
+		class OStream : public std::basic_ostringstream<char, std::char_traits<char>, Allocator<char, tag>> {
+			/// Streams catch what their buffer throws and only set badbit, this one rethrows
+			/// Otherwise running out of budget would quietly cut the text short instead of failing
+		public:
+			OStream() {
+				this->exceptions(std::ios::badbit);
+			}
+		};
+
+		void setBudget(std::uint64_t bytes) {
+			/// Applies to allocations from now on, what's already allocated stays
+			g_Budget.store(bytes, std::memory_order_relaxed);
+		}
+
+		Stats stats(Tag tag) {
+			return g_Resources[tag].stats();
+		}
+
+		Stats total() {
+			std::uint64_t allocations = 0;
+			for (auto& r : g_Resources) {
+				allocations += r.stats().allocations;
+			}
+
+			return { g_Total.load(std::memory_order_relaxed), g_TotalPeak.load(std::memory_order_relaxed), allocations };
+		}
+
+		void resetPeaks() {
+			for (auto& r : g_Resources) {
+				r.resetPeak();
+			}
+
+			g_TotalPeak.store(g_Total.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		}
+
+		void report(std::ostream& stream) {
+			/// Current and peak bytes and the number of allocations per tag, one line each
+			auto line = [&stream](const char* name, const Stats& s) {
+				stream << name << "\tcurrent " << s.current << "\tpeak " << s.peak << "\tallocations " << s.allocations << "\n";
+			};
+
+			for (int i = 0; i < NumTags; i++) {
+				line(tagName(i), g_Resources[i].stats());
+			}
+
+			line("total", total());
+
+			if (g_Budget.load(std::memory_order_relaxed)) {
+				stream << "budget\t" << g_Budget.load(std::memory_order_relaxed) << "\n";
+			}
+		}
+	}
+}
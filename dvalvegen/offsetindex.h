@@ -0,0 +1,225 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+
+#include "dvalvegen.h"
+
+namespace dvalvegen {
+	struct OffsetEntry {
+		int start;
+		int end;			// One past the last byte
+		ClassProp* prop;
+		std::string path;	// e.g. m_Collision.m_vecMins, base classes don't add anything to it
+	};
+
+	struct OffsetHit {
+		const OffsetEntry* entry;	// nullptr if nothing is at or before the offset
+		int delta;					// How far into (or past, if outside) the entry the offset is
+		bool inside;
+	};
+
+	class OffsetIndex {
+		/// Sorted intervals of all leaf fields of one class, answers "what lives at offset x" in O(log n)
+		/// Building is O(n log n), however many fields share an offset
+	public:
+		OffsetIndex() {
+
+		}
+
+		OffsetIndex(Class& cls) {
+			build(cls);
+		}
+
+		void build(Class& cls) {
+			m_entries.clear();
+			walk(cls, 0, "");
+
+			std::stable_sort(m_entries.begin(), m_entries.end(), [](const OffsetEntry& a, const OffsetEntry& b) {
+				return a.start < b.start;
+			});
+
+			// Same clamping as Class::getFlatFields, ints don't really know how wide they are
+			// Every entry ends at the next greater start at the latest, walking backwards keeps that start at hand
+			int next = 0;
+			bool hasnext = false;
+			for (std::size_t i = m_entries.size(); i-- > 0;) {
+				if (i + 1 < m_entries.size() && m_entries[i + 1].start > m_entries[i].start) {
+					next = m_entries[i + 1].start;
+					hasnext = true;
+				}
+
+				if (hasnext) {
+					m_entries[i].end = std::min(m_entries[i].end, next);
+				}
+			}
+
+			// After the clamp only entries with the same start overlap, and they nest by their end
+			// Ordered by end within such a group, the innermost one containing an offset is found by binary search
+			m_groupfirst.resize(m_entries.size());
+			for (std::size_t i = 0, first = 0; i < m_entries.size(); i++) {
+				if (m_entries[i].start != m_entries[first].start) {
+					std::stable_sort(m_entries.begin() + first, m_entries.begin() + i, endLess);
+					first = i;
+				}
+
+				m_groupfirst[i] = first;
+
+				if (i + 1 == m_entries.size()) {
+					std::stable_sort(m_entries.begin() + first, m_entries.end(), endLess);
+				}
+			}
+		}
+
+		OffsetHit find(int offset) const {
+			/// Innermost field containing offset, or the closest one before it
+			return hitAt(offset, upperBound(offset));
+		}
+
+		void findRange(int start, int end, std::vector<const OffsetEntry*>& out) const {
+			/// All fields overlapping [start, end), in offset order
+			/// Groups starting before the one at start end before it, so the scan begins there
+			std::size_t hi = upperBound(end - 1);
+			std::size_t at = upperBound(start);
+			std::size_t first = at > 0 ? m_groupfirst[at - 1] : 0;
+
+			for (std::size_t i = first; i < hi; i++) {
+				if (m_entries[i].end > start) {
+					out.push_back(&m_entries[i]);
+				}
+			}
+		}
+
+		void findMany(const int* offsets, uint count, OffsetHit* out) const {
+			/// Batched find, sorts the queries so the table is swept once instead of searched per query
+			std::vector<uint> order(count);
+			for (uint i = 0; i < count; i++) {
+				order[i] = i;
+			}
+
+			std::sort(order.begin(), order.end(), [offsets](uint a, uint b) {
+				return offsets[a] < offsets[b];
+			});
+
+			std::size_t hi = 0;
+			for (uint q : order) {
+				int offset = offsets[q];
+				while (hi < m_entries.size() && m_entries[hi].start <= offset) {
+					hi++;
+				}
+
+				out[q] = hitAt(offset, hi);
+			}
+		}
+
+		OffsetHit findAddress(const void* entity, const void* address) const {
+			return find((int)((std::intptr_t)address - (std::intptr_t)entity));
+		}
+
+		const std::vector<OffsetEntry>& entries() const {
+			return m_entries;
+		}
+
+	private:
+		static bool endLess(const OffsetEntry& a, const OffsetEntry& b) {
+			return a.end < b.end;
+		}
+
+		OffsetHit hitAt(int offset, std::size_t hi) const {
+			/// hi is the first entry starting after offset, only the group just before it can contain offset
+			if (hi == 0) {
+				return { nullptr, 0, false };
+			}
+
+			auto first = m_entries.begin() + m_groupfirst[hi - 1];
+			auto last = m_entries.begin() + hi;
+
+			// Narrowest entry still reaching past offset, the last one of several that are equally wide
+			auto it = std::upper_bound(first, last, offset, [](int o, const OffsetEntry& e) {
+				return o < e.end;
+			});
+
+			if (it != last) {
+				int end = it->end;
+				it = std::upper_bound(it, last, end, [](int o, const OffsetEntry& e) {
+					return o < e.end;
+				}) - 1;
+
+				return { &*it, offset - it->start, true };
+			}
+
+			return { &m_entries[hi - 1], offset - m_entries[hi - 1].start, false };
+		}
+
+		std::size_t upperBound(int offset) const {
+			/// First entry starting after offset
+			return std::upper_bound(m_entries.begin(), m_entries.end(), offset, [](int o, const OffsetEntry& e) {
+				return o < e.start;
+			}) - m_entries.begin();
+		}
+
+		void walk(Class& cls, int base, const std::string& prefix) {
+			for (auto& bc : cls.baseclasses()) {
+				walk(g_Classes[bc], base, prefix);
+			}
+
+			for (auto& p : cls.props()) {
+				RecvProp* prop = p.second.prop();
+				int offset = base + prop->GetOffset();
+
+				if (prop->GetType() == DPT_DataTable && g_Classes.count(prop->GetDataTable()->GetName()) != 0) {
+					walk(g_Classes[prop->GetDataTable()->GetName()], offset, prefix + p.first.str() + ".");
+				}
+				else {
+					m_entries.push_back({ offset, offset + getPropSize(prop), &p.second, prefix + p.first.str() });
+				}
+			}
+		}
+
+		std::vector<OffsetEntry> m_entries;
+		std::vector<std::size_t> m_groupfirst;	// Index of the first entry with the same start
+	};
+
+	class OffsetIndexSet {
+		/// One OffsetIndex per class, built lazily, looked up by table name or network name
+	public:
+		void setClasses(ClientClass* head) {
+			m_networknames.clear();
+			for (; head; head = head->m_pNext) {
+				if (head->m_pRecvTable) {
+					m_networknames[head->m_pNetworkName] = head->m_pRecvTable->GetName();
+				}
+			}
+		}
+
+		OffsetIndex* get(const std::string& name) {
+			/// name can be a table name (DT_BasePlayer) or a network name (CBasePlayer)
+			auto nit = m_networknames.find(name);
+			const std::string& table = nit == m_networknames.end() ? name : nit->second;
+
+			auto it = m_indices.find(table);
+			if (it == m_indices.end()) {
+				auto cit = g_Classes.find(table);
+				if (cit == g_Classes.end()) {
+					return nullptr;
+				}
+
+				it = m_indices.try_emplace(table, cit->second).first;
+			}
+
+			return &it->second;
+		}
+
+		OffsetHit find(const std::string& name, int offset) {
+			OffsetIndex* index = get(name);
+			return index ? index->find(offset) : OffsetHit{ nullptr, 0, false };
+		}
+
+	private:
+		std::unordered_map<std::string, std::string> m_networknames;
+		std::unordered_map<std::string, OffsetIndex> m_indices;
+	};
+}
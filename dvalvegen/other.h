@@ -2,14 +2,13 @@
 
 #include <windows.h>
 #include "dvalvegen.h"
+#include "scanner.h"
 
 template <typename Type>
 inline Type call_vfunc(void* thisPtr, int index)
 {
-	DWORD* ClassBase = (DWORD*)thisPtr;
-	DWORD* VMT = *(DWORD**)ClassBase;
-	DWORD FnAddress = VMT[index];
-	return (Type)FnAddress;
+	void** VMT = *(void***)thisPtr;
+	return (Type)VMT[index];
 }
 
 typedef void* (*CreateInterfaceFn)(const char* pName, int* pReturnCode);
@@ -30,6 +29,29 @@ T* captureInterface(HMODULE hmodule, std::string interfacename) {
 		return (T*)factory(interfacename.c_str(), 0);
 	}
 
+	// The versioned name is somewhere in the module's strings, look for "<name>###\0" first
+	const std::uint8_t* base;
+	std::size_t size;
+
+	if (dvalvegen::moduleImage(hmodule, base, size)) {
+		std::string bytes = interfacename + "000";
+		bytes.push_back('\0');
+		std::string mask = std::string(interfacename.size(), 'x') + "???x";
+
+		for (std::size_t hit : dvalvegen::g_ScanCache.find(base, size, dvalvegen::BytePattern::fromBytes(bytes.data(), mask.c_str()))) {
+			const char* name = (const char*)base + hit;
+			const char* version = name + interfacename.size();
+
+			if (isdigit(version[0]) && isdigit(version[1]) && isdigit(version[2])) {
+				void* r = factory(name, 0);
+
+				if (r) {
+					return (T*)r;
+				}
+			}
+		}
+	}
+
 	std::string stry;
 	int itry = 100;
 	char cbuf[4] = "000";
@@ -54,6 +76,9 @@ public:
 	dvalvegen::ClientClass* GetAllClasses() {
 		// https://www.unknowncheats.me/forum/1522872-post33.html
 
+		// mov eax, [g_pClientClassHead]; ret
+		static const dvalvegen::BytePattern getter{ "A1 ?? ?? ?? ?? C3" };
+
 		int idx = -1;
 
 		std::uint8_t** vtable = *(std::uint8_t***)this;
@@ -62,7 +87,7 @@ public:
 			
 			std::uint8_t* func = vtable[i];
 
-			if (func[0] == 0xA1 && func[5] == 0xC3) {
+			if (getter.match(func)) {
 				idx = i;
 				break;
 			}
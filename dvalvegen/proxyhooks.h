@@ -0,0 +1,248 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <utility>
+#include <array>
+
+#include "dvalvegen.h"
+#include "ring.h"
+
+namespace dvalvegen {
+	struct ProxyEvent {
+		std::int32_t objectID;
+		std::uint32_t fieldID;
+		std::int32_t element;
+		std::int32_t type;		// SendPropType of the received value
+		union {
+			float m_Float;
+			std::int32_t m_Int;
+			std::int64_t m_Int64;
+			float m_Vector[3];
+		} value;				// Strings aren't copied, only their type is recorded
+	};
+
+	constexpr uint MaxProxyHooks = 1024;
+
+	struct ProxyHookSlot {
+		std::atomic<RecvVarProxyFn> original{ nullptr };
+		std::atomic<bool> active{ false };
+		uint fieldID = 0;
+		RecvProp* prop = nullptr;
+		bool released = false; // The prop has its original proxy back, nothing references the trampoline anymore
+	};
+
+	class ProxyRing {
+		/// Events produced by one thread, linked into g_ProxyRings when the thread first fires a hook
+	public:
+		ProxyRing(uint capacity) : ring{ capacity } {
+
+		}
+
+		SpscRing<ProxyEvent> ring;
+		std::atomic<std::uint64_t> dropped{ 0 };
+		ProxyRing* next = nullptr;
+	};
+
+	ProxyHookSlot g_ProxySlots[MaxProxyHooks];
+	std::atomic<uint> g_ProxySlotsUsed{ 0 };
+	std::atomic<ProxyRing*> g_ProxyRings{ nullptr };
+	std::atomic<uint> g_ProxyRingSize{ 4096 };
+	std::atomic<uint> g_ProxyRingGeneration{ 0 }; // Bumped by shutdownProxyHooks, threads then link a new ring
+	std::mutex g_ProxyHooksMutex; // Only taken when installing or removing hooks
+
+	ProxyRing* getThreadProxyRing() {
+		thread_local ProxyRing* ring = nullptr;
+		thread_local uint generation = 0;
+
+		uint current = g_ProxyRingGeneration.load(std::memory_order_acquire);
+		if (!ring || generation != current) {
+			generation = current;
+			ring = new ProxyRing{ g_ProxyRingSize.load(std::memory_order_relaxed) };
+			ring->next = g_ProxyRings.load(std::memory_order_relaxed);
+			while (!g_ProxyRings.compare_exchange_weak(ring->next, ring, std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		return ring;
+	}
+
+	template<uint N>
+	void proxyTrampoline(const CRecvProxyData* data, void* pstruct, void* pout) {
+		ProxyHookSlot& slot = g_ProxySlots[N];
+
+		RecvVarProxyFn original = slot.original.load(std::memory_order_acquire);
+		if (original) {
+			original(data, pstruct, pout);
+		}
+
+		if (!slot.active.load(std::memory_order_relaxed)) {
+			// Unhooked while someone else chained on top of us, just pass through
+			return;
+		}
+
+		ProxyEvent ev;
+		ev.objectID = data->m_ObjectID;
+		ev.fieldID = slot.fieldID;
+		ev.element = data->m_iElement;
+		ev.type = (std::int32_t)data->m_Value.m_Type;
+		std::memcpy(&ev.value, &data->m_Value, sizeof(ev.value));
+
+		ProxyRing* ring = getThreadProxyRing();
+		if (!ring->ring.push(ev)) {
+			ring->dropped.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	template<uint... N>
+	constexpr std::array<RecvVarProxyFn, sizeof...(N)> makeProxyTrampolines(std::integer_sequence<uint, N...>) {
+		return { &proxyTrampoline<N>... };
+	}
+
+	const std::array<RecvVarProxyFn, MaxProxyHooks> g_ProxyTrampolines = makeProxyTrampolines(std::make_integer_sequence<uint, MaxProxyHooks>{});
+
+	void setProxyRingSize(uint capacity) {
+		/// Only affects threads that haven't fired a hook yet
+		g_ProxyRingSize.store(capacity, std::memory_order_relaxed);
+	}
+
+	void releaseProxySlot(uint i) {
+		/// Takes an unhooked slot back once its trampoline is the prop's proxy again, i.e. whoever chained on top is gone
+		ProxyHookSlot& slot = g_ProxySlots[i];
+
+		if (slot.released || slot.active.load(std::memory_order_relaxed) || slot.prop->GetProxyFn() != g_ProxyTrampolines[i]) {
+			return;
+		}
+
+		slot.prop->SetProxyFn(slot.original.load(std::memory_order_relaxed));
+		slot.released = true;
+	}
+
+	bool hookProxy(ClassProp& cp) {
+		/// Chains a trampoline in front of the prop's current proxy
+		/// Slots of unhooked props are reused, a proxy call still inside the old trampoline at that moment could be
+		/// reported as the new field, so hook and unhook between ticks rather than while updates are received
+		std::lock_guard<std::mutex> lock{ g_ProxyHooksMutex };
+
+		RecvProp* prop = cp.prop();
+		uint used = g_ProxySlotsUsed.load(std::memory_order_relaxed);
+		uint free = used;
+
+		for (uint i = 0; i < used; i++) {
+			if (g_ProxySlots[i].prop == prop && g_ProxySlots[i].active.load(std::memory_order_relaxed)) {
+				// Already hooked
+				return true;
+			}
+
+			releaseProxySlot(i);
+			if (free == used && g_ProxySlots[i].released) {
+				free = i;
+			}
+		}
+
+		if (free == MaxProxyHooks) {
+			return false;
+		}
+
+		ProxyHookSlot& slot = g_ProxySlots[free];
+		slot.fieldID = cp.id();
+		slot.prop = prop;
+		slot.released = false;
+		slot.original.store(prop->GetProxyFn(), std::memory_order_release);
+		slot.active.store(true, std::memory_order_release);
+
+		if (free == used) {
+			g_ProxySlotsUsed.store(used + 1, std::memory_order_release);
+		}
+
+		prop->SetProxyFn(g_ProxyTrampolines[free]);
+		return true;
+	}
+
+	bool hookProxy(const std::string& table, const std::string& prop) {
+		/// table is the recv table name (DT_*), prop the formatted prop name like in getOffset
+		auto cit = g_Classes.find(table);
+		if (cit == g_Classes.end()) {
+			return false;
+		}
+
+		auto pit = cit->second.props().find(prop);
+		if (pit == cit->second.props().end() || pit->second.prop()->GetType() == DPT_DataTable) {
+			// Datatables go through DataTableRecvVarProxyFn, nothing to hook here
+			return false;
+		}
+
+		return hookProxy(pit->second);
+	}
+
+	void unhookProxies() {
+		/// Restores the original proxies where nobody has chained on top of us
+		/// Trampolines left in someone else's chain keep passing through, their slots are only reused once they're out of it
+		std::lock_guard<std::mutex> lock{ g_ProxyHooksMutex };
+
+		uint used = g_ProxySlotsUsed.load(std::memory_order_relaxed);
+		for (uint i = 0; i < used; i++) {
+			ProxyHookSlot& slot = g_ProxySlots[i];
+
+			if (!slot.active.load(std::memory_order_relaxed)) {
+				continue;
+			}
+
+			slot.active.store(false, std::memory_order_release);
+			releaseProxySlot(i);
+		}
+	}
+
+	void shutdownProxyHooks() {
+		/// Unhooks everything and frees the event rings of all threads, undrained events are lost
+		/// No thread may be inside a hooked proxy or draining while this runs, e.g. call it after the game stopped receiving
+		/// Threads that fire a hook afterwards get a new ring
+		unhookProxies();
+
+		ProxyRing* ring = g_ProxyRings.exchange(nullptr, std::memory_order_acq_rel);
+		g_ProxyRingGeneration.fetch_add(1, std::memory_order_release);
+
+		while (ring) {
+			ProxyRing* next = ring->next;
+			delete ring;
+			ring = next;
+		}
+	}
+
+	uint drainProxyEvents(ProxyEvent* out, uint max) {
+		/// Drains up to max events from all producer threads, must only be called from one consumer thread
+		uint n = 0;
+
+		for (ProxyRing* ring = g_ProxyRings.load(std::memory_order_acquire); ring && n < max; ring = ring->next) {
+			n += ring->ring.pop(out + n, max - n);
+		}
+
+		return n;
+	}
+
+	template<typename F>
+	std::uint64_t drainProxyEvents(F fn, uint batchsize = 256) {
+		/// Calls fn(const ProxyEvent* events, uint count) per batch until all rings are empty
+		std::vector<ProxyEvent> batch(batchsize);
+		std::uint64_t total = 0;
+
+		while (uint n = drainProxyEvents(batch.data(), batchsize)) {
+			fn(batch.data(), n);
+			total += n;
+		}
+
+		return total;
+	}
+
+	std::uint64_t getDroppedProxyEvents() {
+		std::uint64_t dropped = 0;
+
+		for (ProxyRing* ring = g_ProxyRings.load(std::memory_order_acquire); ring; ring = ring->next) {
+			dropped += ring->dropped.load(std::memory_order_relaxed);
+		}
+
+		return dropped;
+	}
+}
@@ -0,0 +1,403 @@
+#pragma once
+
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "dvalvegen.h"
+#include "proxyhooks.h"
+#include "mappedfile.h"
+
+namespace dvalvegen {
+	// Log layout: 8 byte magic, then records back to back
+	// Every record starts with a head byte: low 4 bits are the SendPropType, then flags for which optional parts follow
+	// [tick delta] [time delta, us] field ID delta, object ID delta, [element], payload
+	// Deltas are zigzag varints relative to the previous record, payload depends on the type
+	constexpr char RecordMagic[8] = { 'D', 'V', 'G', 'R', 'E', 'C', '1', 0 };
+
+	constexpr std::uint8_t RecordHasTick = 1 << 4;
+	constexpr std::uint8_t RecordHasTime = 1 << 5;
+	constexpr std::uint8_t RecordHasElement = 1 << 6;
+
+	inline void writeVarint(std::vector<std::uint8_t>& out, std::uint64_t v) {
+		while (v >= 0x80) {
+			out.push_back((std::uint8_t)(v | 0x80));
+			v >>= 7;
+		}
+		out.push_back((std::uint8_t)v);
+	}
+
+	inline bool readVarint(const std::uint8_t*& p, const std::uint8_t* end, std::uint64_t& v) {
+		/// False if the bytes run out (or go past 64 bits) before the one that ends the varint
+		v = 0;
+		for (int shift = 0; p < end && shift < 64; shift += 7) {
+			std::uint8_t b = *p++;
+			v |= (std::uint64_t)(b & 0x7F) << shift;
+			if (!(b & 0x80)) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	inline std::uint64_t zigzag(std::int64_t v) {
+		return ((std::uint64_t)v << 1) ^ (std::uint64_t)(v >> 63);
+	}
+
+	inline std::int64_t unzigzag(std::uint64_t v) {
+		return (std::int64_t)(v >> 1) ^ -(std::int64_t)(v & 1);
+	}
+
+	class NetvarRecorder {
+		/// Appends ProxyEvents to a delta-encoded log, file writes happen on a background thread
+	public:
+		NetvarRecorder() {
+
+		}
+
+		~NetvarRecorder() {
+			close();
+		}
+
+		NetvarRecorder(const NetvarRecorder&) = delete;
+		NetvarRecorder& operator=(const NetvarRecorder&) = delete;
+
+		bool open(const std::string& path, std::size_t buffersize = 1 << 20) {
+			close();
+
+			m_file = std::fopen(path.c_str(), "wb");
+			if (!m_file) {
+				return false;
+			}
+
+			m_buffersize = buffersize;
+			m_front.reserve(m_buffersize + 64);
+			m_back.reserve(m_buffersize + 64);
+			m_front.insert(m_front.end(), RecordMagic, RecordMagic + sizeof(RecordMagic));
+
+			m_start = std::chrono::steady_clock::now();
+			m_lastfield = m_lastobject = 0;
+			m_lasttick = m_lasttime = 0;
+			m_records = m_bytes = 0;
+
+			m_stop = false;
+			m_backfull = false;
+			m_writer = std::thread{ &NetvarRecorder::writerLoop, this };
+			return true;
+		}
+
+		void setTick(std::uint32_t tick) {
+			m_tick = tick;
+		}
+
+		void record(const ProxyEvent& ev) {
+			std::uint64_t time = (std::uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count();
+			std::uint8_t type = (std::uint8_t)(ev.type >= 0 && ev.type < 15 ? ev.type : 15);
+			std::uint8_t head = type;
+
+			if (m_tick != m_lasttick) {
+				head |= RecordHasTick;
+			}
+
+			if (time != m_lasttime) {
+				head |= RecordHasTime;
+			}
+
+			if (ev.element != 0) {
+				head |= RecordHasElement;
+			}
+
+			m_front.push_back(head);
+
+			if (head & RecordHasTick) {
+				writeVarint(m_front, zigzag((std::int64_t)m_tick - (std::int64_t)m_lasttick));
+				m_lasttick = m_tick;
+			}
+
+			if (head & RecordHasTime) {
+				writeVarint(m_front, time - m_lasttime);
+				m_lasttime = time;
+			}
+
+			writeVarint(m_front, zigzag((std::int64_t)ev.fieldID - (std::int64_t)m_lastfield));
+			writeVarint(m_front, zigzag((std::int64_t)ev.objectID - (std::int64_t)m_lastobject));
+			m_lastfield = ev.fieldID;
+			m_lastobject = ev.objectID;
+
+			if (head & RecordHasElement) {
+				writeVarint(m_front, (std::uint32_t)ev.element);
+			}
+
+			switch (type) {
+			case DPT_Int:
+				writeVarint(m_front, zigzag(ev.value.m_Int));
+				break;
+			case DPT_Int64:
+				writeVarint(m_front, zigzag(ev.value.m_Int64));
+				break;
+			case DPT_Float:
+				append(&ev.value.m_Float, 4);
+				break;
+			case DPT_Vector:
+				append(ev.value.m_Vector, 12);
+				break;
+			case DPT_VectorXY:
+				append(ev.value.m_Vector, 8);
+				break;
+			default:
+				break;
+			}
+
+			m_records++;
+
+			if (m_front.size() >= m_buffersize) {
+				flush();
+			}
+		}
+
+		void record(const ProxyEvent* events, uint count) {
+			for (uint i = 0; i < count; i++) {
+				record(events[i]);
+			}
+		}
+
+		std::uint64_t recordProxyEvents() {
+			/// Drains the proxy hook rings straight into the log
+			return drainProxyEvents([this](const ProxyEvent* events, uint count) {
+				record(events, count);
+			});
+		}
+
+		void flush() {
+			/// Hands the filled buffer to the writer, waits only if the writer is still busy with the previous one
+			if (m_front.empty() || !m_file) {
+				return;
+			}
+
+			std::unique_lock<std::mutex> lock{ m_mutex };
+			m_cv.wait(lock, [this] { return !m_backfull; });
+
+			std::swap(m_front, m_back);
+			m_backfull = true;
+			m_cv.notify_all();
+		}
+
+		void close() {
+			if (!m_file) {
+				return;
+			}
+
+			flush();
+
+			{
+				std::unique_lock<std::mutex> lock{ m_mutex };
+				m_cv.wait(lock, [this] { return !m_backfull; });
+				m_stop = true;
+				m_cv.notify_all();
+			}
+
+			m_writer.join();
+			std::fclose(m_file);
+			m_file = nullptr;
+		}
+
+		std::uint64_t numRecords() const {
+			return m_records;
+		}
+
+		std::uint64_t bytesWritten() const {
+			return m_bytes;
+		}
+
+	private:
+		void append(const void* data, std::size_t size) {
+			const std::uint8_t* p = (const std::uint8_t*)data;
+			m_front.insert(m_front.end(), p, p + size);
+		}
+
+		void writerLoop() {
+			std::unique_lock<std::mutex> lock{ m_mutex };
+
+			while (true) {
+				m_cv.wait(lock, [this] { return m_backfull || m_stop; });
+
+				if (m_backfull) {
+					// The producer never touches the back buffer while it's marked full
+					lock.unlock();
+					std::fwrite(m_back.data(), 1, m_back.size(), m_file);
+					m_bytes += m_back.size();
+					m_back.clear();
+					lock.lock();
+
+					m_backfull = false;
+					m_cv.notify_all();
+				}
+				else if (m_stop) {
+					break;
+				}
+			}
+
+			std::fflush(m_file);
+		}
+
+		std::FILE* m_file = nullptr;
+		std::size_t m_buffersize = 0;
+		std::vector<std::uint8_t> m_front;
+		std::vector<std::uint8_t> m_back;
+
+		std::thread m_writer;
+		std::mutex m_mutex;
+		std::condition_variable m_cv;
+		bool m_backfull = false;
+		bool m_stop = false;
+
+		std::chrono::steady_clock::time_point m_start;
+		std::uint32_t m_tick = 0;
+		std::uint32_t m_lasttick = 0;
+		std::uint64_t m_lasttime = 0;
+		std::uint32_t m_lastfield = 0;
+		std::int32_t m_lastobject = 0;
+		std::uint64_t m_records = 0;
+		std::atomic<std::uint64_t> m_bytes{ 0 };
+	};
+
+	class NetvarReplayer {
+		/// Maps a log written by NetvarRecorder and feeds it back as ProxyEvents
+	public:
+		bool open(const std::string& path) {
+			if (!m_file.open(path)) {
+				return false;
+			}
+
+			if (m_file.size() < sizeof(RecordMagic) || std::memcmp(m_file.data(), RecordMagic, sizeof(RecordMagic)) != 0) {
+				m_file.close();
+				return false;
+			}
+
+			return true;
+		}
+
+		template<typename F>
+		std::uint64_t replay(F fn, bool realtime = false) {
+			/// Calls fn(const ProxyEvent& ev, std::uint32_t tick) for every record
+			/// With realtime set, records are spaced out like they were when recorded, otherwise it runs flat out
+			const std::uint8_t* p = m_file.data() + sizeof(RecordMagic);
+			const std::uint8_t* end = m_file.data() + m_file.size();
+
+			ReplayState state;
+			ProxyEvent ev;
+			std::uint64_t n = 0;
+			auto start = std::chrono::steady_clock::now();
+
+			// A truncated log, e.g. the recorder was killed mid-write, ends at the last complete record
+			while (p < end && readRecord(p, end, state, ev)) {
+				if (realtime) {
+					std::this_thread::sleep_until(start + std::chrono::microseconds(state.time));
+				}
+
+				fn((const ProxyEvent&)ev, state.tick);
+				n++;
+			}
+
+			return n;
+		}
+
+		std::size_t size() const {
+			return m_file.size();
+		}
+
+	private:
+		struct ReplayState {
+			std::uint32_t tick = 0;
+			std::uint64_t time = 0;
+			std::uint32_t field = 0;
+			std::int32_t object = 0;
+		};
+
+		static bool readRecord(const std::uint8_t*& p, const std::uint8_t* end, ReplayState& state, ProxyEvent& ev) {
+			/// Decodes one record into ev, false if the log ends inside it
+			std::uint8_t head = *p++;
+			std::uint64_t v = 0;
+			std::memset(&ev, 0, sizeof(ev));
+
+			if (head & RecordHasTick) {
+				if (!readVarint(p, end, v)) {
+					return false;
+				}
+				state.tick = (std::uint32_t)((std::int64_t)state.tick + unzigzag(v));
+			}
+
+			if (head & RecordHasTime) {
+				if (!readVarint(p, end, v)) {
+					return false;
+				}
+				state.time += v;
+			}
+
+			if (!readVarint(p, end, v)) {
+				return false;
+			}
+			state.field = (std::uint32_t)((std::int64_t)state.field + unzigzag(v));
+
+			if (!readVarint(p, end, v)) {
+				return false;
+			}
+			state.object = (std::int32_t)((std::int64_t)state.object + unzigzag(v));
+
+			ev.fieldID = state.field;
+			ev.objectID = state.object;
+			ev.type = head & 0x0F;
+
+			if (head & RecordHasElement) {
+				if (!readVarint(p, end, v)) {
+					return false;
+				}
+				ev.element = (std::int32_t)v;
+			}
+
+			std::size_t payload = 0;
+			switch (ev.type) {
+			case DPT_Int:
+			case DPT_Int64:
+				if (!readVarint(p, end, v)) {
+					return false;
+				}
+
+				if (ev.type == DPT_Int) {
+					ev.value.m_Int = (std::int32_t)unzigzag(v);
+				}
+				else {
+					ev.value.m_Int64 = unzigzag(v);
+				}
+				break;
+			case DPT_Float:
+				payload = 4;
+				break;
+			case DPT_Vector:
+				payload = 12;
+				break;
+			case DPT_VectorXY:
+				payload = 8;
+				break;
+			default:
+				break;
+			}
+
+			if ((std::size_t)(end - p) < payload) {
+				return false;
+			}
+
+			std::memcpy(&ev.value, p, payload);
+			p += payload;
+			return true;
+		}
+
+		MappedFile m_file;
+	};
+}
@@ -0,0 +1,485 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <sys/types.h>
+	#include <sys/uio.h>
+	#include <limits.h>
+#endif
+
+#include "dvalvegen.h"
+#include "synthetic.h"
+
+namespace dvalvegen {
+	struct RemoteRead {
+		std::uintptr_t address;
+		void* out;
+		std::size_t size;
+	};
+
+	class MemoryReader {
+		/// Reads the memory of another process, implementations only have to provide readv
+	public:
+		virtual ~MemoryReader() {
+
+		}
+
+		virtual bool readv(const RemoteRead* reads, uint count) = 0;
+
+		bool read(std::uintptr_t address, void* out, std::size_t size) {
+			RemoteRead r{ address, out, size };
+			return readv(&r, 1);
+		}
+
+		std::uint64_t numCalls() const {
+			/// Number of reads that actually went to the OS
+			return m_calls;
+		}
+
+	protected:
+		std::uint64_t m_calls = 0;
+	};
+
+	class ProcessReader : public MemoryReader {
+		/// process_vm_readv on Linux, ReadProcessMemory on Windows
+	public:
+		ProcessReader() {
+
+		}
+
+		ProcessReader(int pid) {
+			open(pid);
+		}
+
+		~ProcessReader() {
+			close();
+		}
+
+		ProcessReader(const ProcessReader&) = delete;
+		ProcessReader& operator=(const ProcessReader&) = delete;
+
+		bool open(int pid) {
+			close();
+
+#ifdef _WIN32
+			m_process = OpenProcess(PROCESS_VM_READ | PROCESS_QUERY_INFORMATION, FALSE, (DWORD)pid);
+			return m_process != NULL;
+#else
+			m_pid = pid;
+			return pid > 0;
+#endif
+		}
+
+		void close() {
+#ifdef _WIN32
+			if (m_process) {
+				CloseHandle(m_process);
+			}
+
+			m_process = NULL;
+#else
+			m_pid = -1;
+#endif
+		}
+
+		bool readv(const RemoteRead* reads, uint count) override {
+			/// All or nothing, a single unreadable byte fails the whole batch
+#ifdef _WIN32
+			// No scatter read on Windows, one call per range
+			for (uint i = 0; i < count; i++) {
+				SIZE_T done = 0;
+				m_calls++;
+
+				if (!ReadProcessMemory(m_process, (LPCVOID)reads[i].address, reads[i].out, reads[i].size, &done) || done != reads[i].size) {
+					return false;
+				}
+			}
+
+			return true;
+#else
+			std::vector<iovec> local;
+			std::vector<iovec> remote;
+
+			for (uint first = 0; first < count;) {
+				uint n = std::min<uint>(count - first, IOV_MAX);
+				std::size_t total = 0;
+
+				local.resize(n);
+				remote.resize(n);
+
+				for (uint i = 0; i < n; i++) {
+					local[i] = { reads[first + i].out, reads[first + i].size };
+					remote[i] = { (void*)reads[first + i].address, reads[first + i].size };
+					total += reads[first + i].size;
+				}
+
+				m_calls++;
+				if (process_vm_readv(m_pid, local.data(), n, remote.data(), n, 0) != (ssize_t)total) {
+					return false;
+				}
+
+				first += n;
+			}
+
+			return true;
+#endif
+		}
+
+	private:
+#ifdef _WIN32
+		HANDLE m_process = NULL;
+#else
+		int m_pid = -1;
+#endif
+	};
+
+	class CachedReader : public MemoryReader {
+		/// Page granular read cache in front of another reader
+		/// All pages missing from one readv are fetched in a single batch, adjacent ones merged into one range
+	public:
+		static constexpr std::size_t PageSize = 4096;
+
+		CachedReader(MemoryReader& reader) : m_reader(reader) {
+
+		}
+
+		bool readv(const RemoteRead* reads, uint count) override {
+			std::vector<std::uintptr_t> missing;
+
+			for (uint i = 0; i < count; i++) {
+				if (reads[i].size == 0) {
+					continue;
+				}
+
+				std::uintptr_t last = (reads[i].address + reads[i].size - 1) & ~(PageSize - 1);
+				for (std::uintptr_t page = reads[i].address & ~(PageSize - 1); page <= last; page += PageSize) {
+					if (!m_pages.count(page) && !m_bad.count(page)) {
+						missing.push_back(page);
+					}
+				}
+			}
+
+			fetch(missing);
+
+			for (uint i = 0; i < count; i++) {
+				std::uint8_t* out = (std::uint8_t*)reads[i].out;
+				std::uintptr_t address = reads[i].address;
+				std::size_t left = reads[i].size;
+
+				while (left > 0) {
+					std::uintptr_t page = address & ~(PageSize - 1);
+					auto it = m_pages.find(page);
+
+					if (it == m_pages.end()) {
+						return false;
+					}
+
+					std::size_t offset = address - page;
+					std::size_t n = std::min(left, PageSize - offset);
+					std::memcpy(out, it->second.data() + offset, n);
+
+					out += n;
+					address += n;
+					left -= n;
+				}
+			}
+
+			return true;
+		}
+
+		bool readString(std::uintptr_t address, std::string& out, std::size_t maxlength = 256) {
+			/// Reads up to the terminator, a page at a time
+			out.clear();
+
+			while (out.size() < maxlength) {
+				std::uintptr_t page = address & ~(PageSize - 1);
+				std::size_t offset = address - page;
+				std::size_t n = std::min(PageSize - offset, maxlength - out.size());
+
+				if (!m_pages.count(page)) {
+					std::vector<std::uintptr_t> missing{ page };
+					fetch(missing);
+
+					if (!m_pages.count(page)) {
+						return false;
+					}
+				}
+
+				const char* data = (const char*)m_pages[page].data() + offset;
+				const char* end = (const char*)std::memchr(data, 0, n);
+
+				if (end) {
+					out.append(data, end);
+					return true;
+				}
+
+				out.append(data, n);
+				address += n;
+			}
+
+			return true;
+		}
+
+		void prefetch(const std::vector<std::uintptr_t>& addresses) {
+			/// Pulls in the pages of all addresses at once, e.g. before reading a lot of short strings
+			std::vector<std::uintptr_t> missing;
+
+			for (std::uintptr_t address : addresses) {
+				std::uintptr_t page = address & ~(PageSize - 1);
+				if (address && !m_pages.count(page) && !m_bad.count(page)) {
+					missing.push_back(page);
+				}
+			}
+
+			fetch(missing);
+		}
+
+		void clear() {
+			m_pages.clear();
+			m_bad.clear();
+		}
+
+		std::size_t numPages() const {
+			return m_pages.size();
+		}
+
+	private:
+		void fetch(std::vector<std::uintptr_t>& pages) {
+			if (pages.empty()) {
+				return;
+			}
+
+			std::sort(pages.begin(), pages.end());
+			pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
+
+			// Contiguous pages become one range
+			std::vector<std::pair<std::uintptr_t, uint>> ranges;
+			for (std::uintptr_t page : pages) {
+				if (!ranges.empty() && ranges.back().first + ranges.back().second * PageSize == page) {
+					ranges.back().second++;
+				}
+				else {
+					ranges.push_back({ page, 1 });
+				}
+			}
+
+			std::vector<std::uint8_t> buffer(pages.size() * PageSize);
+			std::vector<RemoteRead> reads;
+			std::size_t offset = 0;
+
+			for (auto& r : ranges) {
+				reads.push_back({ r.first, buffer.data() + offset, r.second * PageSize });
+				offset += r.second * PageSize;
+			}
+
+			bool ok = m_reader.readv(reads.data(), (uint)reads.size());
+			m_calls = m_reader.numCalls();
+
+			if (!ok) {
+				// Something in the batch isn't mapped, find out what is one page at a time
+				for (uint i = 0; i < pages.size(); i++) {
+					if (!m_reader.read(pages[i], buffer.data() + i * PageSize, PageSize)) {
+						m_bad.insert(pages[i]);
+					}
+					else {
+						m_pages[pages[i]].assign(buffer.data() + i * PageSize, buffer.data() + (i + 1) * PageSize);
+					}
+				}
+
+				m_calls = m_reader.numCalls();
+				return;
+			}
+
+			for (uint i = 0; i < pages.size(); i++) {
+				m_pages[pages[i]].assign(buffer.data() + i * PageSize, buffer.data() + (i + 1) * PageSize);
+			}
+		}
+
+		MemoryReader& m_reader;
+		std::unordered_map<std::uintptr_t, std::vector<std::uint8_t>> m_pages;
+		std::unordered_set<std::uintptr_t> m_bad;
+	};
+
+	class RemoteGraphLoader {
+		/// Copies the ClientClass graph of another process into a SyntheticGraph
+		/// The target has to use the same struct layout (same architecture) as this build
+		/// Tables are read breadth first, one batch per nesting level, so the number of reads
+		/// depends on the depth of the graph and the number of pages it spans, not on the number of pointers
+	public:
+		static constexpr uint MaxClasses = 1 << 16;
+		static constexpr int MaxProps = 1 << 14;
+
+		RemoteGraphLoader(MemoryReader& reader) : m_cache(reader) {
+
+		}
+
+		bool load(std::uintptr_t head, SyntheticGraph& graph) {
+			m_classes.clear();
+			m_tables.clear();
+			m_props.clear();
+			m_order.clear();
+
+			if (!readClasses(head) || !readTables()) {
+				return false;
+			}
+
+			// Every name in one go, most of them share a handful of pages in .rdata
+			std::vector<std::uintptr_t> names;
+			for (auto& c : m_classes) {
+				names.push_back((std::uintptr_t)c.m_pNetworkName);
+			}
+
+			for (std::uintptr_t t : m_order) {
+				names.push_back((std::uintptr_t)m_tables[t].m_pNetTableName);
+				for (auto& prop : m_props[t]) {
+					names.push_back((std::uintptr_t)prop.m_pVarName);
+				}
+			}
+
+			m_cache.prefetch(names);
+
+			std::unordered_map<std::uintptr_t, RecvTable*> local;
+			for (std::uintptr_t t : m_order) {
+				local[t] = graph.addTable(name((std::uintptr_t)m_tables[t].m_pNetTableName));
+			}
+
+			std::string propname;
+			for (std::uintptr_t t : m_order) {
+				for (auto& prop : m_props[t]) {
+					propname = name((std::uintptr_t)prop.m_pVarName);
+
+					RecvProp copy = prop;
+					copy.m_pVarName = &propname[0];
+
+					auto dt = local.find((std::uintptr_t)prop.GetDataTable());
+					graph.addProp(local[t], copy, dt == local.end() ? nullptr : dt->second);
+				}
+			}
+
+			for (auto& c : m_classes) {
+				auto table = local.find((std::uintptr_t)c.m_pRecvTable);
+				graph.addClass(name((std::uintptr_t)c.m_pNetworkName), table == local.end() ? nullptr : table->second, c.m_ClassID);
+			}
+
+			return true;
+		}
+
+		std::uint64_t numCalls() const {
+			return m_cache.numCalls();
+		}
+
+		CachedReader& cache() {
+			return m_cache;
+		}
+
+	private:
+		bool readClasses(std::uintptr_t head) {
+			// A linked list can't be batched, but consecutive classes usually share a page
+			std::unordered_set<std::uintptr_t> seen;
+
+			for (std::uintptr_t address = head; address && m_classes.size() < MaxClasses; address = (std::uintptr_t)m_classes.back().m_pNext) {
+				if (!seen.insert(address).second) {
+					break;
+				}
+
+				m_classes.emplace_back();
+				if (!m_cache.read(address, &m_classes.back(), sizeof(ClientClass))) {
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		bool readTables() {
+			std::vector<std::uintptr_t> level;
+
+			for (auto& c : m_classes) {
+				queue((std::uintptr_t)c.m_pRecvTable, level);
+			}
+
+			std::vector<RemoteRead> reads;
+			std::vector<std::uintptr_t> next;
+
+			while (!level.empty()) {
+				reads.clear();
+				for (std::uintptr_t t : level) {
+					reads.push_back({ t, &m_tables[t], sizeof(RecvTable) });
+				}
+
+				if (!m_cache.readv(reads.data(), (uint)reads.size())) {
+					return false;
+				}
+
+				reads.clear();
+				for (std::uintptr_t t : level) {
+					RecvTable& table = m_tables[t];
+					if (table.m_nProps < 0 || table.m_nProps > MaxProps) {
+						return false;
+					}
+
+					m_props[t].resize(table.m_nProps);
+					reads.push_back({ (std::uintptr_t)table.m_pProps, m_props[t].data(), sizeof(RecvProp) * table.m_nProps });
+				}
+
+				if (!m_cache.readv(reads.data(), (uint)reads.size())) {
+					return false;
+				}
+
+				next.clear();
+				for (std::uintptr_t t : level) {
+					for (auto& prop : m_props[t]) {
+						queue((std::uintptr_t)prop.GetDataTable(), next);
+					}
+				}
+
+				std::swap(level, next);
+			}
+
+			return true;
+		}
+
+		void queue(std::uintptr_t table, std::vector<std::uintptr_t>& level) {
+			if (table && !m_tables.count(table)) {
+				m_tables.emplace(table, RecvTable{});
+				m_order.push_back(table);
+				level.push_back(table);
+			}
+		}
+
+		std::string name(std::uintptr_t address) {
+			std::string s;
+			if (!address || !m_cache.readString(address, s)) {
+				return "Unknown";
+			}
+
+			return s;
+		}
+
+		CachedReader m_cache;
+		std::vector<ClientClass> m_classes;
+		std::unordered_map<std::uintptr_t, RecvTable> m_tables;
+		std::unordered_map<std::uintptr_t, std::vector<RecvProp>> m_props;
+		std::vector<std::uintptr_t> m_order;	// Tables in the order they were found
+	};
+
+	bool loadRemoteGraph(int pid, std::uintptr_t head, SyntheticGraph& graph) {
+		/// head is the address of the first ClientClass in the target, e.g. what GetAllClasses returns there
+		ProcessReader reader;
+		if (!reader.open(pid)) {
+			return false;
+		}
+
+		RemoteGraphLoader loader{ reader };
+		return loader.load(head, graph);
+	}
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+namespace dvalvegen {
+	template<typename T>
+	class SpscRing {
+		/// Bounded single producer single consumer queue, lock-free on both ends
+	public:
+		SpscRing(unsigned int capacity) {
+			m_capacity = 1;
+			while (m_capacity < capacity) {
+				m_capacity <<= 1;
+			}
+
+			m_mask = m_capacity - 1;
+			m_data.resize(m_capacity);
+		}
+
+		bool push(const T& value) {
+			std::size_t head = m_head.load(std::memory_order_relaxed);
+
+			if (head - m_tailcache == m_capacity) {
+				m_tailcache = m_tail.load(std::memory_order_acquire);
+				if (head - m_tailcache == m_capacity) {
+					return false;
+				}
+			}
+
+			m_data[head & m_mask] = value;
+			m_head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool push(T&& value) {
+			std::size_t head = m_head.load(std::memory_order_relaxed);
+
+			if (head - m_tailcache == m_capacity) {
+				m_tailcache = m_tail.load(std::memory_order_acquire);
+				if (head - m_tailcache == m_capacity) {
+					return false;
+				}
+			}
+
+			m_data[head & m_mask] = std::move(value);
+			m_head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool pop(T& out) {
+			std::size_t tail = m_tail.load(std::memory_order_relaxed);
+
+			if (tail == m_headcache) {
+				m_headcache = m_head.load(std::memory_order_acquire);
+				if (tail == m_headcache) {
+					return false;
+				}
+			}
+
+			out = std::move(m_data[tail & m_mask]);
+			m_tail.store(tail + 1, std::memory_order_release);
+			return true;
+		}
+
+		unsigned int pop(T* out, unsigned int max) {
+			/// Pops up to max elements in one go, returns how many were popped
+			std::size_t tail = m_tail.load(std::memory_order_relaxed);
+			std::size_t head = m_head.load(std::memory_order_acquire);
+			std::size_t n = head - tail;
+
+			if (n > max) {
+				n = max;
+			}
+
+			for (std::size_t i = 0; i < n; i++) {
+				out[i] = std::move(m_data[(tail + i) & m_mask]);
+			}
+
+			m_tail.store(tail + n, std::memory_order_release);
+			return (unsigned int)n;
+		}
+
+		std::size_t size() const {
+			return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+		}
+
+		std::size_t capacity() const {
+			return m_capacity;
+		}
+
+	private:
+		// Producer and consumer indices live on separate cache lines
+		alignas(64) std::atomic<std::size_t> m_head{ 0 };
+		std::size_t m_tailcache = 0;
+
+		alignas(64) std::atomic<std::size_t> m_tail{ 0 };
+		std::size_t m_headcache = 0;
+
+		alignas(64) std::size_t m_capacity;
+		std::size_t m_mask;
+		std::vector<T> m_data;
+	};
+}
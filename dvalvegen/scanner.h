@@ -0,0 +1,388 @@
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+#ifdef _WIN32
+	#include <windows.h>
+#endif
+
+#include "dvalvegen.h"
+#include "simd.h"
+
+namespace dvalvegen {
+	class BytePattern {
+		/// Byte signature with wildcards, e.g. "A1 ?? ?? ?? ?? C3"
+	public:
+		BytePattern() {
+
+		}
+
+		BytePattern(const std::string& text) {
+			compile(text);
+		}
+
+		bool compile(const std::string& text) {
+			/// Hex bytes separated by spaces, ? or ?? for any byte
+			m_bytes.clear();
+			m_mask.clear();
+
+			for (std::size_t i = 0; i < text.size();) {
+				if (text[i] == ' ') {
+					i++;
+					continue;
+				}
+
+				if (text[i] == '?') {
+					i += i + 1 < text.size() && text[i + 1] == '?' ? 2 : 1;
+					m_bytes.push_back(0);
+					m_mask.push_back(0);
+					continue;
+				}
+
+				int hi = hexDigit(text[i]);
+				int lo = i + 1 < text.size() ? hexDigit(text[i + 1]) : -1;
+
+				if (hi < 0 || lo < 0) {
+					m_bytes.clear();
+					m_mask.clear();
+					return false;
+				}
+
+				m_bytes.push_back((std::uint8_t)(hi << 4 | lo));
+				m_mask.push_back(0xFF);
+				i += 2;
+			}
+
+			return chooseAnchor();
+		}
+
+		static BytePattern fromBytes(const void* bytes, const char* mask) {
+			/// mask has one char per byte, 'x' must match and '?' is a wildcard
+			BytePattern p;
+			std::size_t n = std::strlen(mask);
+
+			for (std::size_t i = 0; i < n; i++) {
+				p.m_bytes.push_back(mask[i] == '?' ? 0 : ((const std::uint8_t*)bytes)[i]);
+				p.m_mask.push_back(mask[i] == '?' ? 0 : 0xFF);
+			}
+
+			p.chooseAnchor();
+			return p;
+		}
+
+		bool match(const std::uint8_t* p) const {
+			/// Compares at p, size() bytes must be readable there
+			for (std::size_t i = 0; i < m_bytes.size(); i++) {
+				if ((p[i] & m_mask[i]) != m_bytes[i]) {
+					return false;
+				}
+			}
+
+			return !m_bytes.empty();
+		}
+
+		std::string text() const {
+			static const char digits[] = "0123456789ABCDEF";
+			std::string s;
+
+			for (std::size_t i = 0; i < m_bytes.size(); i++) {
+				if (i) {
+					s += ' ';
+				}
+
+				if (m_mask[i]) {
+					s += digits[m_bytes[i] >> 4];
+					s += digits[m_bytes[i] & 15];
+				}
+				else {
+					s += "??";
+				}
+			}
+
+			return s;
+		}
+
+		std::size_t size() const {
+			return m_bytes.size();
+		}
+
+		bool valid() const {
+			return m_anchor >= 0;
+		}
+
+		int anchor() const {
+			/// Index of the byte the scanner looks for first
+			return m_anchor;
+		}
+
+		std::uint8_t anchorByte() const {
+			return m_bytes[m_anchor];
+		}
+
+		bool hasAnchorPair() const {
+			/// Whether the byte after the anchor is fixed too, lets the scanner filter on two bytes
+			return m_anchor >= 0 && (std::size_t)m_anchor + 1 < m_mask.size() && m_mask[m_anchor + 1];
+		}
+
+		std::uint8_t anchorNext() const {
+			return m_bytes[m_anchor + 1];
+		}
+
+	private:
+		static int hexDigit(char c) {
+			if (c >= '0' && c <= '9') {
+				return c - '0';
+			}
+
+			if (c >= 'a' && c <= 'f') {
+				return c - 'a' + 10;
+			}
+
+			if (c >= 'A' && c <= 'F') {
+				return c - 'A' + 10;
+			}
+
+			return -1;
+		}
+
+		bool chooseAnchor() {
+			// Padding, movs and push/call bytes show up everywhere in code, anchoring on them means lots of false candidates
+			static const std::uint8_t common[] = { 0x00, 0xFF, 0xCC, 0x8B, 0x89, 0x48, 0x0F, 0xE8, 0x83, 0x8D, 0x24, 0x45, 0x4C, 0x74, 0x75, 0x55, 0x90 };
+
+			// Best is an uncommon byte followed by another fixed one, then any uncommon byte, then anything fixed
+			int best = -1;
+			m_anchor = -1;
+
+			for (std::size_t i = 0; i < m_bytes.size(); i++) {
+				if (!m_mask[i]) {
+					continue;
+				}
+
+				bool rare = std::find(std::begin(common), std::end(common), m_bytes[i]) == std::end(common);
+				bool pair = i + 1 < m_bytes.size() && m_mask[i + 1];
+				int score = (rare ? 2 : 0) + (pair ? 1 : 0);
+
+				if (score > best) {
+					best = score;
+					m_anchor = (int)i;
+				}
+			}
+
+			return m_anchor >= 0;
+		}
+
+		std::vector<std::uint8_t> m_bytes;
+		std::vector<std::uint8_t> m_mask;
+		int m_anchor = -1;
+	};
+
+	class PatternScanner {
+		/// Finds many patterns in one pass over a buffer
+		/// Candidates are found 16 or 32 bytes at a time by comparing against each pattern's anchor byte
+		/// (and the byte after it, when that one is fixed), only those positions are compared in full
+	public:
+		void add(const BytePattern& pattern) {
+			m_patterns.push_back(pattern);
+
+			if (!pattern.valid()) {
+				return;
+			}
+
+			// Patterns with the same anchor share one filter
+			Filter key{ pattern.anchorByte(), pattern.hasAnchorPair() ? pattern.anchorNext() : (std::uint8_t)0, pattern.hasAnchorPair(), {} };
+			auto it = std::find_if(m_filters.begin(), m_filters.end(), [&key](const Filter& f) {
+				return f.first == key.first && f.pair == key.pair && (!f.pair || f.second == key.second);
+			});
+
+			if (it == m_filters.end()) {
+				m_filters.push_back(key);
+				m_firsts[key.first] = true;
+				it = m_filters.end() - 1;
+			}
+
+			it->patterns.push_back((uint)m_patterns.size() - 1);
+		}
+
+		void clear() {
+			m_patterns.clear();
+			m_filters.clear();
+			std::fill(std::begin(m_firsts), std::end(m_firsts), false);
+		}
+
+		void scan(const std::uint8_t* data, std::size_t size, std::vector<std::vector<std::size_t>>& results, uint maxhits = 0) const {
+			/// results[i] gets the offsets of pattern i in the order it was added, maxhits 0 means no limit
+			results.assign(m_patterns.size(), {});
+
+			std::size_t pos = 0;
+
+#if defined(DVALVEGEN_SSE2)
+			// Broadcast anchor bytes, first and second byte of each filter side by side
+			std::vector<std::uint8_t> needles(m_filters.size() * 64);
+			for (std::size_t i = 0; i < m_filters.size(); i++) {
+				std::memset(&needles[i * 64], m_filters[i].first, 32);
+				std::memset(&needles[i * 64 + 32], m_filters[i].second, 32);
+			}
+#endif
+
+#if defined(DVALVEGEN_AVX2)
+			for (; pos + 33 <= size; pos += 32) {
+				__m256i block = _mm256_loadu_si256((const __m256i*)(data + pos));
+				__m256i next = _mm256_loadu_si256((const __m256i*)(data + pos + 1));
+
+				for (std::size_t i = 0; i < m_filters.size(); i++) {
+					__m256i eq = _mm256_cmpeq_epi8(block, _mm256_loadu_si256((const __m256i*)&needles[i * 64]));
+					if (m_filters[i].pair) {
+						eq = _mm256_and_si256(eq, _mm256_cmpeq_epi8(next, _mm256_loadu_si256((const __m256i*)&needles[i * 64 + 32])));
+					}
+
+					std::uint64_t bits = (std::uint32_t)_mm256_movemask_epi8(eq);
+					for (; bits; bits &= bits - 1) {
+						check(m_filters[i], data, size, pos + simd::ctz64(bits), results, maxhits);
+					}
+				}
+			}
+#elif defined(DVALVEGEN_SSE2)
+			for (; pos + 17 <= size; pos += 16) {
+				__m128i block = _mm_loadu_si128((const __m128i*)(data + pos));
+				__m128i next = _mm_loadu_si128((const __m128i*)(data + pos + 1));
+
+				for (std::size_t i = 0; i < m_filters.size(); i++) {
+					__m128i eq = _mm_cmpeq_epi8(block, _mm_loadu_si128((const __m128i*)&needles[i * 64]));
+					if (m_filters[i].pair) {
+						eq = _mm_and_si128(eq, _mm_cmpeq_epi8(next, _mm_loadu_si128((const __m128i*)&needles[i * 64 + 32])));
+					}
+
+					std::uint64_t bits = (std::uint16_t)_mm_movemask_epi8(eq);
+					for (; bits; bits &= bits - 1) {
+						check(m_filters[i], data, size, pos + simd::ctz64(bits), results, maxhits);
+					}
+				}
+			}
+#endif
+
+			for (; pos < size; pos++) {
+				if (!m_firsts[data[pos]]) {
+					continue;
+				}
+
+				for (auto& f : m_filters) {
+					if (data[pos] == f.first && (!f.pair || (pos + 1 < size && data[pos + 1] == f.second))) {
+						check(f, data, size, pos, results, maxhits);
+					}
+				}
+			}
+		}
+
+		const std::vector<BytePattern>& patterns() const {
+			return m_patterns;
+		}
+
+	private:
+		struct Filter {
+			std::uint8_t first;
+			std::uint8_t second;
+			bool pair;
+			std::vector<uint> patterns;
+		};
+
+		void check(const Filter& f, const std::uint8_t* data, std::size_t size, std::size_t pos, std::vector<std::vector<std::size_t>>& results, uint maxhits) const {
+			for (uint i : f.patterns) {
+				const BytePattern& p = m_patterns[i];
+
+				if (pos < (std::size_t)p.anchor() || pos - p.anchor() + p.size() > size) {
+					continue;
+				}
+
+				std::size_t start = pos - p.anchor();
+				if ((maxhits == 0 || results[i].size() < maxhits) && p.match(data + start)) {
+					results[i].push_back(start);
+				}
+			}
+		}
+
+		std::vector<BytePattern> m_patterns;
+		std::vector<Filter> m_filters;
+		bool m_firsts[256] = {};
+	};
+
+	class ScanCache {
+		/// Scan results per module image and pattern, so asking again for the same signature is free
+	public:
+		const std::vector<std::size_t>& find(const std::uint8_t* base, std::size_t size, const BytePattern& pattern) {
+			std::vector<const BytePattern*> one{ &pattern };
+			return *findMany(base, size, one)[0];
+		}
+
+		std::vector<const std::vector<std::size_t>*> findMany(const std::uint8_t* base, std::size_t size, const std::vector<const BytePattern*>& patterns) {
+			/// Patterns not seen before for this image are scanned for together, in a single pass
+			auto& image = m_images[{ base, size }];
+
+			PatternScanner scanner;
+			std::vector<std::string> keys;
+
+			for (auto p : patterns) {
+				std::string key = p->text();
+				if (!image.count(key) && std::find(keys.begin(), keys.end(), key) == keys.end()) {
+					scanner.add(*p);
+					keys.push_back(key);
+				}
+			}
+
+			if (!keys.empty()) {
+				std::vector<std::vector<std::size_t>> results;
+				scanner.scan(base, size, results);
+
+				for (std::size_t i = 0; i < keys.size(); i++) {
+					image[keys[i]] = std::move(results[i]);
+				}
+			}
+
+			std::vector<const std::vector<std::size_t>*> out;
+			for (auto p : patterns) {
+				out.push_back(&image[p->text()]);
+			}
+
+			return out;
+		}
+
+		void forget(const std::uint8_t* base) {
+			/// Drops everything cached for an image, e.g. after the module was unloaded
+			for (auto it = m_images.begin(); it != m_images.end();) {
+				it = it->first.first == base ? m_images.erase(it) : std::next(it);
+			}
+		}
+
+	private:
+		std::map<std::pair<const std::uint8_t*, std::size_t>, std::map<std::string, std::vector<std::size_t>>> m_images;
+	};
+
+	ScanCache g_ScanCache;
+
+#ifdef _WIN32
+	bool moduleImage(HMODULE module, const std::uint8_t*& base, std::size_t& size) {
+		/// Whole mapped image of a loaded module, from its PE headers
+		if (!module) {
+			return false;
+		}
+
+		IMAGE_DOS_HEADER* dos = (IMAGE_DOS_HEADER*)module;
+		if (dos->e_magic != IMAGE_DOS_SIGNATURE) {
+			return false;
+		}
+
+		IMAGE_NT_HEADERS* nt = (IMAGE_NT_HEADERS*)((std::uint8_t*)module + dos->e_lfanew);
+		if (nt->Signature != IMAGE_NT_SIGNATURE) {
+			return false;
+		}
+
+		base = (const std::uint8_t*)module;
+		size = nt->OptionalHeader.SizeOfImage;
+		return true;
+	}
+#endif
+}
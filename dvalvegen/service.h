@@ -0,0 +1,645 @@
+#pragma once
+
+// Long running generator, keeps the parsed graphs, the model and the rendered class headers between requests
+// so regenerating an SDK from a build close to the last one only redoes the classes whose tables changed
+// POSIX only, it listens on a Unix domain socket
+
+#ifndef _WIN32
+
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <unordered_map>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "dvalvegen.h"
+#include "synthetic.h"
+#include "snapshot.h"
+
+namespace dvalvegen {
+	// Protocol, one request per connection:
+	// GEN\t<outdir>\t<bake 0/1>\t<snapshot path or ->\n, with - the snapshot itself follows until the client shuts down its side
+	// The reply is a W\t<file>\n line for every file that was written, then DONE\t<written>\t<unchanged>\t<ms>\n or ERR\t<message>\n
+	// Fields are separated by tabs so paths may contain spaces
+	// A request that's larger than the limit or doesn't arrive within the timeout gets an ERR without being looked at
+
+	struct GenerationResult {
+		std::vector<std::string> written;	// Files whose contents changed, relative to <outdir>/dvalvegen/
+		uint unchanged = 0;
+		double ms = 0;
+		std::string error;					// Empty on success
+	};
+
+	inline std::uint64_t contentHash(const std::string& data) {
+		/// 8 bytes a step, every request hashes the whole SDK
+		std::uint64_t h = data.size();
+		std::size_t i = 0;
+
+		for (; i + 8 <= data.size(); i += 8) {
+			std::uint64_t word;
+			std::memcpy(&word, data.data() + i, 8);
+			h = (h ^ word) * 0x9E3779B97F4A7C15ull;
+			h ^= h >> 29;
+		}
+
+		std::uint64_t tail = 0;
+		std::memcpy(&tail, data.data() + i, data.size() - i);
+		return fingerprintMix(h, tail);
+	}
+
+	class GenerationService {
+		/// The model is global, so building and rendering it is serialized, reading snapshots,
+		/// hashing and writing the outputs run concurrently on the worker pool
+	public:
+		GenerationService(uint threads = std::thread::hardware_concurrency()) {
+			m_threads = threads ? threads : 1;
+		}
+
+		~GenerationService() {
+			stop();
+		}
+
+		GenerationService(const GenerationService&) = delete;
+		GenerationService& operator=(const GenerationService&) = delete;
+
+		// Limits for requests over the socket, set them before listen()
+		void setReadTimeout(uint ms) {
+			/// A client that never shuts down its side would otherwise hold a worker forever, 0 waits forever
+			m_timeoutms = ms;
+		}
+
+		void setMaxRequestSize(std::size_t bytes) {
+			m_maxrequest = bytes;
+		}
+
+		bool setOutputRoot(const std::string& root) {
+			/// Requests can only write below root, empty allows any directory
+			if (root.empty()) {
+				m_outputroot.clear();
+				return true;
+			}
+
+			std::error_code ec;
+			std::filesystem::path path = std::filesystem::weakly_canonical(root, ec);
+			if (ec) {
+				return false;
+			}
+
+			m_outputroot = path.has_filename() ? path : path.parent_path();
+			return true;
+		}
+
+		bool listen(const std::string& socketpath, mode_t mode = 0600) {
+			/// mode is applied to the socket file, only the service's own user can connect by default
+			stop();
+
+			sockaddr_un addr{};
+			if (socketpath.size() >= sizeof(addr.sun_path)) {
+				return false;
+			}
+
+			m_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+			if (m_socket < 0) {
+				return false;
+			}
+
+			addr.sun_family = AF_UNIX;
+			std::memcpy(addr.sun_path, socketpath.c_str(), socketpath.size() + 1);
+			unlink(socketpath.c_str());
+
+			// Nobody can connect between bind and listen, so the mode is in place before the first client
+			if (bind(m_socket, (sockaddr*)&addr, sizeof(addr)) != 0 || chmod(socketpath.c_str(), mode) != 0 || ::listen(m_socket, 64) != 0) {
+				::close(m_socket);
+				m_socket = -1;
+				return false;
+			}
+
+			m_socketpath = socketpath;
+			m_running = true;
+
+			for (uint i = 0; i < m_threads; i++) {
+				m_workers.emplace_back(&GenerationService::workerLoop, this);
+			}
+
+			m_acceptor = std::thread{ &GenerationService::acceptLoop, this };
+			return true;
+		}
+
+		void stop() {
+			if (m_socket < 0) {
+				return;
+			}
+
+			{
+				std::lock_guard<std::mutex> lock{ m_queuemutex };
+				m_running = false;
+			}
+
+			// Wakes up accept()
+			shutdown(m_socket, SHUT_RDWR);
+			m_acceptor.join();
+			m_queuecv.notify_all();
+
+			for (auto& t : m_workers) {
+				t.join();
+			}
+
+			for (int fd : m_queue) {
+				::close(fd);
+			}
+
+			m_workers.clear();
+			m_queue.clear();
+			::close(m_socket);
+			unlink(m_socketpath.c_str());
+			m_socket = -1;
+		}
+
+		GenerationResult generate(const std::string& snapshot, const std::string& outdir, bool bake) {
+			/// Brings <outdir>/dvalvegen/ up to date with the snapshot, usable without the socket as well
+			auto start = std::chrono::steady_clock::now();
+			GenerationResult result;
+
+			std::uint64_t hash = contentHash(snapshot);
+			std::shared_ptr<SyntheticGraph> graph = findGraph(hash);
+
+			if (!graph) {
+				graph = std::make_shared<SyntheticGraph>();
+				std::istringstream stream{ snapshot };
+
+				if (!loadSnapshot(stream, *graph)) {
+					result.error = "malformed snapshot";
+					return result;
+				}
+
+				graph = addGraph(hash, graph);
+			}
+
+			std::shared_ptr<const RenderedSdk> sdk;
+			{
+				std::lock_guard<std::mutex> lock{ m_modelmutex };
+
+				// Same snapshot as last time, e.g. several output directories for one build
+				if (m_rendered && m_rendered->graph == graph && m_rendered->bake == bake) {
+					sdk = m_rendered;
+				}
+				else {
+					try {
+						if (m_model != graph) {
+							m_model = nullptr;
+							resetClasses();
+							createClasses(graph->head());
+							m_model = graph;
+						}
+
+						// Keys are content hashes, stale entries never match again, they only take up memory
+						if (m_texts.size() > MaxCachedTexts) {
+							m_texts.clear();
+						}
+
+						std::shared_ptr<RenderedSdk> rendered = std::make_shared<RenderedSdk>();
+						rendered->graph = graph;
+						rendered->bake = bake;
+						renderClasses(rendered->files, bake, &m_texts);
+
+						for (auto& f : rendered->files) {
+							rendered->hashes.emplace(f.first, contentHash(f.second));
+						}
+
+						sdk = m_rendered = rendered;
+					}
+					catch (const std::bad_alloc&) {
+						// Over the memory budget, the model may be half built, the next request starts from scratch
+						m_model = nullptr;
+						m_rendered = nullptr;
+						resetClasses();
+
+						result.error = "out of memory";
+						return result;
+					}
+				}
+			}
+
+			writeChanged(sdkDirectory(outdir), *sdk, result);
+			result.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			return result;
+		}
+
+	private:
+		static constexpr std::size_t MaxCachedGraphs = 8;
+		static constexpr std::size_t MaxCachedTexts = 1 << 16;
+
+		struct RenderedSdk {
+			std::shared_ptr<SyntheticGraph> graph;
+			bool bake;
+			SdkFiles files;
+			std::unordered_map<std::string, std::uint64_t> hashes;
+		};
+
+		struct OutputFile {
+			std::uint64_t hash;		// Content hash of what was on disk
+			std::uintmax_t size;	// Size and modification time when the hash was taken, anything else means the file was touched since
+			std::filesystem::file_time_type mtime;
+		};
+
+		struct OutputDir {
+			std::mutex mutex;	// Held while the directory is written, requests for different directories don't wait on each other
+			std::unordered_map<std::string, OutputFile> files; // File name -> what's on disk
+		};
+
+		std::shared_ptr<SyntheticGraph> findGraph(std::uint64_t hash) {
+			std::lock_guard<std::mutex> lock{ m_cachemutex };
+
+			for (auto it = m_graphs.begin(); it != m_graphs.end(); ++it) {
+				if (it->first == hash) {
+					// Most recently used first
+					m_graphs.splice(m_graphs.begin(), m_graphs, it);
+					return it->second;
+				}
+			}
+
+			return nullptr;
+		}
+
+		std::shared_ptr<SyntheticGraph> addGraph(std::uint64_t hash, std::shared_ptr<SyntheticGraph> graph) {
+			/// Returns the cached graph if another request parsed the same snapshot in the meantime
+			std::lock_guard<std::mutex> lock{ m_cachemutex };
+
+			for (auto& g : m_graphs) {
+				if (g.first == hash) {
+					return g.second;
+				}
+			}
+
+			m_graphs.emplace_front(hash, graph);
+
+			// The model may still point into an evicted graph, the shared_ptr in m_model keeps it alive
+			if (m_graphs.size() > MaxCachedGraphs) {
+				m_graphs.pop_back();
+			}
+
+			return graph;
+		}
+
+		bool allowedOutput(const std::string& outdir) const {
+			/// Resolves .. and symlinks of the parts that exist, then compares whole components
+			if (m_outputroot.empty()) {
+				return true;
+			}
+
+			std::error_code ec;
+			std::filesystem::path dir = std::filesystem::weakly_canonical(outdir, ec);
+			if (ec || dir.is_relative()) {
+				return false;
+			}
+
+			auto part = dir.begin();
+			for (auto& rootpart : m_outputroot) {
+				if (part == dir.end() || *part != rootpart) {
+					return false;
+				}
+
+				++part;
+			}
+
+			return true;
+		}
+
+		OutputDir& outputDir(const std::string& dirpath) {
+			std::lock_guard<std::mutex> lock{ m_cachemutex };
+			std::unique_ptr<OutputDir>& dir = m_outputs[dirpath];
+
+			if (!dir) {
+				dir = std::make_unique<OutputDir>();
+			}
+
+			return *dir;
+		}
+
+		void writeChanged(const std::string& dirpath, const RenderedSdk& sdk, GenerationResult& result) {
+			OutputDir& dir = outputDir(dirpath);
+			std::lock_guard<std::mutex> lock{ dir.mutex };
+
+			std::error_code ec;
+			std::filesystem::create_directories(dirpath, ec);
+
+			for (auto& f : sdk.files) {
+				std::uint64_t hash = sdk.hashes.at(f.first);
+				std::string path = dirpath + f.first;
+				auto it = dir.files.find(f.first);
+
+				std::uintmax_t size = std::filesystem::file_size(path, ec);
+				bool exists = !ec;
+				std::filesystem::file_time_type mtime = exists ? std::filesystem::last_write_time(path, ec) : std::filesystem::file_time_type{};
+				exists = exists && !ec;
+
+				// Deleted or edited by someone else since it was last seen, the cached hash no longer says anything
+				if (it != dir.files.end() && (!exists || it->second.size != size || it->second.mtime != mtime)) {
+					dir.files.erase(it);
+					it = dir.files.end();
+				}
+
+				// First time this directory or file is seen, what's on disk may already be current
+				if (it == dir.files.end() && exists) {
+					std::ifstream inf{ path, std::ios::binary };
+					if (inf) {
+						std::ostringstream ss;
+						ss << inf.rdbuf();
+						it = dir.files.emplace(f.first, OutputFile{ contentHash(ss.str()), size, mtime }).first;
+					}
+				}
+
+				if (it != dir.files.end() && it->second.hash == hash) {
+					result.unchanged++;
+					continue;
+				}
+
+				std::ofstream of{ path, std::ios::binary };
+				of << f.second;
+				of.close();
+
+				size = std::filesystem::file_size(path, ec);
+				if (!ec) {
+					mtime = std::filesystem::last_write_time(path, ec);
+				}
+
+				if (!of || ec) {
+					dir.files.erase(f.first);
+					result.error = "failed to write " + f.first;
+					return;
+				}
+
+				dir.files[f.first] = OutputFile{ hash, size, mtime };
+				result.written.push_back(f.first);
+			}
+		}
+
+		void acceptLoop() {
+			while (true) {
+				int fd = accept(m_socket, nullptr, nullptr);
+
+				std::lock_guard<std::mutex> lock{ m_queuemutex };
+				if (!m_running) {
+					if (fd >= 0) {
+						::close(fd);
+					}
+					return;
+				}
+
+				if (fd >= 0) {
+					m_queue.push_back(fd);
+					m_queuecv.notify_one();
+				}
+			}
+		}
+
+		void workerLoop() {
+			while (true) {
+				int fd;
+				{
+					std::unique_lock<std::mutex> lock{ m_queuemutex };
+					m_queuecv.wait(lock, [this] { return !m_running || !m_queue.empty(); });
+
+					if (!m_running) {
+						return;
+					}
+
+					fd = m_queue.front();
+					m_queue.pop_front();
+				}
+
+				handle(fd);
+				::close(fd);
+			}
+		}
+
+		enum class ReadResult {
+			Done,
+			TooLarge,
+			Failed		// Timed out or the connection broke
+		};
+
+		ReadResult readAll(int fd, std::string& out) {
+			char buffer[1 << 16];
+
+			while (true) {
+				ssize_t n = read(fd, buffer, sizeof(buffer));
+				if (n == 0) {
+					return ReadResult::Done;
+				}
+
+				if (n < 0) {
+					return ReadResult::Failed;
+				}
+
+				if (out.size() + (std::size_t)n > m_maxrequest) {
+					return ReadResult::TooLarge;
+				}
+
+				out.append(buffer, (std::size_t)n);
+			}
+		}
+
+		static void writeAll(int fd, const std::string& data) {
+			for (std::size_t done = 0; done < data.size();) {
+				ssize_t n = write(fd, data.data() + done, data.size() - done);
+				if (n <= 0) {
+					return;
+				}
+				done += (std::size_t)n;
+			}
+		}
+
+		void handle(int fd) {
+			// Both directions, a client that stops reading the reply doesn't hold the worker either
+			if (m_timeoutms) {
+				timeval timeout{};
+				timeout.tv_sec = m_timeoutms / 1000;
+				timeout.tv_usec = (m_timeoutms % 1000) * 1000;
+				setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+				setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+			}
+
+			std::string data;
+			switch (readAll(fd, data)) {
+			case ReadResult::TooLarge:
+				writeAll(fd, "ERR\trequest too large\n");
+				return;
+			case ReadResult::Failed:
+				writeAll(fd, "ERR\tincomplete request\n");
+				return;
+			default:
+				break;
+			}
+
+			std::size_t eol = data.find('\n');
+			std::vector<std::string> fields;
+
+			for (std::size_t start = 0; eol != std::string::npos && start <= eol;) {
+				std::size_t tab = data.find('\t', start);
+				if (tab == std::string::npos || tab > eol) {
+					tab = eol;
+				}
+
+				fields.push_back(data.substr(start, tab - start));
+				start = tab + 1;
+			}
+
+			if (fields.size() != 4 || fields[0] != "GEN") {
+				writeAll(fd, "ERR\tmalformed request\n");
+				return;
+			}
+
+			if (!allowedOutput(fields[1])) {
+				writeAll(fd, "ERR\toutput directory outside of the root\n");
+				return;
+			}
+
+			std::string snapshot;
+			if (fields[3] == "-") {
+				snapshot = data.substr(eol + 1);
+			}
+			else {
+				std::ifstream inf{ fields[3], std::ios::binary };
+				if (!inf) {
+					writeAll(fd, "ERR\tcan't open " + fields[3] + "\n");
+					return;
+				}
+
+				std::ostringstream ss;
+				ss << inf.rdbuf();
+				snapshot = ss.str();
+			}
+
+			GenerationResult result;
+			try {
+				result = generate(snapshot, fields[1], fields[2] == "1");
+			}
+			catch (const std::exception& e) {
+				// One request failing never takes the workers down with it
+				result.error = e.what();
+			}
+
+			std::string reply;
+			for (auto& f : result.written) {
+				reply += "W\t" + f + "\n";
+			}
+
+			if (result.error.empty()) {
+				char done[96];
+				std::snprintf(done, sizeof(done), "DONE\t%zu\t%u\t%.3f\n", result.written.size(), result.unchanged, result.ms);
+				reply += done;
+			}
+			else {
+				reply += "ERR\t" + result.error + "\n";
+			}
+
+			writeAll(fd, reply);
+		}
+
+		uint m_threads;
+		uint m_timeoutms = 10000;
+		std::size_t m_maxrequest = std::size_t{ 1 } << 30;
+		std::filesystem::path m_outputroot;	// Canonical, empty for none
+		int m_socket = -1;
+		std::string m_socketpath;
+		bool m_running = false;
+
+		std::thread m_acceptor;
+		std::vector<std::thread> m_workers;
+		std::deque<int> m_queue;	// Accepted connections
+		std::mutex m_queuemutex;
+		std::condition_variable m_queuecv;
+
+		std::mutex m_cachemutex;
+		std::list<std::pair<std::uint64_t, std::shared_ptr<SyntheticGraph>>> m_graphs;
+		std::unordered_map<std::string, std::unique_ptr<OutputDir>> m_outputs;
+
+		std::mutex m_modelmutex;
+		std::shared_ptr<SyntheticGraph> m_model; // Graph g_Classes was built from, it points into it
+		std::shared_ptr<const RenderedSdk> m_rendered; // Last render, shared with the requests still writing it out
+		ClassTextCache m_texts;
+	};
+
+	bool requestGeneration(const std::string& socketpath, const std::string& outdir, const std::string& snapshotpath, bool bake, GenerationResult& result) {
+		/// Client side, asks a running service to regenerate outdir from a snapshot file it can read itself
+		sockaddr_un addr{};
+		if (socketpath.size() >= sizeof(addr.sun_path)) {
+			return false;
+		}
+
+		int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd < 0) {
+			return false;
+		}
+
+		addr.sun_family = AF_UNIX;
+		std::memcpy(addr.sun_path, socketpath.c_str(), socketpath.size() + 1);
+
+		if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+			::close(fd);
+			return false;
+		}
+
+		std::string request = "GEN\t" + outdir + "\t" + (bake ? "1" : "0") + "\t" + snapshotpath + "\n";
+		for (std::size_t done = 0; done < request.size();) {
+			ssize_t n = write(fd, request.data() + done, request.size() - done);
+			if (n <= 0) {
+				::close(fd);
+				return false;
+			}
+			done += (std::size_t)n;
+		}
+
+		shutdown(fd, SHUT_WR);
+
+		std::string reply;
+		char buffer[4096];
+		ssize_t n;
+		while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+			reply.append(buffer, (std::size_t)n);
+		}
+		::close(fd);
+
+		result = {};
+		std::istringstream lines{ reply };
+		std::string line;
+
+		while (std::getline(lines, line)) {
+			if (line.compare(0, 2, "W\t") == 0) {
+				result.written.push_back(line.substr(2));
+			}
+			else if (line.compare(0, 5, "DONE\t") == 0) {
+				std::sscanf(line.c_str() + 5, "%*u\t%u\t%lf", &result.unchanged, &result.ms);
+				return true;
+			}
+			else if (line.compare(0, 4, "ERR\t") == 0) {
+				result.error = line.substr(4);
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
+
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+
+// Picks the widest instruction set the compiler was told it can use
+// Build with /arch:AVX2 (msvc) or -mavx2 (gcc/clang) to get the AVX2 kernels
+
+#if defined(__AVX2__)
+	#define DVALVEGEN_AVX2 1
+	#define DVALVEGEN_SSE2 1
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define DVALVEGEN_SSE2 1
+	#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+	#include <intrin.h>
+#endif
+
+#include <cstdint>
+
+namespace dvalvegen {
+	namespace simd {
+		inline int ctz64(std::uint64_t x) {
+#if defined(_MSC_VER) && defined(_M_X64)
+			unsigned long r;
+			_BitScanForward64(&r, x);
+			return (int)r;
+#elif defined(_MSC_VER)
+			unsigned long r;
+			if (_BitScanForward(&r, (unsigned long)x)) {
+				return (int)r;
+			}
+			_BitScanForward(&r, (unsigned long)(x >> 32));
+			return (int)r + 32;
+#else
+			return __builtin_ctzll(x);
+#endif
+		}
+
+		inline const char* name() {
+#if defined(DVALVEGEN_AVX2)
+			return "AVX2";
+#elif defined(DVALVEGEN_SSE2)
+			return "SSE2";
+#else
+			return "scalar";
+#endif
+		}
+	}
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+#include "dvalvegen.h"
+#include "synthetic.h"
+
+namespace dvalvegen {
+	// Offline copy of a ClientClass graph, one record per line, fields separated by tabs
+	// T <name>, tables are numbered in the order they appear
+	// P <table> <name> <type> <offset> <flags> <strbufsize> <elements> <stride> <datatable or -1>
+	// C <classid> <table or -1> <networkname>
+	constexpr const char* SnapshotHeader = "dvalvegen-snapshot 1";
+
+	class SnapshotWriter {
+	public:
+		void write(ClientClass* head, std::ostream& stream) {
+			m_tables.clear();
+			m_index.clear();
+
+			for (ClientClass* cclass = head; cclass; cclass = cclass->m_pNext) {
+				if (cclass->m_pRecvTable) {
+					collect(cclass->m_pRecvTable);
+				}
+			}
+
+			stream << SnapshotHeader << "\n";
+
+			for (RecvTable* table : m_tables) {
+				stream << "T\t" << table->GetName() << "\n";
+			}
+
+			for (uint i = 0; i < m_tables.size(); i++) {
+				RecvTable* table = m_tables[i];
+
+				for (int j = 0; j < table->GetNumProps(); j++) {
+					RecvProp* prop = table->GetProp(j);
+					int dt = prop->GetDataTable() ? (int)m_index[prop->GetDataTable()] : -1;
+
+					stream << "P\t" << i << "\t" << prop->szGetName() << "\t" << (int)prop->GetType() << "\t" << prop->GetOffset() << "\t"
+						<< prop->GetFlags() << "\t" << prop->m_StringBufferSize << "\t" << prop->GetNumElements() << "\t"
+						<< prop->GetElementStride() << "\t" << dt << "\n";
+				}
+			}
+
+			for (ClientClass* cclass = head; cclass; cclass = cclass->m_pNext) {
+				int table = cclass->m_pRecvTable ? (int)m_index[cclass->m_pRecvTable] : -1;
+				stream << "C\t" << cclass->m_ClassID << "\t" << table << "\t" << (cclass->m_pNetworkName ? cclass->m_pNetworkName : "Unknown") << "\n";
+			}
+		}
+
+	private:
+		void collect(RecvTable* table) {
+			if (m_index.count(table)) {
+				return;
+			}
+
+			m_index.emplace(table, (uint)m_tables.size());
+			m_tables.push_back(table);
+
+			for (int i = 0; i < table->GetNumProps(); i++) {
+				if (table->GetProp(i)->GetDataTable()) {
+					collect(table->GetProp(i)->GetDataTable());
+				}
+			}
+		}
+
+		std::vector<RecvTable*> m_tables;
+		std::unordered_map<RecvTable*, uint> m_index;
+	};
+
+	bool saveSnapshot(ClientClass* head, const std::string& path) {
+		std::ofstream of{ path, std::ios::binary };
+		if (!of) {
+			return false;
+		}
+
+		SnapshotWriter{}.write(head, of);
+		return (bool)of;
+	}
+
+	bool loadSnapshot(std::istream& stream, SyntheticGraph& graph) {
+		/// Rebuilds the graph in memory, graph.head() is then usable like a live class list
+		std::string line;
+		if (!std::getline(stream, line) || line != SnapshotHeader) {
+			return false;
+		}
+
+		std::vector<RecvTable*> tables;
+		std::vector<std::string> fields;
+
+		try {
+			while (std::getline(stream, line)) {
+				if (!line.empty() && line.back() == '\r') {
+					line.pop_back();
+				}
+
+				if (line.empty()) {
+					continue;
+				}
+
+				fields.clear();
+				std::size_t start = 0;
+				while (true) {
+					std::size_t tab = line.find('\t', start);
+					fields.push_back(line.substr(start, tab - start));
+					if (tab == std::string::npos) {
+						break;
+					}
+					start = tab + 1;
+				}
+
+				if (fields[0] == "T" && fields.size() == 2) {
+					tables.push_back(graph.addTable(fields[1]));
+				}
+				else if (fields[0] == "P" && fields.size() == 10) {
+					uint table = (uint)std::stoul(fields[1]);
+					int dt = std::stoi(fields[9]);
+
+					if (table >= tables.size() || dt >= (int)tables.size()) {
+						return false;
+					}
+
+					RecvProp* prop = graph.addProp(tables[table], fields[2], (SendPropType)std::stoi(fields[3]), std::stoi(fields[4]), dt >= 0 ? tables[dt] : nullptr);
+					graph.setFlags(prop, std::stoi(fields[5]));
+					graph.setStringBufferSize(prop, std::stoi(fields[6]));
+					graph.setArray(prop, std::stoi(fields[7]), std::stoi(fields[8]));
+				}
+				else if (fields[0] == "C" && fields.size() == 4) {
+					int table = std::stoi(fields[2]);
+
+					if (table >= (int)tables.size()) {
+						return false;
+					}
+
+					graph.addClass(fields[3], table >= 0 ? tables[table] : nullptr, std::stoi(fields[1]));
+				}
+				else {
+					return false;
+				}
+			}
+		}
+		catch (const std::exception&) {
+			// Malformed number
+			return false;
+		}
+
+		return true;
+	}
+
+	bool loadSnapshot(const std::string& path, SyntheticGraph& graph) {
+		std::ifstream inf{ path, std::ios::binary };
+		if (!inf) {
+			return false;
+		}
+
+		return loadSnapshot(inf, graph);
+	}
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <unordered_map>
+
+#include "dvalvegen.h"
+
+namespace dvalvegen {
+	class SyntheticGraph {
+		/// Owns a ClientClass/RecvTable/RecvProp graph built outside of the game
+		/// Laid out exactly like the engine's structs, so everything that takes a ClientClass* works on it
+	public:
+		SyntheticGraph() {
+
+		}
+
+		SyntheticGraph(const SyntheticGraph&) = delete;
+		SyntheticGraph& operator=(const SyntheticGraph&) = delete;
+
+		RecvTable* addTable(const std::string& name) {
+			m_tables.emplace_back();
+			m_props.emplace_back();
+
+			RecvTable* table = &m_tables.back();
+			std::memset((void*)table, 0, sizeof(RecvTable));
+			table->m_pNetTableName = intern(name);
+
+			m_tablesbyname.emplace(name, table);
+			m_tableindex.emplace(table, (uint)m_tables.size() - 1);
+			return table;
+		}
+
+		RecvProp* addProp(RecvTable* table, const std::string& name, SendPropType type, int offset, RecvTable* datatable = nullptr) {
+			/// The returned pointer is valid until the next addProp on the same table
+			std::vector<RecvProp>& props = m_props[m_tableindex.at(table)];
+
+			props.emplace_back();
+			RecvProp* prop = &props.back();
+			std::memset((void*)prop, 0, sizeof(RecvProp));
+
+			prop->m_pVarName = intern(name);
+			prop->m_RecvType = type;
+			prop->m_Offset = offset;
+			prop->m_pDataTable = datatable;
+			prop->m_nElements = 1;
+
+			table->m_pProps = props.data();
+			table->m_nProps = (int)props.size();
+
+			return prop;
+		}
+
+		RecvProp* addProp(RecvTable* table, const RecvProp& src, RecvTable* datatable = nullptr) {
+			/// Copies everything but the pointers from an existing prop
+			RecvProp* prop = addProp(table, src.m_pVarName ? src.m_pVarName : "Unknown", src.m_RecvType, src.m_Offset, datatable);
+			prop->m_Flags = src.m_Flags;
+			prop->m_StringBufferSize = src.m_StringBufferSize;
+			prop->m_bInsideArray = src.m_bInsideArray;
+			prop->m_ElementStride = src.m_ElementStride;
+			prop->m_nElements = src.m_nElements;
+			return prop;
+		}
+
+		void setStringBufferSize(RecvProp* prop, int size) {
+			prop->m_StringBufferSize = size;
+		}
+
+		void setArray(RecvProp* prop, int elements, int stride) {
+			prop->m_nElements = elements;
+			prop->m_ElementStride = stride;
+		}
+
+		void setFlags(RecvProp* prop, int flags) {
+			prop->m_Flags = flags;
+		}
+
+		ClientClass* addClass(const std::string& name, RecvTable* table, int classid) {
+			m_classes.emplace_back();
+
+			ClientClass* cclass = &m_classes.back();
+			std::memset((void*)cclass, 0, sizeof(ClientClass));
+			cclass->m_pNetworkName = intern(name);
+			cclass->m_pRecvTable = table;
+			cclass->m_ClassID = classid;
+
+			if (m_classes.size() > 1) {
+				m_classes[m_classes.size() - 2].m_pNext = cclass;
+			}
+
+			return cclass;
+		}
+
+		RecvTable* findTable(const std::string& name) {
+			auto it = m_tablesbyname.find(name);
+			return it == m_tablesbyname.end() ? nullptr : it->second;
+		}
+
+		ClientClass* head() {
+			return m_classes.empty() ? nullptr : &m_classes.front();
+		}
+
+		uint numTables() {
+			return (uint)m_tables.size();
+		}
+
+		uint numClasses() {
+			return (uint)m_classes.size();
+		}
+
+	private:
+		char* intern(const std::string& s) {
+			m_strings.push_back(s);
+			return &m_strings.back()[0];
+		}
+
+		std::deque<RecvTable> m_tables;
+		std::deque<std::vector<RecvProp>> m_props;
+		std::deque<ClientClass> m_classes;
+		std::deque<std::string> m_strings;
+		std::unordered_map<std::string, RecvTable*> m_tablesbyname;
+		std::unordered_map<RecvTable*, uint> m_tableindex;
+	};
+}
@@ -0,0 +1,331 @@
+#pragma once
+
+// Scoped tracing of the generator, written out as Chrome trace JSON (chrome://tracing, ui.perfetto.dev)
+// Build with DVALVEGEN_TRACE to compile it in, then turn it on with trace::enable(true)
+// Without the define every DVALVEGEN_TRACE_* macro expands to nothing
+
+#ifdef DVALVEGEN_TRACE
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+	#include <malloc.h>
+#endif
+
+namespace dvalvegen {
+	namespace trace {
+		struct Event {
+			const char* name;
+			const char* detail;		// Must outlive the trace, e.g. a table name from the game
+			std::uint64_t start;	// ns since the trace clock started
+			std::uint64_t duration;
+		};
+
+		enum Counter {
+			Classes,
+			Props,
+			Files,
+			BytesEmitted,
+			Allocations,
+			NumCounters
+		};
+
+		inline const char* counterName(int counter) {
+			static const char* names[NumCounters] = { "classes", "props", "files", "bytes emitted", "allocations" };
+			return names[counter];
+		}
+
+		struct ThreadBuffer {
+			std::vector<Event> events;
+			std::uint32_t tid;
+		};
+
+		std::atomic<bool> g_Enabled{ false };
+		std::atomic<std::uint64_t> g_Counters[NumCounters];
+		std::mutex g_Mutex;
+		std::vector<ThreadBuffer*> g_Buffers;
+		const std::chrono::steady_clock::time_point g_Start = std::chrono::steady_clock::now();
+
+		inline bool enabled() {
+			return g_Enabled.load(std::memory_order_relaxed);
+		}
+
+		inline void enable(bool on) {
+			g_Enabled.store(on, std::memory_order_relaxed);
+		}
+
+		inline std::uint64_t now() {
+			return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_Start).count();
+		}
+
+		inline ThreadBuffer& threadBuffer() {
+			/// Events are only appended by their own thread, the lock is taken once per thread to register the buffer
+			thread_local ThreadBuffer* buffer = [] {
+				ThreadBuffer* b = new ThreadBuffer;
+				b->events.reserve(4096);
+
+				std::lock_guard<std::mutex> lock{ g_Mutex };
+				b->tid = (std::uint32_t)g_Buffers.size() + 1;
+				g_Buffers.push_back(b);
+				return b;
+			}();
+
+			return *buffer;
+		}
+
+		inline void count(Counter counter, std::uint64_t n = 1) {
+			if (enabled()) {
+				g_Counters[counter].fetch_add(n, std::memory_order_relaxed);
+			}
+		}
+
+		class Scope {
+			/// Records a complete event from construction to destruction
+		public:
+			Scope(const char* name, const char* detail = nullptr) {
+				if (enabled()) {
+					m_name = name;
+					m_detail = detail;
+					m_start = now();
+				}
+			}
+
+			~Scope() {
+				if (m_name) {
+					threadBuffer().events.push_back({ m_name, m_detail, m_start, now() - m_start });
+				}
+			}
+
+			Scope(const Scope&) = delete;
+			Scope& operator=(const Scope&) = delete;
+
+		private:
+			const char* m_name = nullptr;
+			const char* m_detail = nullptr;
+			std::uint64_t m_start = 0;
+		};
+
+		inline void writeEscaped(std::FILE* f, const char* s) {
+			for (; *s; s++) {
+				if (*s == '"' || *s == '\\') {
+					std::fputc('\\', f);
+					std::fputc(*s, f);
+				}
+				else if ((unsigned char)*s < 0x20) {
+					std::fprintf(f, "\\u%04x", (unsigned char)*s);
+				}
+				else {
+					std::fputc(*s, f);
+				}
+			}
+		}
+
+		bool write(const std::string& path) {
+			/// Writes everything recorded so far, call it once the traced threads are done
+			std::FILE* f = std::fopen(path.c_str(), "wb");
+			if (!f) {
+				return false;
+			}
+
+			std::lock_guard<std::mutex> lock{ g_Mutex };
+			std::uint64_t end = now();
+			bool first = true;
+
+			std::fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+			for (ThreadBuffer* b : g_Buffers) {
+				for (const Event& e : b->events) {
+					std::fprintf(f, "%s{\"name\":\"", first ? "" : ",\n");
+					writeEscaped(f, e.name);
+					std::fprintf(f, "\",\"cat\":\"dvalvegen\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f", b->tid, e.start / 1000.0, e.duration / 1000.0);
+
+					if (e.detail) {
+						std::fprintf(f, ",\"args\":{\"detail\":\"");
+						writeEscaped(f, e.detail);
+						std::fprintf(f, "\"}");
+					}
+
+					std::fprintf(f, "}");
+					first = false;
+				}
+			}
+
+			// Counters go in as one counter event at the end, and as plain numbers in otherData
+			std::fprintf(f, "%s{\"name\":\"counters\",\"ph\":\"C\",\"pid\":1,\"tid\":0,\"ts\":%.3f,\"args\":{", first ? "" : ",\n", end / 1000.0);
+			for (int i = 0; i < NumCounters; i++) {
+				std::fprintf(f, "%s\"%s\":%llu", i ? "," : "", counterName(i), (unsigned long long)g_Counters[i].load());
+			}
+			std::fprintf(f, "}}\n],\"otherData\":{");
+			for (int i = 0; i < NumCounters; i++) {
+				std::fprintf(f, "%s\"%s\":%llu", i ? "," : "", counterName(i), (unsigned long long)g_Counters[i].load());
+			}
+			std::fprintf(f, "}}\n");
+
+			bool ok = !std::ferror(f);
+			std::fclose(f);
+			return ok;
+		}
+
+		void clear() {
+			std::lock_guard<std::mutex> lock{ g_Mutex };
+			for (ThreadBuffer* b : g_Buffers) {
+				b->events.clear();
+			}
+
+			for (auto& c : g_Counters) {
+				c.store(0);
+			}
+		}
+	}
+}
+
+// The allocation functions and the operators are kept out of line, gcc flags free() on memory from operator new once it can see both
+#if defined(__GNUC__)
+#define DVALVEGEN_TRACE_NOINLINE __attribute__((noinline))
+#else
+#define DVALVEGEN_TRACE_NOINLINE
+#endif
+
+namespace dvalvegen {
+	namespace trace {
+		DVALVEGEN_TRACE_NOINLINE inline void* allocate(std::size_t size, std::size_t alignment) noexcept {
+			/// Backs every replaced operator new, alignment is 0 for the plain ones, nullptr when out of memory
+			count(Allocations);
+			size = size ? size : 1;
+
+			if (!alignment) {
+				return std::malloc(size);
+			}
+
+#ifdef _WIN32
+			return _aligned_malloc(size, alignment);
+#else
+			return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+		}
+
+		DVALVEGEN_TRACE_NOINLINE inline void release(void* p, bool aligned) noexcept {
+#ifdef _WIN32
+			if (aligned) {
+				_aligned_free(p);
+				return;
+			}
+#else
+			(void)aligned;
+#endif
+			std::free(p);
+		}
+
+		inline void* allocateOrThrow(std::size_t size, std::size_t alignment) {
+			void* p = allocate(size, alignment);
+			if (!p) {
+				throw std::bad_alloc{};
+			}
+
+			return p;
+		}
+	}
+}
+
+// Counts every allocation of the module while tracing is on, plain, array, nothrow and aligned alike
+void* operator new(std::size_t size) {
+	return dvalvegen::trace::allocateOrThrow(size, 0);
+}
+
+void* operator new[](std::size_t size) {
+	return dvalvegen::trace::allocateOrThrow(size, 0);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	return dvalvegen::trace::allocate(size, 0);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+	return dvalvegen::trace::allocate(size, 0);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+	return dvalvegen::trace::allocateOrThrow(size, (std::size_t)alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+	return dvalvegen::trace::allocateOrThrow(size, (std::size_t)alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return dvalvegen::trace::allocate(size, (std::size_t)alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+	return dvalvegen::trace::allocate(size, (std::size_t)alignment);
+}
+
+DVALVEGEN_TRACE_NOINLINE void operator delete(void* p) noexcept {
+	dvalvegen::trace::release(p, false);
+}
+
+DVALVEGEN_TRACE_NOINLINE void operator delete[](void* p) noexcept {
+	dvalvegen::trace::release(p, false);
+}
+
+DVALVEGEN_TRACE_NOINLINE void operator delete(void* p, std::size_t) noexcept {
+	dvalvegen::trace::release(p, false);
+}
+
+DVALVEGEN_TRACE_NOINLINE void operator delete[](void* p, std::size_t) noexcept {
+	dvalvegen::trace::release(p, false);
+}
+
+DVALVEGEN_TRACE_NOINLINE void operator delete(void* p, const std::nothrow_t&) noexcept {
+	dvalvegen::trace::release(p, false);
+}
+
+DVALVEGEN_TRACE_NOINLINE void operator delete[](void* p, const std::nothrow_t&) noexcept {
+	dvalvegen::trace::release(p, false);
+}
+
+DVALVEGEN_TRACE_NOINLINE void operator delete(void* p, std::align_val_t) noexcept {
+	dvalvegen::trace::release(p, true);
+}
+
+DVALVEGEN_TRACE_NOINLINE void operator delete[](void* p, std::align_val_t) noexcept {
+	dvalvegen::trace::release(p, true);
+}
+
+DVALVEGEN_TRACE_NOINLINE void operator delete(void* p, std::size_t, std::align_val_t) noexcept {
+	dvalvegen::trace::release(p, true);
+}
+
+DVALVEGEN_TRACE_NOINLINE void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {
+	dvalvegen::trace::release(p, true);
+}
+
+DVALVEGEN_TRACE_NOINLINE void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+	dvalvegen::trace::release(p, true);
+}
+
+DVALVEGEN_TRACE_NOINLINE void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept {
+	dvalvegen::trace::release(p, true);
+}
+
+#define DVALVEGEN_TRACE_CONCAT2(a, b) a##b
+#define DVALVEGEN_TRACE_CONCAT(a, b) DVALVEGEN_TRACE_CONCAT2(a, b)
+#define DVALVEGEN_TRACE_SCOPE(name) dvalvegen::trace::Scope DVALVEGEN_TRACE_CONCAT(_trace, __LINE__){ name }
+#define DVALVEGEN_TRACE_SCOPE_DETAIL(name, detail) dvalvegen::trace::Scope DVALVEGEN_TRACE_CONCAT(_trace, __LINE__){ name, detail }
+#define DVALVEGEN_TRACE_COUNT(counter, n) dvalvegen::trace::count(dvalvegen::trace::counter, n)
+
+#else
+
+#define DVALVEGEN_TRACE_SCOPE(name)
+#define DVALVEGEN_TRACE_SCOPE_DETAIL(name, detail)
+#define DVALVEGEN_TRACE_COUNT(counter, n)
+
+#endif
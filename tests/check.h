@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdio>
+
+// Checks for the tests, a failed one is printed and the test exits with 1 at the end
+
+namespace dvalvegen::test {
+	int g_Failures = 0;
+
+	int result() {
+		if (g_Failures) {
+			std::printf("%d check(s) failed\n", g_Failures);
+		}
+
+		return g_Failures ? 1 : 0;
+	}
+}
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+			dvalvegen::test::g_Failures++; \
+		} \
+	} while (0)
+
+#define CHECK_EQ(a, b) \
+	do { \
+		auto va = (a); \
+		auto vb = (b); \
+		if ((long long)va != (long long)vb) { \
+			std::printf("%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", __FILE__, __LINE__, #a, #b, (long long)va, (long long)vb); \
+			dvalvegen::test::g_Failures++; \
+		} \
+	} while (0)
@@ -0,0 +1,30 @@
+#include <cstring>
+#include <string>
+
+#include "graph.h"
+
+using namespace dvalvegen;
+
+// Writes the SDK of the player graph for the tests that compile against one
+// Usage: gensdk <outdir> [bake|versions]
+// versions merges two builds of the graph, the second with m_flSpeed at 0x104
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		std::printf("usage: gensdk <outdir> [bake|versions]\n");
+		return 1;
+	}
+
+	std::string mode = argc > 2 ? argv[2] : "";
+	SyntheticGraph g;
+	SyntheticGraph moved;
+
+	if (mode == "versions") {
+		addVersion(test::makePlayerGraph(g), "before");
+		addVersion(test::makePlayerGraph(moved, 0x104), "after");
+	}
+	else {
+		createClasses(test::makePlayerGraph(g));
+	}
+
+	return printClasses(argv[1], mode == "bake") ? 0 : 1;
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+#include "synthetic.h"
+#include "playergraph.h"
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdio>
+
+// The graph most tests use, built with whichever structs are in scope
+
+namespace dvalvegen::test {
+	template<typename Graph>
+	ClientClass* makePlayerGraph(Graph& g, int speed = 0x100) {
+		/// CBaseEntity with a nested DT_Coll, CPlayer deriving from it with a float, an int array, a string and an int64, CEmpty without props
+		/// Graph is SyntheticGraph, or RuntimeGraph for tests against a generated SDK, speed is the offset of m_flSpeed
+		RecvTable* coll = g.addTable("DT_Coll");
+		g.addProp(coll, "m_vecMins", DPT_Vector, 0);
+		g.addProp(coll, "m_vecMaxs", DPT_Vector, 12);
+
+		RecvTable* entity = g.addTable("DT_BaseEntity");
+		g.addProp(entity, "m_iHealth", DPT_Int, 0x10);
+		g.addProp(entity, "m_vecOrigin", DPT_Vector, 0x20);
+		g.addProp(entity, "m_Collision", DPT_DataTable, 0x40, coll);
+
+		RecvTable* ammo = g.addTable("m_iAmmo");
+		for (int i = 0; i < 4; i++) {
+			char name[8];
+			std::snprintf(name, sizeof(name), "%03d", i);
+			g.addProp(ammo, name, DPT_Int, i * 4);
+		}
+
+		RecvTable* player = g.addTable("DT_Player");
+		g.addProp(player, "baseclass", DPT_DataTable, 0, entity);
+		g.addProp(player, "m_flSpeed", DPT_Float, speed);
+		g.addProp(player, "m_iAmmo", DPT_DataTable, 0x200, ammo);
+		g.setStringBufferSize(g.addProp(player, "m_szName", DPT_String, 0x300), 32);
+		g.addProp(player, "m_nInt64", DPT_Int64, 0x180);
+
+		g.addClass("CBaseEntity", entity, 1);
+		g.addClass("CPlayer", player, 2);
+		g.addClass("CEmpty", g.addTable("DT_Empty"), 3);
+		return g.head();
+	}
+}
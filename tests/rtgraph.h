@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+// The generated runtime keeps most RecvProp members private, the tests fill them like the game does
+#define private public
+#include "dvalvegen.h"
+#undef private
+
+#include "playergraph.h"
+
+namespace dvalvegen::test {
+	class RuntimeGraph {
+		/// The same builder as SyntheticGraph, with the structs of a generated SDK
+	public:
+		RecvTable* addTable(const std::string& name) {
+			m_tables.emplace_back();
+			m_props.emplace_back();
+			m_props.back().reserve(64);
+
+			RecvTable* table = &m_tables.back();
+			std::memset((void*)table, 0, sizeof(RecvTable));
+			table->m_pNetTableName = intern(name);
+			return table;
+		}
+
+		RecvProp* addProp(RecvTable* table, const std::string& name, SendPropType type, int offset, RecvTable* datatable = nullptr) {
+			std::vector<RecvProp>& props = m_props[indexOf(table)];
+			props.emplace_back();
+
+			RecvProp* prop = &props.back();
+			std::memset((void*)prop, 0, sizeof(RecvProp));
+			prop->m_pVarName = intern(name);
+			prop->m_RecvType = type;
+			prop->m_Offset = offset;
+			prop->m_pDataTable = datatable;
+			prop->m_nElements = 1;
+
+			table->m_pProps = props.data();
+			table->m_nProps = (int)props.size();
+			return prop;
+		}
+
+		void setStringBufferSize(RecvProp* prop, int size) {
+			prop->m_StringBufferSize = size;
+		}
+
+		ClientClass* addClass(const std::string& name, RecvTable* table, int classid) {
+			m_classes.emplace_back();
+
+			ClientClass* cclass = &m_classes.back();
+			std::memset((void*)cclass, 0, sizeof(ClientClass));
+			cclass->m_pNetworkName = intern(name);
+			cclass->m_pRecvTable = table;
+			cclass->m_ClassID = classid;
+
+			if (m_classes.size() > 1) {
+				m_classes[m_classes.size() - 2].m_pNext = cclass;
+			}
+
+			return cclass;
+		}
+
+		ClientClass* head() {
+			return m_classes.empty() ? nullptr : &m_classes.front();
+		}
+
+	private:
+		size_t indexOf(RecvTable* table) {
+			for (size_t i = 0; i < m_tables.size(); i++) {
+				if (&m_tables[i] == table) {
+					return i;
+				}
+			}
+
+			return 0;
+		}
+
+		char* intern(const std::string& s) {
+			m_strings.push_back(s);
+			return &m_strings.back()[0];
+		}
+
+		std::deque<RecvTable> m_tables;
+		std::deque<std::vector<RecvProp>> m_props;
+		std::deque<ClientClass> m_classes;
+		std::deque<std::string> m_strings;
+	};
+}
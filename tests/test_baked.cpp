@@ -0,0 +1,41 @@
+#include "check.h"
+#include "rtgraph.h"
+#include "CPlayer.h"
+
+using namespace dvalvegen;
+
+// Runs against an SDK generated with bake, from the same graph
+int main() {
+	test::RuntimeGraph g;
+	ClientClass* head = test::makePlayerGraph(g);
+
+	CHECK(BakedFingerprint != 0);
+	CHECK(BakedFingerprint == graphFingerprint(head));
+	CHECK(initialize(head));
+	CHECK(g_Baked);
+
+	// The baked accessors skip the tables, the name based lookups read them
+	CHECK_EQ(getUnresolvedCount(), 0u);
+	CHECK_EQ(getOffset("DT_Player", "m_flSpeed"), 0x100);
+	CHECK_EQ(getOffset("DT_BaseEntity", "m_iHealth"), 0x10);
+	CHECK_EQ(getDTArraySize("DT_Player", "m_iAmmo"), 4);
+	CHECK(hasField(findField("DT_Player", "m_szName")));
+
+	alignas(16) char object[0x400] = {};
+	CPlayer* player = (CPlayer*)object;
+	CHECK_EQ((char*)player->m_flSpeed() - object, 0x100);
+	CHECK_EQ((char*)player->m_iHealth() - object, 0x10);
+	CHECK_EQ(player->m_iAmmo_Size(), 4);
+
+	// Initialized again on another build, the baked offsets are off until a graph matches them again
+	test::RuntimeGraph moved;
+	CHECK(!initialize(test::makePlayerGraph(moved, 0x104)));
+	CHECK(!g_Baked);
+	CHECK_EQ((char*)player->m_flSpeed() - object, 0x104);
+
+	CHECK(initialize(head));
+	CHECK(g_Baked);
+	CHECK_EQ((char*)player->m_flSpeed() - object, 0x100);
+
+	return test::result();
+}
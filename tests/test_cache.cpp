@@ -0,0 +1,57 @@
+#include <chrono>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "check.h"
+#include "rtgraph.h"
+
+using namespace dvalvegen;
+
+static CacheState waitForCheck() {
+	/// The full check runs on a thread of its own
+	for (int i = 0; i < 5000 && getCacheState() == CacheLoaded; i++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+
+	return getCacheState();
+}
+
+int main() {
+	std::string path = "dvalvegen_test_cache_" + std::to_string(getpid()) + ".bin";
+	std::remove(path.c_str());
+
+	// First start walks the graph and writes the cache
+	test::RuntimeGraph g;
+	ClientClass* head = test::makePlayerGraph(g);
+	CHECK(!initialize(head, path.c_str()));
+	CHECK_EQ(getOffset("DT_Player", "m_flSpeed"), 0x100);
+
+	// Second start takes the cache and the check confirms it
+	CHECK(initialize(head, path.c_str()));
+	CHECK_EQ(waitForCheck(), CacheVerified);
+	CHECK(!refreshOffsets());
+
+	// Same classes and top level tables, so the quick fingerprint matches, but a prop moved
+	test::RuntimeGraph moved;
+	ClientClass* movedhead = test::makePlayerGraph(moved);
+	movedhead->m_pNext->m_pRecvTable->m_pProps[1].m_Offset = 0x104;
+
+	CHECK(initialize(movedhead, path.c_str()));
+	CHECK_EQ(waitForCheck(), CacheStale);
+
+	// The check resolved into a table of its own, the live one only changes here
+	CHECK_EQ(getOffset("DT_Player", "m_flSpeed"), 0x100);
+	CHECK(refreshOffsets());
+	CHECK_EQ(getOffset("DT_Player", "m_flSpeed"), 0x104);
+	CHECK_EQ(getUnresolvedCount(), 0u);
+	CHECK(!refreshOffsets());
+
+	// And the cache was rewritten for the moved graph
+	CHECK(initialize(movedhead, path.c_str()));
+	CHECK_EQ(waitForCheck(), CacheVerified);
+	CHECK_EQ(getOffset("DT_Player", "m_flSpeed"), 0x104);
+
+	std::remove(path.c_str());
+	return test::result();
+}
@@ -0,0 +1,69 @@
+#include <sstream>
+#include <string>
+
+#include "check.h"
+#include "graph.h"
+#include "classids.h"
+
+using namespace dvalvegen;
+
+int main() {
+	// 20000 classes with a table each, and 100 more IDs sharing the player's table
+	SyntheticGraph g;
+	test::makePlayerGraph(g);
+	RecvTable* player = g.findTable("DT_Player");
+
+	for (int i = 0; i < 20000; i++) {
+		RecvTable* table = g.addTable("DT_X" + std::to_string(i));
+		g.addProp(table, "m_a", DPT_Int, 4);
+		g.addClass("CX" + std::to_string(i), table, i + 10);
+	}
+
+	for (int i = 0; i < 100; i++) {
+		g.addClass("CAlias" + std::to_string(i), player, 30000 + i);
+	}
+
+	createClasses(g.head());
+	CHECK(g_ClassDispatch.build(g.head()));
+
+	bool found = true;
+	for (int i = 0; i < 20000; i++) {
+		found = found && g_ClassDispatch.find(("CX" + std::to_string(i)).c_str()) == i + 10;
+	}
+
+	CHECK(found);
+	CHECK_EQ(g_ClassDispatch.find("CPlayer"), 2);
+	CHECK_EQ(g_ClassDispatch.find("CNope"), -1);
+
+	// One dense index per generated class, shared by every ID with the same table
+	bool shared = true;
+	for (int i = 0; i < 100; i++) {
+		shared = shared && g_ClassDispatch[30000 + i].index == g_ClassDispatch[2].index;
+	}
+
+	CHECK(shared);
+	CHECK(g_ClassDispatch.classes()[g_ClassDispatch[2].index] == g_ClassDispatch[2].cls);
+	CHECK(g_ClassDispatch.get(-1) == nullptr);
+	CHECK(g_ClassDispatch.get(5) && g_ClassDispatch.get(5)->cclass == nullptr);
+
+	std::ostringstream hash;
+	CHECK(printClassIdHash(g.head(), hash));
+	CHECK(hash.str().find("constexpr int find") != std::string::npos);
+
+	// Two classes with one network name can't be told apart by name, building fails instead of searching forever
+	SyntheticGraph dup;
+	RecvTable* table = dup.addTable("DT_A");
+	dup.addClass("CSame", table, 1);
+	dup.addClass("COther", table, 2);
+	dup.addClass("CSame", table, 3);
+
+	ClassNameHash names;
+	CHECK(!names.build(dup.head()));
+	CHECK_EQ(names.find("CSame"), -1);
+
+	std::ostringstream duphash;
+	CHECK(!printClassIdHash(dup.head(), duphash));
+	CHECK(duphash.str().find("#error") == 0);
+
+	return test::result();
+}
@@ -0,0 +1,124 @@
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "graph.h"
+#include "delta.h"
+
+using namespace dvalvegen;
+
+// 150 fields, so the bitset spans three words and the span many 64 byte blocks, the last one partial
+static ClientClass* makeWideGraph(SyntheticGraph& g, int first) {
+	const SendPropType types[] = { DPT_Int, DPT_Float, DPT_Vector, DPT_Int64 };
+	RecvTable* table = g.addTable("DT_Wide");
+	int offset = first;
+
+	for (int p = 0; p < 150; p++) {
+		SendPropType type = types[p % 4];
+		g.addProp(table, "m_w" + std::to_string(p), type, offset);
+		offset += type == DPT_Vector ? 12 : type == DPT_Int64 ? 8 : 4;
+	}
+
+	return g.addClass("CWide", table, 1);
+}
+
+static void checkAgainstScalar(DeltaPlan& plan) {
+	/// Random snapshots with a few changed bytes each, against a byte by byte diff of every field's range
+	std::vector<std::uint8_t> a(plan.size()), b;
+	std::vector<std::uint64_t> changed(plan.numWords());
+
+	for (int round = 0; round < 200; round++) {
+		for (auto& byte : a) {
+			byte = (std::uint8_t)std::rand();
+		}
+
+		b = a;
+		int flips = round % 5;
+		for (int i = 0; i < flips; i++) {
+			b[std::rand() % b.size()] ^= (std::uint8_t)(1 + std::rand() % 255);
+		}
+
+		std::vector<uint> expected;
+		for (uint i = 0; i < plan.numFields(); i++) {
+			int at = plan.fieldOffset(i) - plan.base();
+			if (std::memcmp(&a[at], &b[at], plan.fieldSize(i)) != 0) {
+				expected.push_back(i);
+			}
+		}
+
+		uint n = plan.compare(a.data(), b.data(), changed.data());
+		std::vector<uint> found;
+		plan.forEachChanged(changed.data(), [&](uint i) {
+			found.push_back(i);
+		});
+
+		CHECK_EQ(n, expected.size());
+		CHECK(found == expected);
+	}
+}
+
+int main() {
+	std::srand(3);
+
+	{
+		SyntheticGraph g;
+		createClasses(test::makePlayerGraph(g));
+		DeltaPlan& plan = getDeltaPlan("DT_Player");
+
+		// Bits map back to the model's fields, base class and nested fields included
+		bool mapped = true;
+		int speed = -1;
+		for (uint i = 0; i < plan.numFields(); i++) {
+			mapped = mapped && g_Fields[plan.fieldId(i)] == plan.field(i) && plan.fieldName(i) == plan.field(i)->getFormattedName();
+			if (plan.fieldName(i) == "m_flSpeed") {
+				speed = (int)i;
+			}
+		}
+
+		CHECK(mapped);
+		CHECK(speed >= 0);
+		CHECK_EQ(plan.fieldOffset(speed), 0x100);
+		CHECK_EQ(plan.base(), 0x10);
+
+		// A change inside m_flSpeed sets exactly its bit
+		std::vector<std::uint8_t> entity(0x400), a(plan.size()), b(plan.size());
+		std::vector<std::uint64_t> changed(plan.numWords());
+		plan.capture(entity.data(), a.data());
+		entity[0x102] = 1;
+		plan.capture(entity.data(), b.data());
+
+		CHECK_EQ(plan.compare(a.data(), b.data(), changed.data()), 1u);
+		CHECK_EQ(changed[speed / 64], 1ull << (speed % 64));
+
+		checkAgainstScalar(plan);
+	}
+
+	{
+		resetClasses();
+		SyntheticGraph g;
+		createClasses(makeWideGraph(g, 0x20));
+		DeltaPlan& plan = getDeltaPlan("DT_Wide");
+
+		CHECK_EQ(plan.numFields(), 150u);
+		CHECK_EQ(plan.numWords(), 3u);
+		CHECK_EQ(plan.base(), 0x20);
+		checkAgainstScalar(plan);
+	}
+
+	{
+		// After a reload the plan is built from the new model, not the one that was freed
+		resetClasses();
+		SyntheticGraph g;
+		createClasses(makeWideGraph(g, 0x80));
+		DeltaPlan& plan = getDeltaPlan("DT_Wide");
+
+		CHECK_EQ(plan.base(), 0x80);
+		CHECK(g_Fields[plan.fieldId(0)] == plan.field(0));
+		CHECK_EQ(g_DeltaPlans.size(), 1u);
+		checkAgainstScalar(plan);
+	}
+
+	return test::result();
+}
@@ -0,0 +1,188 @@
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+#include "check.h"
+#include "graph.h"
+#include "dump.h"
+
+using namespace dvalvegen;
+
+// The ostream dumps dllmain.cpp had before the DumpFormat writers, TreeDump and ClassIdDump have to match them byte for byte
+
+template<typename T>
+void dumpTable(RecvTable* table, std::basic_ostream<T>& ostream, int level) {
+	static Indenter ind{ " -> " };
+
+	ostream << ind.get(level) << table->GetName() << std::endl;
+
+	level++;
+	for (int i = 0; i < table->GetNumProps(); i++) {
+		RecvProp* prop = table->GetProp(i);
+		SendPropType propt = prop->GetType();
+
+		if (propt == DPT_DataTable) {
+			ostream << ind.get(level) << prop->GetName() << " [ 0x" << std::hex << prop->GetOffset() << " ] !" << std::endl;
+			dumpTable(prop->GetDataTable(), ostream, level);
+		}
+		else {
+			std::string spropt;
+
+			switch (propt) {
+			case DPT_Int:
+				spropt = "Int"; break;
+			case DPT_Float:
+				spropt = "Float"; break;
+			case DPT_Vector:
+				spropt = "Vector"; break;
+			case DPT_VectorXY:
+				spropt = "VectorXY"; break;
+			case DPT_String:
+				spropt = "String"; break;
+			case DPT_Int64:
+				spropt = "Int64"; break;
+			case DPT_NUMSendPropTypes:
+				spropt = "NUMSendPropTypes"; break;
+			case DPT_Array:
+				spropt = "Array"; break;
+			default:
+				spropt = "UnknownType"; break;
+			}
+
+			ostream << ind.get(level) << prop->GetName() << " [ 0x" << std::hex << prop->GetOffset() << " ] " << spropt << std::endl;
+		}
+	}
+}
+
+template<typename T>
+void dumpTables(ClientClass* cclass, std::basic_ostream<T>& ostream) {
+	for (; cclass; cclass = cclass->m_pNext) {
+		dumpTable(cclass->m_pRecvTable, ostream, 0);
+		ostream << std::endl;
+	}
+}
+
+template<typename T>
+void dumpClassIds(ClientClass* cclass, std::basic_ostream<T>& ostream) {
+	static Indenter ind{ "\t" };
+
+	ClientClass* head = cclass;
+
+	ostream << "#pragma once" << std::endl << std::endl;
+	ostream << "enum ClassId {" << std::endl;
+
+	for (; cclass; cclass = cclass->m_pNext) {
+		std::string cname = cclass->m_pNetworkName;
+		int cid = cclass->m_ClassID;
+
+		ostream << ind.get(1) << cname << " = " << cid;
+
+		if (cclass->m_pNext) {
+			ostream << ",";
+		}
+
+		ostream << std::endl;
+	}
+
+	ostream << "};" << std::endl << std::endl;
+
+	printClassIdHash(head, ostream);
+}
+
+static std::string slurp(const std::string& path) {
+	std::ifstream inf{ path, std::ios::binary };
+	std::ostringstream ss;
+	ss << inf.rdbuf();
+	return ss.str();
+}
+
+int main() {
+	std::string dir = "dvalvegen_test_dump_" + std::to_string(getpid()) + "/";
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir);
+
+	// The player graph plus every prop type, a negative offset and tables three deep
+	SyntheticGraph g;
+	test::makePlayerGraph(g);
+
+	RecvTable* inner = g.addTable("DT_Inner");
+	g.addProp(inner, "m_nInner", DPT_Int, 4);
+	RecvTable* middle = g.addTable("DT_Middle");
+	g.addProp(middle, "m_Inner", DPT_DataTable, 0x8, inner);
+	g.addProp(middle, "m_flAfter", DPT_Float, 0x1c);
+
+	RecvTable* types = g.addTable("DT_Types");
+	g.addProp(types, "m_Middle", DPT_DataTable, 0xabc0, middle);
+	g.addProp(types, "m_vecXY", DPT_VectorXY, 0x10);
+	g.addProp(types, "m_nBig", DPT_Int64, 0x18);
+	g.addProp(types, "m_Array", DPT_Array, 0x20);
+	g.addProp(types, "m_nCount", DPT_NUMSendPropTypes, 0x28);
+	g.addProp(types, "m_nBack", DPT_Int, -4);
+	g.addClass("CTypes", types, 1234);
+
+	std::ostringstream tree;
+	dumpTables(g.head(), tree);
+	std::ostringstream ids;
+	dumpClassIds(g.head(), ids);
+
+	{
+		TreeDump nvs{ dir + "NetVars.txt" };
+		ClassIdDump cids{ dir + "ClassIds.h" };
+		CHECK_EQ(dumpGraph(g.head(), { &nvs, &cids }), 28);
+		CHECK(nvs.close());
+		CHECK(cids.close());
+	}
+
+	CHECK(slurp(dir + "NetVars.txt") == tree.str());
+	CHECK(slurp(dir + "ClassIds.h") == ids.str());
+	CHECK(tree.str().find(" -> m_Middle [ 0xabc0 ] !\n -> DT_Middle\n ->  -> m_Inner [ 0x8 ] !\n ->  -> DT_Inner\n ->  ->  -> m_nInner [ 0x4 ] Int\n ->  -> m_flAfter [ 0x1c ] Float\n") != std::string::npos);
+	CHECK(tree.str().find(" -> m_nBack [ 0xfffffffc ] Int\n") != std::string::npos);
+
+	// Names that need quoting or escaping, in the class, the table and along the path
+	SyntheticGraph odd;
+	RecvTable* sub = odd.addTable("DT_Sub\n");
+	odd.addProp(sub, "m_a,b", DPT_Float, 8);
+	odd.addProp(sub, "m_\x01\x1f", DPT_Int, 12);
+
+	RecvTable* quoted = odd.addTable("DT_\"Q\"");
+	odd.addProp(quoted, "m_\"x\\", DPT_Int, 4);
+	odd.setArray(odd.addProp(quoted, "m_sub", DPT_DataTable, 0x10, sub), 3, 16);
+	odd.setFlags(odd.addProp(quoted, "m_plain", DPT_Vector, 0x20), 5);
+	odd.addClass("C,Odd", quoted, 7);
+
+	{
+		CsvDump csv{ dir + "NetVars.csv" };
+		JsonLinesDump json{ dir + "NetVars.jsonl" };
+		CHECK_EQ(dumpGraph(odd.head(), { &csv, &json }), 5);
+		CHECK(csv.close());
+		CHECK(json.close());
+	}
+
+	CHECK(slurp(dir + "NetVars.csv") ==
+		"class,table,path,type,offset,absolute,elements,stride,flags\n"
+		"\"C,Odd\",\"DT_\"\"Q\"\"\",\"m_\"\"x\\\",Int,4,4,1,0,0\n"
+		"\"C,Odd\",\"DT_\"\"Q\"\"\",m_sub,DataTable,16,16,3,16,0\n"
+		"\"C,Odd\",\"DT_Sub\n\",\"m_sub.m_a,b\",Float,8,24,1,0,0\n"
+		"\"C,Odd\",\"DT_Sub\n\",m_sub.m_\x01\x1f,Int,12,28,1,0,0\n"
+		"\"C,Odd\",\"DT_\"\"Q\"\"\",m_plain,Vector,32,32,1,0,5\n");
+
+	CHECK(slurp(dir + "NetVars.jsonl") ==
+		"{\"class\":\"C,Odd\",\"table\":\"DT_\\\"Q\\\"\",\"path\":\"m_\\\"x\\\\\",\"type\":\"Int\",\"offset\":4,\"absolute\":4,\"elements\":1,\"stride\":0,\"flags\":0}\n"
+		"{\"class\":\"C,Odd\",\"table\":\"DT_\\\"Q\\\"\",\"path\":\"m_sub\",\"type\":\"DataTable\",\"offset\":16,\"absolute\":16,\"elements\":3,\"stride\":16,\"flags\":0}\n"
+		"{\"class\":\"C,Odd\",\"table\":\"DT_Sub\\u000a\",\"path\":\"m_sub.m_a,b\",\"type\":\"Float\",\"offset\":8,\"absolute\":24,\"elements\":1,\"stride\":0,\"flags\":0}\n"
+		"{\"class\":\"C,Odd\",\"table\":\"DT_Sub\\u000a\",\"path\":\"m_sub.m_\\u0001\\u001f\",\"type\":\"Int\",\"offset\":12,\"absolute\":28,\"elements\":1,\"stride\":0,\"flags\":0}\n"
+		"{\"class\":\"C,Odd\",\"table\":\"DT_\\\"Q\\\"\",\"path\":\"m_plain\",\"type\":\"Vector\",\"offset\":32,\"absolute\":32,\"elements\":1,\"stride\":0,\"flags\":5}\n");
+
+	// A file that can't be created shows in ok() and close()
+	{
+		CsvDump csv{ dir + "missing/NetVars.csv" };
+		CHECK(!csv.ok());
+		dumpGraph(odd.head(), { &csv });
+		CHECK(!csv.close());
+	}
+
+	std::filesystem::remove_all(dir);
+	return test::result();
+}
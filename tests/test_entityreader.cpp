@@ -0,0 +1,95 @@
+#include <vector>
+#include <cstdlib>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+#include "check.h"
+#include "graph.h"
+#include "entityreader.h"
+
+using namespace dvalvegen;
+
+static uint fieldId(const char* table, const char* prop) {
+	return g_Classes[table].props().at(prop).id();
+}
+
+int main() {
+	SyntheticGraph g;
+	createClasses(test::makePlayerGraph(g));
+	Class& player = g_Classes["DT_Player"];
+	Class& entity = g_Classes["DT_BaseEntity"];
+
+	// Odd entities are players, the child gets them at the same addresses through fork
+	const int count = 1024;
+	std::vector<char*> entities;
+	for (int i = 0; i < count; i++) {
+		char* e = (char*)std::calloc(1, 0x400);
+		float origin[3] = { (float)i, 2, 3 };
+		float maxs[3] = { (float)-i, 0, 0 };
+
+		*(int*)(e + 0x10) = i;
+		std::memcpy(e + 0x20, origin, sizeof(origin));
+		std::memcpy(e + 0x40 + 12, maxs, sizeof(maxs));
+		*(float*)(e + 0x100) = i * 0.5f;
+		((int*)(e + 0x200))[2] = i * 3;
+		entities.push_back(e);
+	}
+
+	pid_t child = fork();
+	if (child == 0) {
+		pause();
+		_exit(0);
+	}
+
+	std::vector<uint> ids{ fieldId("DT_BaseEntity", "m_iHealth"), fieldId("DT_BaseEntity", "m_vecOrigin"), fieldId("DT_Player", "m_flSpeed"),
+		fieldId("DT_Coll", "m_vecMaxs"), fieldId("DT_Player", "m_iAmmo") };
+
+	ProcessReader reader{ child };
+	EntityReader er{ reader };
+	er.setFields(ids);
+
+	// Health, origin and the nested maxs are close enough to share a range
+	CHECK_EQ(er.plan(entity).ranges.size(), 1u);
+	CHECK_EQ(er.plan(player).fields.size(), 5u);
+
+	for (int i = 0; i < count; i++) {
+		er.add((std::uintptr_t)entities[i], i % 2 ? player : entity);
+	}
+
+	// One bad entity only invalidates itself
+	er.add(16, player);
+	CHECK(!er.read());
+	CHECK(!er.valid(count));
+	CHECK(er.valid(0) && er.valid(count - 1));
+
+	er.clear();
+	for (int i = 0; i < count; i++) {
+		er.add((std::uintptr_t)entities[i], i % 2 ? player : entity);
+	}
+
+	CHECK(er.read());
+
+	// All ranges of a tick go out together, process_vm_readv takes IOV_MAX of them per call
+	CHECK(er.lastCalls() <= (er.lastRanges() + 1023) / 1024);
+
+	const int* health = er.column<int>(ids[0]);
+	const float* speed = er.column<float>(ids[2]);
+	const float* maxs = er.column<float>(ids[3]);
+	const int* ammo = er.column<int>(ids[4]);
+
+	int wrong = 0;
+	for (int i = 0; i < count; i++) {
+		wrong += health[i] != i;
+		wrong += speed[i] != (i % 2 ? i * 0.5f : 0);
+		wrong += maxs[i * 3] != -i;
+		wrong += ammo[i * 4 + 2] != (i % 2 ? i * 3 : 0);
+	}
+
+	CHECK_EQ(wrong, 0);
+
+	kill(child, SIGKILL);
+	waitpid(child, nullptr, 0);
+
+	return test::result();
+}
@@ -0,0 +1,170 @@
+#include <sstream>
+#include <string>
+
+#include "check.h"
+#include "graph.h"
+#include "graphdiff.h"
+
+using namespace dvalvegen;
+
+// The player graph with the knobs the cases below turn
+struct Variant {
+	int speed = 0x100;
+	int maxs = 12;
+	bool armor = false;
+	bool othercoll = false;
+	int playerid = 2;
+	bool extra = false;
+	bool empty = true;
+};
+
+static ClientClass* makeGraph(SyntheticGraph& g, const Variant& v) {
+	RecvTable* coll = g.addTable(v.othercoll ? "DT_CollisionProperty" : "DT_Coll");
+	g.addProp(coll, "m_vecMins", DPT_Vector, 0);
+	g.addProp(coll, "m_vecMaxs", DPT_Vector, v.maxs);
+
+	RecvTable* entity = g.addTable("DT_BaseEntity");
+	g.addProp(entity, "m_iHealth", DPT_Int, 0x10);
+	g.addProp(entity, "m_vecOrigin", DPT_Vector, 0x20);
+	g.addProp(entity, "m_Collision", DPT_DataTable, 0x40, coll);
+
+	RecvTable* player = g.addTable("DT_Player");
+	g.addProp(player, "baseclass", DPT_DataTable, 0, entity);
+	g.addProp(player, "m_flSpeed", DPT_Float, v.speed);
+	if (v.armor) {
+		g.addProp(player, "m_iArmor", DPT_Int, 0x110);
+	}
+
+	g.addClass("CBaseEntity", entity, 1);
+	g.addClass("CPlayer", player, v.playerid);
+	if (v.empty) {
+		g.addClass("CEmpty", g.addTable("DT_Empty"), 3);
+	}
+	if (v.extra) {
+		g.addClass("CExtra", g.addTable("DT_Extra"), 4);
+	}
+
+	return g.head();
+}
+
+static GraphDiff diffVariants(const Variant& before, const Variant& after) {
+	SyntheticGraph a, b;
+	return diffGraphs(makeGraph(a, before), makeGraph(b, after));
+}
+
+static bool hasChange(const GraphDiff& diff, GraphChange::Kind kind, const std::string& owner, const std::string& prop, std::int64_t before, std::int64_t after) {
+	for (auto& c : diff.changes) {
+		if (c.kind == kind && c.owner == owner && c.prop == prop && c.before == before && c.after == after) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int main() {
+	std::unordered_set<std::string> tables;
+
+	{
+		// Every class's table hashes the same, nothing below them is looked at
+		GraphDiff diff = diffVariants({}, {});
+		CHECK(diff.empty());
+		CHECK(!diff.layoutchanged);
+		CHECK_EQ(diff.tablescompared, 0u);
+		CHECK_EQ(diff.tablesskipped, 3u);
+		CHECK(regenerationFilter(diff, tables));
+		CHECK(tables.empty());
+	}
+
+	{
+		// The base class is reached again through DT_Player, it's skipped once and not compared again
+		Variant moved;
+		moved.speed = 0x104;
+		GraphDiff diff = diffVariants({}, moved);
+
+		CHECK_EQ(diff.changes.size(), 1u);
+		CHECK(hasChange(diff, GraphChange::OffsetMoved, "DT_Player", "m_flSpeed", 0x100, 0x104));
+		CHECK(!diff.layoutchanged);
+		CHECK_EQ(diff.tablescompared, 1u);
+		CHECK(diff.dirtytables == std::vector<std::string>{ "DT_Player" });
+		CHECK(regenerationFilter(diff, tables));
+		CHECK(tables == std::unordered_set<std::string>{ "DT_Player" });
+
+		std::ostringstream text;
+		printGraphDiff(diff, text);
+		CHECK(text.str() == "~ DT_Player.m_flSpeed 0x100 -> 0x104\n");
+	}
+
+	{
+		// A nested table that moved, only it is dirty, the tables on the way to it are compared but unchanged
+		Variant moved;
+		moved.maxs = 16;
+		GraphDiff diff = diffVariants({}, moved);
+
+		CHECK(hasChange(diff, GraphChange::OffsetMoved, "DT_Coll", "m_vecMaxs", 12, 16));
+		CHECK(!diff.layoutchanged);
+		CHECK(diff.dirtytables == std::vector<std::string>{ "DT_Coll" });
+		CHECK(regenerationFilter(diff, tables));
+		CHECK(tables == std::unordered_set<std::string>{ "DT_Coll" });
+	}
+
+	{
+		Variant armor;
+		armor.armor = true;
+
+		GraphDiff added = diffVariants({}, armor);
+		CHECK_EQ(added.changes.size(), 1u);
+		CHECK(hasChange(added, GraphChange::PropAdded, "DT_Player", "m_iArmor", 0, 0x110));
+		CHECK(added.layoutchanged);
+		CHECK(!regenerationFilter(added, tables));
+		CHECK(tables.empty());
+
+		GraphDiff removed = diffVariants(armor, {});
+		CHECK_EQ(removed.changes.size(), 1u);
+		CHECK(hasChange(removed, GraphChange::PropRemoved, "DT_Player", "m_iArmor", 0x110, 0));
+		CHECK(removed.layoutchanged);
+		CHECK(!regenerationFilter(removed, tables));
+	}
+
+	{
+		// m_Collision now points at another table, the old prop is gone and a new one took its place
+		Variant retargeted;
+		retargeted.othercoll = true;
+		GraphDiff diff = diffVariants({}, retargeted);
+
+		CHECK(hasChange(diff, GraphChange::PropRemoved, "DT_BaseEntity", "m_Collision", 0x40, 0));
+		CHECK(hasChange(diff, GraphChange::PropAdded, "DT_BaseEntity", "m_Collision", 0, 0x40));
+		CHECK(diff.layoutchanged);
+		CHECK(!regenerationFilter(diff, tables));
+	}
+
+	{
+		Variant extra;
+		extra.extra = true;
+		GraphDiff added = diffVariants({}, extra);
+		CHECK_EQ(added.changes.size(), 1u);
+		CHECK(hasChange(added, GraphChange::ClassAdded, "CExtra", "", 0, 4));
+		CHECK(added.layoutchanged);
+
+		Variant noempty;
+		noempty.empty = false;
+		GraphDiff removed = diffVariants({}, noempty);
+		CHECK_EQ(removed.changes.size(), 1u);
+		CHECK(hasChange(removed, GraphChange::ClassRemoved, "CEmpty", "", 3, 0));
+		CHECK(removed.layoutchanged);
+		CHECK(!regenerationFilter(removed, tables));
+
+		// A new ID alone leaves every table as it was
+		Variant renumbered;
+		renumbered.playerid = 7;
+		GraphDiff moved = diffVariants({}, renumbered);
+		CHECK_EQ(moved.changes.size(), 1u);
+		CHECK(hasChange(moved, GraphChange::ClassIdChanged, "CPlayer", "", 2, 7));
+		CHECK(!moved.layoutchanged);
+		CHECK_EQ(moved.tablescompared, 0u);
+		CHECK(regenerationFilter(moved, tables));
+		CHECK(tables.empty());
+	}
+
+	return test::result();
+}
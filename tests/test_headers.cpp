@@ -0,0 +1,109 @@
+// CEmpty.h first with nothing before it, a class without props or bases still has to pull in what it uses
+#include "CEmpty.h"
+#include "CPlayer.h"
+
+#include <cstring>
+#include <type_traits>
+
+#include "check.h"
+
+using namespace dvalvegen;
+
+bool initializePlayer();
+
+struct Counter {
+	int fields = 0;
+
+	template<typename T>
+	void operator()(const FieldDesc&, T) {
+		fields++;
+	}
+};
+
+int main() {
+	CHECK_EQ(ClassFields<CEmpty>::All.size(), 0u);
+	CHECK_EQ(ClassFields<CPlayer>::All.size(), ClassFields<CBaseEntity>::All.size() + 4);
+
+	alignas(16) char object[0x400] = {};
+	Counter empty;
+	forEachField((CEmpty*)object, empty);
+	CHECK_EQ(empty.fields, 0);
+
+	Counter player;
+	forEachField((CPlayer*)object, player);
+	CHECK_EQ(player.fields, (int)ClassFields<CPlayer>::All.size());
+
+	// Every policy on the same fields, written through the ones that hand out the field and read back through all of them
+	CHECK(initializePlayer());
+	CPlayer* p = (CPlayer*)object;
+
+	static_assert(std::is_same_v<decltype(p->m_iHealth()), std::int32_t*>);
+	static_assert(std::is_same_v<decltype(p->m_iHealth<Pointer>()), std::int32_t*>);
+	static_assert(std::is_same_v<decltype(p->m_iHealth<Reference>()), std::int32_t&>);
+	static_assert(std::is_same_v<decltype(p->m_iHealth<Value>()), std::int32_t>);
+	static_assert(std::is_same_v<decltype(p->m_iHealth<Relaxed>()), std::int32_t>);
+
+	CHECK_EQ((char*)p->m_iHealth<Pointer>() - object, 0x10);
+	CHECK_EQ((char*)&p->m_iHealth<Reference>() - object, 0x10);
+	CHECK_EQ((char*)p->m_vecOrigin<Pointer>() - object, 0x20);
+	CHECK_EQ((char*)&p->m_flSpeed<Reference>() - object, 0x100);
+
+	*p->m_iHealth<Pointer>() = 100;
+	CHECK_EQ(p->m_iHealth<Reference>(), 100);
+	CHECK_EQ(p->m_iHealth<Value>(), 100);
+	CHECK_EQ(p->m_iHealth<Relaxed>(), 100);
+
+	p->m_iHealth<Reference>() = -7;
+	CHECK_EQ(*p->m_iHealth<Pointer>(), -7);
+	CHECK_EQ(p->m_iHealth<Value>(), -7);
+	CHECK_EQ(p->m_iHealth<Relaxed>(), -7);
+
+	p->m_flSpeed<Reference>() = 2.5f;
+	CHECK(*p->m_flSpeed<Pointer>() == 2.5f);
+	CHECK(p->m_flSpeed<Value>() == 2.5f);
+	CHECK(p->m_flSpeed<Relaxed>() == 2.5f);
+
+	*p->m_vecOrigin<Pointer>() = { 1.0f, -2.0f, 3.5f };
+	Vector origin = p->m_vecOrigin<Value>();
+	CHECK(origin.x == 1.0f && origin.y == -2.0f && origin.z == 3.5f);
+	origin = p->m_vecOrigin<Relaxed>();
+	CHECK(origin.x == 1.0f && origin.y == -2.0f && origin.z == 3.5f);
+	CHECK(p->m_vecOrigin<Reference>().z == 3.5f);
+
+	// Laid out by hand at the offsets of the graph, the value reads have to find each one
+	const std::int64_t big = 0x1122334455667788;
+	const float xyz[3] = { 4.0f, 5.5f, -6.0f };
+	std::memcpy(object + 0x180, &big, sizeof(big));
+	std::memcpy(object + 0x20, xyz, sizeof(xyz));
+	for (std::int32_t i = 0; i < 4; i++) {
+		std::int32_t ammo = 10 + i;
+		std::memcpy(object + 0x200 + i * 4, &ammo, sizeof(ammo));
+	}
+
+	CHECK_EQ((char*)p->m_nInt64<Pointer>() - object, 0x180);
+	CHECK(p->m_nInt64<Value>() == big);
+	CHECK(p->m_nInt64<Relaxed>() == big);
+	origin = p->m_vecOrigin<Value>();
+	CHECK(origin.x == 4.0f && origin.y == 5.5f && origin.z == -6.0f);
+	CHECK_EQ(p->m_iAmmo_Size(), 4);
+	CHECK_EQ((char*)p->m_iAmmo() - object, 0x200);
+	for (int i = 0; i < 4; i++) {
+		CHECK_EQ(p->m_iAmmo()[i], 10 + i);
+	}
+
+	// Value copies with memcpy, an object one byte off still reads right
+	alignas(16) char shifted[0x401] = {};
+	std::memcpy(shifted + 1, object, sizeof(object));
+	CPlayer* q = (CPlayer*)(shifted + 1);
+	CHECK(q->m_nInt64<Value>() == big);
+	CHECK_EQ(q->m_iHealth<Value>(), -7);
+	origin = q->m_vecOrigin<Value>();
+	CHECK(origin.x == 4.0f && origin.y == 5.5f && origin.z == -6.0f);
+
+	// Neighbours are left alone
+	CHECK_EQ(*(std::int32_t*)(object + 0x14), 0);
+	CHECK_EQ(*(std::int32_t*)(object + 0xfc), 0);
+	CHECK_EQ(*(std::int32_t*)(object + 0x104), 0);
+
+	return test::result();
+}
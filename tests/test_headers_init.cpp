@@ -0,0 +1,10 @@
+#include "rtgraph.h"
+
+// Resolves the offsets for test_headers, which has to include the class headers before anything else
+
+bool initializePlayer() {
+	/// Not baked, initialize() resolves at runtime and returns false, true here if every field was found
+	static dvalvegen::test::RuntimeGraph g;
+	dvalvegen::initialize(dvalvegen::test::makePlayerGraph(g));
+	return dvalvegen::getUnresolvedCount() == 0;
+}
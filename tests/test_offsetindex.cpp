@@ -0,0 +1,126 @@
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "graph.h"
+#include "offsetindex.h"
+
+using namespace dvalvegen;
+
+// Brute force over the entries the index holds, the clamped intervals are what both agree on
+static bool matches(const OffsetIndex& index, int offset, const OffsetHit& hit) {
+	const OffsetEntry* innermost = nullptr;
+	const OffsetEntry* before = nullptr;
+
+	for (auto& e : index.entries()) {
+		if (e.start <= offset && e.end > offset && (!innermost || e.end - e.start < innermost->end - innermost->start)) {
+			innermost = &e;
+		}
+
+		if (e.start <= offset && (!before || e.start > before->start)) {
+			before = &e;
+		}
+	}
+
+	if (innermost) {
+		return hit.inside && hit.entry->start <= offset && hit.entry->end > offset
+			&& hit.entry->end - hit.entry->start == innermost->end - innermost->start && hit.delta == offset - hit.entry->start;
+	}
+
+	if (before) {
+		return !hit.inside && hit.entry && hit.entry->start == before->start && hit.delta == offset - before->start;
+	}
+
+	return !hit.inside && !hit.entry;
+}
+
+int main() {
+	// Nested tables, props sharing offsets and a wide string at the start
+	const SendPropType types[] = { DPT_Int, DPT_Float, DPT_Vector, DPT_Int64, DPT_VectorXY };
+	std::mt19937 rng{ 7 };
+	SyntheticGraph g;
+
+	RecvTable* inner = g.addTable("DT_Inner");
+	for (int i = 0; i < 40; i++) {
+		g.addProp(inner, "m_in" + std::to_string(i), types[rng() % 5], (int)(rng() % 64) * 4);
+	}
+
+	RecvTable* outer = g.addTable("DT_Outer");
+	g.setStringBufferSize(g.addProp(outer, "m_szWide", DPT_String, 0), 4096);
+	for (int i = 0; i < 400; i++) {
+		g.addProp(outer, "m_out" + std::to_string(i), types[rng() % 5], (int)(rng() % 512) * 4);
+	}
+
+	g.addProp(outer, "m_inner", DPT_DataTable, 0x100, inner);
+	g.addProp(outer, "m_inner2", DPT_DataTable, 0x900, inner);
+	g.addClass("CInner", inner, 1);
+	g.addClass("COuter", outer, 2);
+	createClasses(g.head());
+
+	OffsetIndex index{ g_Classes["DT_Outer"] };
+	CHECK_EQ(index.entries().size(), 401u + 80u);
+
+	bool found = true;
+	std::vector<int> offsets;
+	for (int offset = -4; offset < 0xA00; offset++) {
+		found = found && matches(index, offset, index.find(offset));
+		offsets.push_back(offset);
+	}
+
+	CHECK(found);
+
+	std::shuffle(offsets.begin(), offsets.end(), rng);
+	std::vector<OffsetHit> hits(offsets.size());
+	index.findMany(offsets.data(), (uint)offsets.size(), hits.data());
+
+	bool many = true;
+	for (std::size_t i = 0; i < offsets.size(); i++) {
+		many = many && matches(index, offsets[i], hits[i]);
+	}
+
+	CHECK(many);
+
+	bool ranges = true;
+	for (int i = 0; i < 200; i++) {
+		int start = (int)(rng() % 0xA00);
+		int end = start + 1 + (int)(rng() % 64);
+
+		std::vector<const OffsetEntry*> got;
+		index.findRange(start, end, got);
+
+		std::vector<const OffsetEntry*> expected;
+		for (auto& e : index.entries()) {
+			if (e.start < end && e.end > start) {
+				expected.push_back(&e);
+			}
+		}
+
+		ranges = ranges && got == expected;
+	}
+
+	CHECK(ranges);
+
+	// Thousands of fields at one offset, building and looking up stay fast
+	SyntheticGraph flat;
+	RecvTable* table = flat.addTable("DT_Flat");
+	for (int i = 0; i < 20000; i++) {
+		flat.addProp(table, "m_f" + std::to_string(i), types[i % 5], i < 10000 ? 0 : 4 * (i - 10000));
+	}
+
+	flat.addClass("CFlat", table, 1);
+	createClasses(flat.head());
+
+	auto start = std::chrono::steady_clock::now();
+	OffsetIndex big{ g_Classes["DT_Flat"] };
+	for (int offset = 0; offset < 40000; offset++) {
+		found = found && big.find(offset).inside;
+	}
+
+	CHECK(found);
+	CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(2));
+
+	return test::result();
+}
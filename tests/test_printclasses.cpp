@@ -0,0 +1,64 @@
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+#include "check.h"
+#include "graph.h"
+
+using namespace dvalvegen;
+
+int main() {
+	std::string dir = "dvalvegen_test_print_" + std::to_string(getpid());
+	std::filesystem::remove_all(dir);
+
+	SyntheticGraph g;
+	createClasses(test::makePlayerGraph(g));
+
+	// Rendering runs out of budget halfway, the writer thread is joined and the exception reaches the caller
+	memory::setBudget(memory::total().current + 512);
+	bool threw = false;
+	try {
+		printClasses(dir, false, 1);
+	}
+	catch (const std::bad_alloc&) {
+		threw = true;
+	}
+
+	CHECK(threw);
+
+	// A queue of one makes both sides wait for each other on every file
+	memory::setBudget(0);
+	CHECK(printClasses(dir, false, 1));
+	CHECK(std::filesystem::exists(dir + "/dvalvegen/CPlayer.h"));
+	CHECK(std::filesystem::exists(dir + "/dvalvegen/CEmpty.h"));
+	CHECK(std::filesystem::file_size(dir + "/dvalvegen/dvalvegen.cpp") > 0);
+
+	// What's on disk is exactly what was rendered
+	SdkFiles files;
+	renderClasses(files);
+	for (auto& f : files) {
+		std::ifstream inf{ dir + "/dvalvegen/" + f.first, std::ios::binary };
+		std::ostringstream ss;
+		ss << inf.rdbuf();
+		CHECK(ss.str() == f.second);
+	}
+
+	// A file that can't be opened fails the whole call, the rest is still written
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir + "/dvalvegen/CPlayer.h");
+	CHECK(!printClasses(dir, false, 1));
+	CHECK(std::filesystem::file_size(dir + "/dvalvegen/CEmpty.h") > 0);
+	CHECK(std::filesystem::file_size(dir + "/dvalvegen/dvalvegen.cpp") > 0);
+
+	// So does an output directory that can't be created
+	std::filesystem::remove_all(dir);
+	std::ofstream{ dir };
+	CHECK(!printClasses(dir, false, 1));
+	std::filesystem::remove(dir);
+
+	std::filesystem::remove_all(dir);
+	return test::result();
+}
@@ -0,0 +1,55 @@
+#include <string>
+#include <thread>
+
+#include "check.h"
+#include "rtgraph.h"
+#include "CPlayer.h"
+
+using namespace dvalvegen;
+
+// Built with DVALVEGEN_PROFILE, every accessor call is counted
+int main() {
+	test::RuntimeGraph g;
+	initialize(test::makePlayerGraph(g));
+
+	// By name, the order of Declared isn't the order of the table
+	const unsigned int speed = findField("DT_Player", "m_flSpeed");
+	const unsigned int health = findField("DT_BaseEntity", "m_iHealth");
+	CHECK_EQ(getAccessCount(speed), 0u);
+
+	alignas(16) char object[0x400] = {};
+	CPlayer* player = (CPlayer*)object;
+
+	for (int i = 0; i < 3; i++) {
+		*player->m_flSpeed() += 1;
+	}
+
+	// Another thread counts into its own block, the totals add them up
+	std::thread other{ [player] {
+		for (int i = 0; i < 5; i++) {
+			*player->m_iHealth() += 1;
+		}
+	} };
+	other.join();
+
+	CHECK_EQ(getAccessCount(speed), 3u);
+	CHECK_EQ(getAccessCount(health), 5u);
+	CHECK_EQ(getAccessCount(findField("DT_Player", "m_szName")), 0u);
+
+	// Most used first, fields nobody touched aren't listed
+	std::string report = profileReport();
+	std::size_t healthline = report.find("m_iHealth");
+	std::size_t speedline = report.find("m_flSpeed");
+	CHECK(healthline != std::string::npos && speedline != std::string::npos);
+	CHECK(healthline < speedline);
+	CHECK(report.find("DT_Player", speedline) != std::string::npos);
+	CHECK(report.find("62.50%", healthline) != std::string::npos);
+	CHECK(report.find("37.50%", speedline) != std::string::npos);
+	CHECK(report.find("m_szName") == std::string::npos);
+
+	resetProfile();
+	CHECK_EQ(getAccessCount(speed), 0u);
+	CHECK(profileReport().find("m_flSpeed") == std::string::npos);
+
+	return test::result();
+}
@@ -0,0 +1,102 @@
+#include <thread>
+#include <vector>
+
+#include "check.h"
+#include "graph.h"
+#include "proxyhooks.h"
+
+using namespace dvalvegen;
+
+static int g_OriginalCalls = 0;
+
+static void originalProxy(const CRecvProxyData*, void*, void*) {
+	g_OriginalCalls++;
+}
+
+static void receive(RecvProp* prop, int object, int value) {
+	CRecvProxyData data{};
+	data.m_pRecvProp = prop;
+	data.m_ObjectID = object;
+	data.m_Value.m_Int = value;
+	data.m_Value.m_Type = DPT_Int;
+	prop->GetProxyFn()(&data, nullptr, nullptr);
+}
+
+int main() {
+	SyntheticGraph g;
+	createClasses(test::makePlayerGraph(g));
+
+	RecvProp* health = g.findTable("DT_BaseEntity")->GetProp(0);
+	health->SetProxyFn(originalProxy);
+	uint healthid = g_Classes["DT_BaseEntity"].props().at("m_iHealth").id();
+
+	CHECK(hookProxy("DT_BaseEntity", "m_iHealth"));
+	CHECK(hookProxy("DT_BaseEntity", "m_iHealth"));
+	CHECK(!hookProxy("DT_Player", "m_nope"));
+	CHECK(!hookProxy("DT_BaseEntity", "m_Collision"));
+	CHECK(health->GetProxyFn() != originalProxy);
+
+	// Events of one producer thread arrive in order, the original proxy still runs for each
+	// The ring holds all of them, so nothing is dropped however the threads are scheduled
+	const int count = 10000;
+	setProxyRingSize(16384);
+	std::thread producer{ [health] {
+		for (int i = 0; i < count; i++) {
+			receive(health, i, i * 2);
+		}
+	} };
+
+	int next = 0;
+	bool ordered = true;
+	auto drain = [&]() {
+		drainProxyEvents([&](const ProxyEvent* events, uint n) {
+			for (uint i = 0; i < n; i++) {
+				ordered = ordered && events[i].fieldID == healthid && events[i].objectID == next && events[i].value.m_Int == next * 2;
+				next++;
+			}
+		}, 64);
+	};
+
+	while (next < count / 2) {
+		drain();
+	}
+
+	producer.join();
+	drain();
+
+	CHECK(ordered);
+	CHECK_EQ(next, count);
+	CHECK_EQ(getDroppedProxyEvents(), 0u);
+	CHECK_EQ(g_OriginalCalls, count);
+
+	unhookProxies();
+	CHECK(health->GetProxyFn() == originalProxy);
+
+	// Unhooked slots are reused, far more cycles than there are slots
+	uint hooked = 0;
+	for (uint i = 0; i < MaxProxyHooks * 3; i++) {
+		hooked += hookProxy("DT_BaseEntity", "m_iHealth");
+		unhookProxies();
+	}
+
+	CHECK_EQ(hooked, MaxProxyHooks * 3);
+	CHECK(g_ProxySlotsUsed.load() <= 2);
+	CHECK(health->GetProxyFn() == originalProxy);
+
+	// After a shutdown the rings are gone and a thread firing a hook gets a new one
+	CHECK(hookProxy("DT_BaseEntity", "m_iHealth"));
+	receive(health, 1, 1);
+	shutdownProxyHooks();
+	CHECK(g_ProxyRings.load() == nullptr);
+	CHECK(health->GetProxyFn() == originalProxy);
+
+	CHECK(hookProxy("DT_BaseEntity", "m_iHealth"));
+	receive(health, 2, 4);
+
+	ProxyEvent events[4];
+	CHECK_EQ(drainProxyEvents(events, 4), 1u);
+	CHECK_EQ(events[0].objectID, 2);
+	shutdownProxyHooks();
+
+	return test::result();
+}
@@ -0,0 +1,176 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include "check.h"
+#include "recorder.h"
+
+using namespace dvalvegen;
+
+struct Replayed {
+	ProxyEvent ev;
+	std::uint32_t tick;
+};
+
+static std::vector<Replayed> replayFile(const std::string& path) {
+	std::vector<Replayed> out;
+	NetvarReplayer replayer;
+	if (!replayer.open(path)) {
+		return out;
+	}
+
+	std::uint64_t n = replayer.replay([&out](const ProxyEvent& ev, std::uint32_t tick) {
+		out.push_back({ ev, tick });
+	});
+
+	CHECK_EQ(n, out.size());
+	return out;
+}
+
+static bool sameEvent(const ProxyEvent& a, const ProxyEvent& b) {
+	std::size_t payload = a.type == DPT_Int ? 4 : a.type == DPT_Int64 ? 8 : a.type == DPT_Float ? 4 : a.type == DPT_Vector ? 12 : a.type == DPT_VectorXY ? 8 : 0;
+	return a.objectID == b.objectID && a.fieldID == b.fieldID && a.element == b.element && a.type == b.type && std::memcmp(&a.value, &b.value, payload) == 0;
+}
+
+static void writeFile(const std::string& path, const std::vector<std::uint8_t>& bytes, std::size_t size) {
+	std::ofstream{ path, std::ios::binary }.write((const char*)bytes.data(), size);
+}
+
+static ProxyEvent makeEvent(int object, unsigned int field, int element, int type) {
+	ProxyEvent ev;
+	std::memset(&ev, 0, sizeof(ev));
+	ev.objectID = object;
+	ev.fieldID = field;
+	ev.element = element;
+	ev.type = type;
+	return ev;
+}
+
+int main() {
+	std::string path = "dvalvegen_test_recorder_" + std::to_string(getpid()) + ".log";
+	std::string cut = path + ".cut";
+
+	// Every payload type, elements, and field, object and tick deltas going both ways
+	const int types[] = { DPT_Int, DPT_Int64, DPT_Float, DPT_Vector, DPT_VectorXY, DPT_String };
+	std::vector<ProxyEvent> events;
+	std::vector<std::uint32_t> ticks;
+	for (int i = 0; i < 200; i++) {
+		int type = types[i % 6];
+		ProxyEvent ev = makeEvent(i % 3 ? 500 - i * 7 : i * 1000, (unsigned int)((i * 37) % 90), i % 4 ? 0 : i / 4, type);
+
+		switch (type) {
+		case DPT_Int:
+			ev.value.m_Int = i % 2 ? -i * 100000 : i;
+			break;
+		case DPT_Int64:
+			ev.value.m_Int64 = (i % 2 ? -1 : 1) * ((std::int64_t)i << 40);
+			break;
+		case DPT_Float:
+			ev.value.m_Float = i * -0.5f;
+			break;
+		default:
+			ev.value.m_Vector[0] = (float)i;
+			ev.value.m_Vector[1] = -(float)i;
+			ev.value.m_Vector[2] = type == DPT_Vector ? 0.25f : 0.f;
+			break;
+		}
+
+		events.push_back(ev);
+		ticks.push_back((std::uint32_t)(1000 + (i / 5) * 3 - (i % 7 == 0 ? 50 : 0)));
+	}
+
+	{
+		NetvarRecorder recorder;
+		CHECK(recorder.open(path, 256));
+		for (std::size_t i = 0; i < events.size(); i++) {
+			recorder.setTick(ticks[i]);
+			recorder.record(events[i]);
+		}
+		recorder.close();
+		CHECK_EQ(recorder.numRecords(), events.size());
+	}
+
+	std::vector<Replayed> replayed = replayFile(path);
+	CHECK_EQ(replayed.size(), events.size());
+
+	bool same = replayed.size() == events.size();
+	for (std::size_t i = 0; same && i < events.size(); i++) {
+		same = sameEvent(replayed[i].ev, events[i]) && replayed[i].tick == ticks[i];
+	}
+	CHECK(same);
+
+	// Cut anywhere, the recorder's log replays a prefix of what was recorded and nothing made up
+	std::vector<std::uint8_t> full;
+	{
+		std::ifstream in{ path, std::ios::binary };
+		full.assign(std::istreambuf_iterator<char>{ in }, {});
+	}
+
+	bool prefixes = true;
+	std::size_t last = 0;
+	for (std::size_t size = sizeof(RecordMagic) + 1; size < full.size(); size++) {
+		writeFile(cut, full, size);
+		std::vector<Replayed> part = replayFile(cut);
+
+		prefixes = prefixes && part.size() >= last && part.size() < events.size();
+		for (std::size_t i = 0; prefixes && i < part.size(); i++) {
+			prefixes = sameEvent(part[i].ev, events[i]) && part[i].tick == ticks[i];
+		}
+		last = part.size();
+	}
+
+	CHECK(prefixes);
+	CHECK_EQ(last, events.size() - 1);
+
+	// A log built by hand, so where every record ends is known, including varints cut in their middle
+	std::vector<std::uint8_t> log(RecordMagic, RecordMagic + sizeof(RecordMagic));
+	std::vector<std::size_t> ends;
+
+	auto add = [&](std::uint8_t head, std::int64_t tick, std::uint64_t time, std::int64_t field, std::int64_t object, std::uint64_t element, auto payload) {
+		log.push_back(head);
+		if (head & RecordHasTick) {
+			writeVarint(log, zigzag(tick));
+		}
+		if (head & RecordHasTime) {
+			writeVarint(log, time);
+		}
+		writeVarint(log, zigzag(field));
+		writeVarint(log, zigzag(object));
+		if (head & RecordHasElement) {
+			writeVarint(log, element);
+		}
+		payload();
+		ends.push_back(log.size());
+	};
+
+	add(DPT_Int | RecordHasTick | RecordHasTime, 100000, 1 << 20, 300, -70000, 0, [&] { writeVarint(log, zigzag(-123456789)); });
+	add(DPT_Int64 | RecordHasElement, 0, 0, -299, 1 << 30, 1000, [&] { writeVarint(log, zigzag(-(1ll << 50))); });
+	add(DPT_Float | RecordHasTime, 0, 5, 0, 0, 0, [&] { float f = 2.5f; log.insert(log.end(), (std::uint8_t*)&f, (std::uint8_t*)&f + 4); });
+	add(DPT_Vector | RecordHasTick, -5000, 0, 1, -1, 0, [&] { log.insert(log.end(), 12, 0x42); });
+	add(DPT_VectorXY | RecordHasElement, 0, 0, 20000, 1, 300, [&] { log.insert(log.end(), 8, 0x41); });
+	add(DPT_String, 0, 0, 1, 1, 0, [] {});
+
+	writeFile(cut, log, log.size());
+	CHECK_EQ(replayFile(cut).size(), ends.size());
+
+	bool exact = true;
+	for (std::size_t size = sizeof(RecordMagic) + 1; size < log.size(); size++) {
+		std::size_t complete = 0;
+		while (complete < ends.size() && ends[complete] <= size) {
+			complete++;
+		}
+
+		writeFile(cut, log, size);
+		if (replayFile(cut).size() != complete) {
+			std::printf("cut at %zu: expected %zu records\n", size, complete);
+			exact = false;
+		}
+	}
+	CHECK(exact);
+
+	std::remove(path.c_str());
+	std::remove(cut.c_str());
+	return test::result();
+}
@@ -0,0 +1,87 @@
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+#include "check.h"
+#include "graph.h"
+#include "remote.h"
+#include "snapshot.h"
+
+using namespace dvalvegen;
+
+static std::string snapshotOf(ClientClass* head) {
+	std::ostringstream stream;
+	SnapshotWriter{}.write(head, stream);
+	return stream.str();
+}
+
+int main() {
+	// The graphs are built before the fork, so the child has them at the same addresses
+	SyntheticGraph small;
+	ClientClass* smallhead = test::makePlayerGraph(small);
+
+	// 300 classes with three nested tables of 40 props each
+	SyntheticGraph big;
+	for (int c = 0; c < 300; c++) {
+		RecvTable* inner = nullptr;
+
+		for (int d = 0; d < 3; d++) {
+			RecvTable* table = big.addTable("DT_T" + std::to_string(c) + "_" + std::to_string(d));
+			for (int p = 0; p < 40; p++) {
+				big.addProp(table, "m_p" + std::to_string(p), DPT_Int, p * 4);
+			}
+
+			if (inner) {
+				big.addProp(table, "m_sub", DPT_DataTable, 0x400, inner);
+			}
+
+			inner = table;
+		}
+
+		big.addClass("C" + std::to_string(c), inner, c);
+	}
+
+	pid_t child = fork();
+	if (child == 0) {
+		pause();
+		_exit(0);
+	}
+
+	{
+		ProcessReader reader{ child };
+		RemoteGraphLoader loader{ reader };
+		SyntheticGraph copy;
+
+		CHECK(loader.load((std::uintptr_t)smallhead, copy));
+		CHECK(snapshotOf(copy.head()) == snapshotOf(smallhead));
+	}
+
+	{
+		// 900 tables and 36000 props, read level by level instead of pointer by pointer
+		ProcessReader reader{ child };
+		RemoteGraphLoader loader{ reader };
+		SyntheticGraph copy;
+
+		CHECK(loader.load((std::uintptr_t)big.head(), copy));
+		CHECK(snapshotOf(copy.head()) == snapshotOf(big.head()));
+		CHECK_EQ(copy.numTables(), 900u);
+		CHECK(loader.numCalls() <= 64);
+		std::printf("big graph: %llu reads for %u tables\n", (unsigned long long)loader.numCalls(), copy.numTables());
+	}
+
+	{
+		// Unmapped memory fails the load instead of crashing
+		ProcessReader reader{ child };
+		RemoteGraphLoader loader{ reader };
+		SyntheticGraph copy;
+
+		CHECK(!loader.load(16, copy));
+	}
+
+	kill(child, SIGKILL);
+	waitpid(child, nullptr, 0);
+
+	return test::result();
+}
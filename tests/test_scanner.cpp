@@ -0,0 +1,106 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "scanner.h"
+
+using namespace dvalvegen;
+
+static std::vector<std::size_t> naiveScan(const BytePattern& p, const std::uint8_t* data, std::size_t size) {
+	std::vector<std::size_t> hits;
+	for (std::size_t i = 0; i + p.size() <= size; i++) {
+		if (p.match(data + i)) {
+			hits.push_back(i);
+		}
+	}
+
+	return hits;
+}
+
+static void plant(std::vector<std::uint8_t>& buffer, std::size_t at, const BytePattern& p, std::mt19937& rng) {
+	// Wildcards get random bytes, so they're really ignored
+	std::vector<std::uint8_t> bytes(p.size());
+	for (auto& b : bytes) {
+		b = (std::uint8_t)rng();
+	}
+
+	std::string text = p.text();
+	for (std::size_t i = 0, b = 0; i < text.size(); b++) {
+		if (text[i] != '?') {
+			bytes[b] = (std::uint8_t)std::stoi(text.substr(i, 2), nullptr, 16);
+		}
+		i += 3;
+	}
+
+	std::copy(bytes.begin(), bytes.end(), buffer.begin() + at);
+}
+
+int main() {
+	const char* texts[] = { "A1 ?? ?? ?? ?? C3", "55 8B EC 83 E4 F8", "E8 ?? ?? ?? ?? 84 C0 74", "?? ?? 56 43 6C 69", "8B 0D ?? ?? ?? ?? 8B 01 FF 50",
+		"00 00 00 00 12", "68 ?? ?? ?? ?? FF 15", "C3" };
+
+	std::vector<BytePattern> patterns;
+	PatternScanner scanner;
+	for (auto t : texts) {
+		patterns.emplace_back(t);
+		scanner.add(patterns.back());
+		CHECK(patterns.back().valid());
+	}
+
+	// A random buffer with matches planted everywhere, including the very start and end
+	std::mt19937 rng{ 1 };
+	std::vector<std::uint8_t> buffer(1 << 20);
+	for (auto& b : buffer) {
+		b = (std::uint8_t)rng();
+	}
+
+	for (int i = 0; i < 400; i++) {
+		const BytePattern& p = patterns[i % patterns.size()];
+		std::size_t at = i < 8 ? 0 : i < 16 ? buffer.size() - p.size() : rng() % (buffer.size() - p.size());
+		plant(buffer, at, p, rng);
+	}
+
+	std::vector<std::vector<std::size_t>> results;
+	scanner.scan(buffer.data(), buffer.size(), results);
+	CHECK_EQ(results.size(), patterns.size());
+
+	for (std::size_t i = 0; i < patterns.size(); i++) {
+		CHECK(results[i] == naiveScan(patterns[i], buffer.data(), buffer.size()));
+	}
+
+	// Buffers around and below the vector width, with a match at every possible position
+	int wrong = 0;
+	for (std::size_t size = 0; size < 80; size++) {
+		for (std::size_t at = 0; at + patterns[2].size() <= size; at++) {
+			std::vector<std::uint8_t> small(size, 0x90);
+			plant(small, at, patterns[2], rng);
+			scanner.scan(small.data(), small.size(), results);
+
+			for (std::size_t i = 0; i < patterns.size(); i++) {
+				wrong += results[i] != naiveScan(patterns[i], small.data(), small.size());
+			}
+		}
+	}
+
+	CHECK_EQ(wrong, 0);
+
+	scanner.scan(buffer.data(), buffer.size(), results, 2);
+	CHECK(results[7].size() == 2);
+
+	// Malformed text, raw bytes with a mask
+	CHECK(!BytePattern("A1 Q2").valid());
+	CHECK(!BytePattern("").valid());
+
+	std::string strings{ "xx\0VClient018\0VClient0\0VEngineClient014\0", 40 };
+	BytePattern version = BytePattern::fromBytes("VClient000\0", "xxxxxxx???x");
+	CHECK(version.text() == "56 43 6C 69 65 6E 74 ?? ?? ?? 00");
+
+	const std::uint8_t* base = (const std::uint8_t*)strings.data();
+	auto& hits = g_ScanCache.find(base, strings.size(), version);
+	CHECK_EQ(hits.size(), 1u);
+	CHECK_EQ(hits.empty() ? 0 : hits[0], 3u);
+	CHECK(&g_ScanCache.find(base, strings.size(), version) == &hits);
+
+	return test::result();
+}
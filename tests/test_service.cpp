@@ -0,0 +1,138 @@
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "check.h"
+#include "graph.h"
+#include "service.h"
+
+using namespace dvalvegen;
+
+static int connectTo(const std::string& socketpath) {
+	sockaddr_un addr{};
+	addr.sun_family = AF_UNIX;
+	std::memcpy(addr.sun_path, socketpath.c_str(), socketpath.size() + 1);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0) {
+		::close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+static std::string readReply(int fd) {
+	std::string reply;
+	char buffer[256];
+	ssize_t n;
+
+	while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+		reply.append(buffer, (std::size_t)n);
+	}
+
+	::close(fd);
+	return reply;
+}
+
+int main() {
+	std::string dir = std::filesystem::absolute("dvalvegen_test_service_" + std::to_string(getpid())).string();
+	std::filesystem::remove_all(dir);
+	std::filesystem::create_directories(dir);
+
+	std::string socketpath = dir + "/sock";
+	std::string snapshotpath = dir + "/player.snap";
+	{
+		SyntheticGraph g;
+		std::ofstream of{ snapshotpath, std::ios::binary };
+		SnapshotWriter{}.write(test::makePlayerGraph(g), of);
+	}
+
+	GenerationService service{ 2 };
+	service.setReadTimeout(200);
+	service.setMaxRequestSize(4096);
+	CHECK(service.setOutputRoot(dir));
+	CHECK(service.listen(socketpath));
+
+	struct stat st;
+	CHECK(stat(socketpath.c_str(), &st) == 0);
+	CHECK_EQ(st.st_mode & 0777, 0600);
+
+	GenerationResult result;
+	CHECK(requestGeneration(socketpath, dir + "/out", snapshotpath, false, result));
+	CHECK(result.error.empty());
+	CHECK(!result.written.empty());
+
+	// Rendering the baked SDK runs out of budget, the request fails and the service keeps going
+	memory::setBudget(memory::total().current + 512);
+	CHECK(requestGeneration(socketpath, dir + "/baked", snapshotpath, true, result));
+	CHECK(result.error == "out of memory");
+	CHECK(g_Classes.empty());
+
+	memory::setBudget(0);
+	CHECK(requestGeneration(socketpath, dir + "/baked", snapshotpath, true, result));
+	CHECK(result.error.empty());
+	CHECK(std::filesystem::exists(dir + "/baked/dvalvegen/CPlayer.h"));
+
+	// Outside of the root, also through ..
+	CHECK(requestGeneration(socketpath, dir + "_other", snapshotpath, false, result));
+	CHECK(result.error == "output directory outside of the root");
+	CHECK(requestGeneration(socketpath, dir + "/out/../../escape", snapshotpath, false, result));
+	CHECK(result.error == "output directory outside of the root");
+	CHECK(!std::filesystem::exists(dir + "/../escape"));
+
+	// A client that never shuts down its side is dropped after the timeout
+	int fd = connectTo(socketpath);
+	CHECK(fd >= 0);
+	CHECK(write(fd, "GEN\t", 4) == 4);
+	auto start = std::chrono::steady_clock::now();
+	CHECK(readReply(fd) == "ERR\tincomplete request\n");
+	CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+
+	// More than the limit isn't read to the end
+	fd = connectTo(socketpath);
+	std::string big(8192, 'x');
+	CHECK(write(fd, big.data(), big.size()) == (ssize_t)big.size());
+	shutdown(fd, SHUT_WR);
+	CHECK(readReply(fd) == "ERR\trequest too large\n");
+
+	// The workers are all still there
+	CHECK(requestGeneration(socketpath, dir + "/out", snapshotpath, false, result));
+	CHECK(result.error.empty());
+	CHECK(result.written.empty());
+
+	// Files deleted or edited behind the service's back are written again, also an edit that keeps the size
+	auto slurp = [](const std::string& path) {
+		std::ifstream inf{ path, std::ios::binary };
+		std::ostringstream ss;
+		ss << inf.rdbuf();
+		return ss.str();
+	};
+	std::string player = dir + "/out/dvalvegen/CPlayer.h";
+	std::string entity = dir + "/out/dvalvegen/CBaseEntity.h";
+	std::string original = slurp(entity);
+	CHECK(std::filesystem::remove(player));
+	{
+		std::string edited = original;
+		edited[0] = edited[0] == 'x' ? 'y' : 'x';
+		std::ofstream of{ entity, std::ios::binary };
+		of << edited;
+	}
+	std::filesystem::last_write_time(entity, std::filesystem::last_write_time(entity) + std::chrono::seconds(1));
+
+	CHECK(requestGeneration(socketpath, dir + "/out", snapshotpath, false, result));
+	CHECK(result.error.empty());
+	CHECK_EQ(result.written.size(), 2);
+	CHECK(std::filesystem::exists(player));
+	CHECK(slurp(entity) == original);
+
+	CHECK(requestGeneration(socketpath, dir + "/out", snapshotpath, false, result));
+	CHECK(result.written.empty());
+
+	service.stop();
+	std::filesystem::remove_all(dir);
+	return test::result();
+}
@@ -0,0 +1,58 @@
+#include <string>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "check.h"
+#include "rtgraph.h"
+
+using namespace dvalvegen;
+
+// The child only attaches, it never sees a class graph
+static int attachChild(const std::string& name) {
+	if (!attachShared(name.c_str())) {
+		return 2;
+	}
+
+	bool ok = getUnresolvedCount() == 0
+		&& getOffset("DT_Player", "m_flSpeed") == 0x100
+		&& getDTArraySize("DT_Player", "m_iAmmo") == 4
+		&& getSharedClassId("CPlayer") == 2
+		&& getSharedClassId("CNope") == -1
+		&& getSharedFingerprint() != 0;
+
+	closeShared();
+	return ok ? 0 : 3;
+}
+
+int main() {
+	std::string name = "/dvalvegen_test_" + std::to_string(getpid());
+
+	// A graph without any of the SDK's fields resolves nothing, that's not published
+	test::RuntimeGraph other;
+	other.addClass("COther", other.addTable("DT_Other"), 1);
+	initialize(other.head());
+	CHECK_EQ(getUnresolvedCount(), FieldCount);
+	CHECK(!publishShared(name.c_str()));
+
+	// Offsets from the baked path are published like resolved ones
+	test::RuntimeGraph g;
+	CHECK(initialize(test::makePlayerGraph(g)));
+	CHECK(g_Baked);
+	CHECK(publishShared(name.c_str()));
+
+	pid_t child = fork();
+	if (child == 0) {
+		_exit(attachChild(name));
+	}
+
+	int status = 0;
+	waitpid(child, &status, 0);
+	CHECK(WIFEXITED(status));
+	CHECK_EQ(WEXITSTATUS(status), 0);
+
+	closeShared();
+	removeShared(name.c_str());
+	CHECK(!attachShared(name.c_str()));
+
+	return test::result();
+}
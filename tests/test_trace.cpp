@@ -0,0 +1,175 @@
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+#include "check.h"
+#include "graph.h"
+
+using namespace dvalvegen;
+
+// Built with DVALVEGEN_TRACE, so trace.h also replaces operator new and delete here
+
+class JsonChecker {
+	/// Just enough of a parser to tell whether the trace is well formed JSON
+public:
+	JsonChecker(const std::string& text) : m_s(text) {
+
+	}
+
+	bool valid() {
+		return value() && (space(), m_i == m_s.size());
+	}
+
+private:
+	void space() {
+		while (m_i < m_s.size() && std::isspace((unsigned char)m_s[m_i])) {
+			m_i++;
+		}
+	}
+
+	bool eat(char c) {
+		space();
+		if (m_i < m_s.size() && m_s[m_i] == c) {
+			m_i++;
+			return true;
+		}
+		return false;
+	}
+
+	bool string() {
+		if (!eat('"')) {
+			return false;
+		}
+
+		while (m_i < m_s.size() && m_s[m_i] != '"') {
+			if ((unsigned char)m_s[m_i] < 0x20) {
+				return false;
+			}
+			m_i += m_s[m_i] == '\\' ? 2 : 1;
+		}
+
+		return m_i++ < m_s.size();
+	}
+
+	bool number() {
+		std::size_t start = m_i;
+		while (m_i < m_s.size() && (std::isdigit((unsigned char)m_s[m_i]) || std::strchr("+-.eE", m_s[m_i]))) {
+			m_i++;
+		}
+		return m_i > start;
+	}
+
+	template<typename F>
+	bool list(char close, F item) {
+		if (eat(close)) {
+			return true;
+		}
+
+		do {
+			if (!item()) {
+				return false;
+			}
+		} while (eat(','));
+
+		return eat(close);
+	}
+
+	bool value() {
+		space();
+		if (m_i >= m_s.size()) {
+			return false;
+		}
+
+		char c = m_s[m_i];
+		if (c == '{') {
+			m_i++;
+			return list('}', [this] { return string() && eat(':') && value(); });
+		}
+		if (c == '[') {
+			m_i++;
+			return list(']', [this] { return value(); });
+		}
+		if (c == '"') {
+			return string();
+		}
+		for (const char* word : { "true", "false", "null" }) {
+			if (m_s.compare(m_i, std::strlen(word), word) == 0) {
+				m_i += std::strlen(word);
+				return true;
+			}
+		}
+		return number();
+	}
+
+	const std::string& m_s;
+	std::size_t m_i = 0;
+};
+
+static unsigned long long counterIn(const std::string& json, const std::string& name) {
+	/// The value of a counter in otherData
+	std::size_t at = json.find("\"otherData\"");
+	at = at == std::string::npos ? at : json.find("\"" + name + "\":", at);
+	return at == std::string::npos ? 0 : std::stoull(json.substr(at + name.size() + 3));
+}
+
+int main() {
+	std::string base = "dvalvegen_test_trace_" + std::to_string(getpid());
+	std::string path = base + ".json";
+
+	// Every variant of operator new counts, not only the plain one
+	trace::enable(true);
+	std::uint64_t before = trace::g_Counters[trace::Allocations].load();
+	::operator delete(::operator new(16));
+	::operator delete[](::operator new[](16));
+	::operator delete(::operator new(16, std::nothrow), std::nothrow);
+	::operator delete[](::operator new[](16, std::nothrow), std::nothrow);
+	::operator delete(::operator new(16, std::align_val_t{ 64 }), std::align_val_t{ 64 });
+	::operator delete[](::operator new[](16, std::align_val_t{ 64 }), std::align_val_t{ 64 });
+	void* aligned = ::operator new(100, std::align_val_t{ 256 }, std::nothrow);
+	CHECK(aligned && (std::uintptr_t)aligned % 256 == 0);
+	::operator delete(aligned, std::align_val_t{ 256 }, std::nothrow);
+	CHECK_EQ(trace::g_Counters[trace::Allocations].load() - before, 7u);
+	trace::clear();
+
+	SyntheticGraph g;
+	createClasses(test::makePlayerGraph(g));
+	std::filesystem::create_directories(base);
+	CHECK(printClasses(base + "/"));
+	trace::enable(false);
+
+	CHECK(trace::write(path));
+	std::stringstream text;
+	text << std::ifstream{ path }.rdbuf();
+	std::string json = text.str();
+
+	CHECK(JsonChecker{ json }.valid());
+	CHECK(json.find("\"ph\":\"X\"") != std::string::npos);
+	CHECK(json.find("\"name\":\"createClasses\"") != std::string::npos);
+	CHECK(json.find("\"name\":\"createClass\"") != std::string::npos);
+	CHECK(json.find("\"detail\":\"DT_Player\"") != std::string::npos);
+	CHECK(json.find("\"name\":\"renderClasses\"") != std::string::npos);
+	CHECK(json.find("\"ph\":\"C\"") != std::string::npos);
+
+	// Player, base entity, collision and the empty class
+	CHECK_EQ(counterIn(json, "classes"), 4u);
+	CHECK(counterIn(json, "files") >= 4);
+	CHECK(counterIn(json, "bytes emitted") > 0);
+	CHECK(counterIn(json, "allocations") > 0);
+
+	// Nothing is recorded while it's off
+	trace::clear();
+	createClasses(test::makePlayerGraph(g));
+	CHECK(trace::write(path));
+	std::stringstream empty;
+	empty << std::ifstream{ path }.rdbuf();
+	CHECK(JsonChecker{ empty.str() }.valid());
+	CHECK(empty.str().find("\"ph\":\"X\"") == std::string::npos);
+	CHECK_EQ(counterIn(empty.str(), "allocations"), 0u);
+
+	std::remove(path.c_str());
+	std::filesystem::remove_all(base);
+	return test::result();
+}
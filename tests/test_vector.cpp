@@ -0,0 +1,59 @@
+#include <cstdlib>
+#include <vector>
+
+#include "Vector.h"
+
+#include "check.h"
+
+using namespace dvalvegen;
+
+struct Entity {
+	char pad[0x30];
+	Vector origin;
+
+	Vector* getOrigin() {
+		return &origin;
+	}
+};
+
+static bool inBox(const Vector& v, const Vector& mins, const Vector& maxs) {
+	return v.x >= mins.x && v.y >= mins.y && v.z >= mins.z && v.x <= maxs.x && v.y <= maxs.y && v.z <= maxs.z;
+}
+
+int main() {
+	const Vector mins{ -50, -50, -50 }, maxs{ 50, 50, 50 };
+	std::srand(7);
+
+	// Every count around the four wide blocks, points inside, outside and exactly on the faces
+	for (std::size_t count = 0; count < 40; count++) {
+		std::vector<Entity> storage(count);
+		std::vector<Entity*> entities;
+		std::vector<std::uint32_t> expected;
+
+		for (std::size_t i = 0; i < count; i++) {
+			float c[3];
+			for (float& f : c) {
+				int r = std::rand() % 5;
+				f = r == 0 ? 50.f : r == 1 ? -50.f : (float)(std::rand() % 160 - 80);
+			}
+
+			storage[i].origin = { c[0], c[1], c[2] };
+			entities.push_back(&storage[i]);
+			if (inBox(storage[i].origin, mins, maxs)) {
+				expected.push_back((std::uint32_t)i);
+			}
+		}
+
+		std::vector<std::uint32_t> out(count);
+		std::size_t n = vec::cull(entities.data(), count, &Entity::getOrigin, mins, maxs, out.data());
+		out.resize(n);
+		CHECK(out == expected);
+
+		out.assign(count, 0);
+		n = vec::cull(count ? &storage[0].origin : nullptr, sizeof(Entity), count, mins, maxs, out.data());
+		out.resize(n);
+		CHECK(out == expected);
+	}
+
+	return test::result();
+}
@@ -0,0 +1,45 @@
+#include <cstring>
+
+#include "check.h"
+#include "rtgraph.h"
+#include "CPlayer.h"
+
+using namespace dvalvegen;
+
+static int speedOffset() {
+	alignas(16) char object[0x400] = {};
+	return (int)((char*)((CPlayer*)object)->m_flSpeed() - object);
+}
+
+// Runs against an SDK generated with versions, from two builds of the graph that differ in m_flSpeed
+int main() {
+	test::RuntimeGraph before, after, other;
+	ClientClass* beforehead = test::makePlayerGraph(before);
+	ClientClass* afterhead = test::makePlayerGraph(after, 0x104);
+	ClientClass* otherhead = test::makePlayerGraph(other, 0x108);
+
+	// Each build picks its own column by fingerprint, without walking the tables
+	CHECK(initialize(afterhead));
+	CHECK_EQ(getVersion(), 1);
+	CHECK(getVersionName() && std::strcmp(getVersionName(), "after") == 0);
+	CHECK_EQ(speedOffset(), 0x104);
+	CHECK_EQ(getOffset("DT_Player", "m_flSpeed"), 0x104);
+	CHECK_EQ(getOffset("DT_BaseEntity", "m_iHealth"), 0x10);
+	CHECK_EQ(getDTArraySize("DT_Player", "m_iAmmo"), 4);
+	CHECK_EQ(getUnresolvedCount(), 0u);
+
+	CHECK(initialize(beforehead));
+	CHECK_EQ(getVersion(), 0);
+	CHECK(getVersionName() && std::strcmp(getVersionName(), "before") == 0);
+	CHECK_EQ(speedOffset(), 0x100);
+	CHECK(hasField(findField("DT_Player", "m_szName")));
+
+	// A build that's neither is resolved at runtime
+	CHECK(!initialize(otherhead));
+	CHECK_EQ(getVersion(), -1);
+	CHECK(getVersionName() == nullptr);
+	CHECK_EQ(speedOffset(), 0x108);
+	CHECK_EQ(getUnresolvedCount(), 0u);
+
+	return test::result();
+}